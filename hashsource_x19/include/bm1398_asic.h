@@ -1,7 +1,8 @@
 /*
  * BM1398 ASIC Driver for Antminer S19 Pro
  *
- * Hardware: 114 chips per chain, 3 chains total
+ * Hardware: 114 chips per chain, 3 chains total (other BM1398 boards and
+ * 4-chain FPGAs through board_profile.h)
  * UART: 12 MHz baudrate via FPGA
  * Frequency: 525 MHz target
  */
@@ -11,6 +12,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "fpga_i2c.h"
+#include "eeprom.h"
+#include "work_timing.h"
+#include "board_profile.h"
 
 //==============================================================================
 // FPGA Register Definitions
@@ -64,6 +69,11 @@
 #define NONCE_INDICATOR             (1U << 7)
 #define NONCE_CHAIN_NUMBER(v)       ((v) & 0xF)
 
+// TW work_id is sent as id << 3 (factory test). Which slot produced a nonce
+// is not known: the FIFO returns one 32-bit word, and bits 15:8 taken as
+// work_id are nonce bits.
+#define WORK_ID_SHIFT               3
+
 //==============================================================================
 // ASIC Register Definitions
 //==============================================================================
@@ -97,6 +107,7 @@
 
 // Soft reset control values
 #define SOFT_RESET_MASK             0x1F0        // Soft reset bits
+#define CHIP_RESET_SETTLE_US        1000         // Per step, single-chip reset
 
 // Core timing parameters (register 0x44)
 #define CORE_PARAM_SWPF_MODE_BIT    0       // Bit 0: swpf_mode
@@ -129,22 +140,85 @@
 // Configuration Constants
 //==============================================================================
 
-#define MAX_CHAINS                  3
-#define CHIPS_PER_CHAIN_S19PRO      114
-#define CHIP_ADDRESS_INTERVAL       2
+#define MAX_CHAINS                  BOARD_MAX_CHAINS
 
 #define BAUD_RATE_12MHZ             12000000
 #define FREQUENCY_525MHZ            525
+#define FREQUENCY_MIN_MHZ           400     // VCO 1600 MHz / 4
+#define FREQUENCY_MAX_MHZ           800     // VCO 3200 MHz / 4
+
+// PLL0 (see bm1398_pll_value)
+#define PLL_CLKI_MHZ                25
+#define PLL_CORE_DIV                4
+#define PLL_VCO_MIN_MHZ             1600
+#define PLL_VCO_MAX_MHZ             3200
+#define PLL_VCO_HIGH_MHZ            2400
+#define PLL0_FIXED_DIVIDERS         0x40000100
+#define PLL0_VCO_HIGH_RANGE         0x10000000
+
+// Power sequencing waits
+#define PSU_SETTLE_MS               2000    // After bm1398_psu_enable()
+#define PIC_DC_DC_WAIT_MS           300     // Request to confirm
+
+// bm1398_init_ex() flags
+#define BM1398_INIT_WARM            0x01    // Keep a configured FPGA
+#define BM1398_INIT_NO_EEPROM       0x02    // Caller runs bm1398_load_eeprom()
 
 //==============================================================================
 // Data Structures
 //==============================================================================
 
+// Recorded chain bring-up (see bm1398_replay_chain)
+#define BM1398_SCRIPT_MAX_STEPS     512
+#define BM1398_REPLAY_PACE_US       200     // Between commands on replay
+
+typedef struct {
+    uint8_t len;                        // Command bytes; 0 = hold
+    uint8_t cmd[12];
+    uint32_t hold_us;                   // Hardware settle after the previous command
+} bm1398_script_step_t;
+
+typedef struct {
+    int num_steps;
+    bool overflow;                      // Too long to record: not replayable
+    uint32_t freq_mhz;                  // PLL frequency the script leaves behind
+    uint32_t record_ms;                 // Wall time of the recorded bring-up
+    uint64_t hold_us;                   // Sum of the holds
+    bm1398_script_step_t steps[BM1398_SCRIPT_MAX_STEPS];
+} bm1398_init_script_t;
+
+// Callback for register read responses routed out of the nonce FIFO.
+// chip_addr and reg_addr are those of the read the word was matched to.
+typedef void (*bm1398_reg_response_cb_t)(void *arg, int chain, uint8_t chip_addr,
+                                         uint8_t reg_addr, uint32_t value);
+
+// Outstanding async register read (at most one per chain)
+typedef struct {
+    bool pending;
+    uint8_t chip_addr;
+    uint8_t reg_addr;
+    uint64_t deadline_ms;               // CLOCK_MONOTONIC; unmatched after this
+} bm1398_reg_read_t;
+
 typedef struct {
     volatile uint32_t *fpga_regs;
     int num_chains;
     int chips_per_chain[MAX_CHAINS];
     bool initialized;
+    fpga_i2c_t i2c;             // Shared I2C scheduler (PSU, PIC, EEPROM)
+    eeprom_info_t eeprom[MAX_CHAINS];   // Decoded board EEPROM (cached on /config)
+    bm1398_reg_response_cb_t reg_response_cb;   // Async register read consumer
+    void *reg_response_arg;
+    bm1398_reg_read_t reg_read[MAX_CHAINS];     // Async read awaiting a FIFO response
+    uint32_t freq_mhz[MAX_CHAINS];      // Last programmed PLL frequency
+    int timing_percent;                 // Work timeout as % of nonce sweep
+    work_timing_t timing;               // Values currently in the FPGA
+    bm1398_init_script_t *script[MAX_CHAINS];   // Last successful bring-up
+    bool recording[MAX_CHAINS];
+    bool warm_start;                    // bm1398_init_warm() kept the FPGA setup
+    const board_profile_t *profile;     // Board geometry and power defaults
+    int owner_fd;                       // FPGA claim (fpga_service.h)
+    uint32_t works_sent[MAX_CHAINS];    // Work packets queued to the TW FIFO
 } bm1398_context_t;
 
 typedef struct {
@@ -171,6 +245,10 @@ typedef struct __attribute__((packed)) {
 
 // Initialization and cleanup
 int bm1398_init(bm1398_context_t *ctx);
+int bm1398_init_warm(bm1398_context_t *ctx);
+int bm1398_init_ex(bm1398_context_t *ctx, uint32_t flags,
+                   const board_profile_t *profile);
+int bm1398_load_eeprom(bm1398_context_t *ctx, int chain);
 void bm1398_cleanup(bm1398_context_t *ctx);
 
 // FPGA indirect register access (CRITICAL - matches bmminer/factory test)
@@ -193,6 +271,12 @@ int bm1398_write_register(bm1398_context_t *ctx, int chain, bool broadcast,
 int bm1398_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
                          uint8_t chip_addr, uint8_t reg_addr, uint32_t *value,
                          int timeout_ms);
+int bm1398_send_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
+                               uint8_t chip_addr, uint8_t reg_addr);
+int bm1398_read_register_async(bm1398_context_t *ctx, int chain,
+                               uint8_t chip_addr, uint8_t reg_addr,
+                               int timeout_ms);
+void bm1398_drop_register_read(bm1398_context_t *ctx, int chain);
 int bm1398_read_modify_write_register(bm1398_context_t *ctx, int chain,
                                       uint8_t reg_addr, uint32_t clear_mask,
                                       uint32_t set_mask);
@@ -202,11 +286,24 @@ int bm1398_reset_chain_stage1(bm1398_context_t *ctx, int chain);
 int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                                   uint8_t diode_vdd_mux_sel);
 int bm1398_init_chain(bm1398_context_t *ctx, int chain);
+int bm1398_reset_chip(bm1398_context_t *ctx, int chain, uint8_t chip_addr);
+int bm1398_replay_chain(bm1398_context_t *ctx, int chain, int hold_percent);
+int bm1398_adopt_chain(bm1398_context_t *ctx, int chain);
+
+// Hot-plug: take a chain in after bm1398_init() / retire it
+int bm1398_attach_chain(bm1398_context_t *ctx, int chain);
+void bm1398_detach_chain(bm1398_context_t *ctx, int chain);
 
 // Baud rate and frequency configuration
 int bm1398_set_baud_rate(bm1398_context_t *ctx, int chain, uint32_t baud_rate);
+uint32_t bm1398_pll_value(uint32_t freq_mhz, uint32_t *actual_mhz);
+uint32_t bm1398_start_freq(const bm1398_context_t *ctx, int chain);
 int bm1398_set_frequency(bm1398_context_t *ctx, int chain, uint32_t freq_mhz);
 
+// Work timing (timeout, hcn, FPGA work queue) derived from freq/chip count
+int bm1398_update_work_timing(bm1398_context_t *ctx, int chain);
+int bm1398_set_chip_count(bm1398_context_t *ctx, int chain, int num_chips);
+
 // Work submission
 int bm1398_enable_work_send(bm1398_context_t *ctx);
 int bm1398_start_work_gen(bm1398_context_t *ctx);
@@ -214,6 +311,9 @@ int bm1398_check_work_fifo_ready(bm1398_context_t *ctx);
 int bm1398_send_work(bm1398_context_t *ctx, int chain, uint32_t work_id,
                     const uint8_t *work_data_12bytes,
                     const uint8_t midstates[4][32]);
+int bm1398_send_work_swapped(bm1398_context_t *ctx, int chain, uint32_t work_id,
+                             const uint32_t work_data_be[3],
+                             const uint32_t *const midstates_be[4]);
 
 // Nonce collection
 int bm1398_get_nonce_count(bm1398_context_t *ctx);
@@ -228,6 +328,11 @@ int bm1398_get_crc_error_count(bm1398_context_t *ctx);
 // PSU and hashboard power control
 int bm1398_psu_power_on(bm1398_context_t *ctx, uint32_t voltage_mv);
 int bm1398_psu_set_voltage(bm1398_context_t *ctx, uint32_t voltage_mv);
+int bm1398_psu_adopt(bm1398_context_t *ctx, uint32_t voltage_mv);
+int bm1398_psu_enable(bm1398_context_t *ctx);
 int bm1398_enable_dc_dc(bm1398_context_t *ctx, int chain);
+// Split DC-DC enable: request, wait PIC_DC_DC_WAIT_MS, confirm
+int bm1398_dc_dc_request(bm1398_context_t *ctx, int chain);
+int bm1398_dc_dc_confirm(bm1398_context_t *ctx, int chain);
 
 #endif // BM1398_ASIC_H
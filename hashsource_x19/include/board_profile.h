@@ -0,0 +1,64 @@
+/*
+ * BM1398 Hashboard Profiles
+ *
+ * Board geometry and power defaults, one profile per model. The driver
+ * takes the profile in bm1398_init_ex(). Everything that depends on
+ * geometry is derived from it: chain slots and the plug-detect mask, chips
+ * per chain, the address interval (work_timing_interval()), and the FPGA
+ * chain work config and work queue parameters (work_timing_calc()).
+ *
+ * Reference (bmminer config, S19 Pro):
+ *   "chain_num 4, chain_domain_num 38, domain_asic_num 3"
+ *
+ * The per-nonce paths (hashrate, core yield, probes) already map nonces to
+ * chips through per-chain tables built from the chip count, so geometry
+ * costs nothing per nonce. The profile used when none is named is chosen
+ * at build time (make BOARD=<name>).
+ */
+
+#ifndef BOARD_PROFILE_H
+#define BOARD_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#ifndef BOARD_PROFILE_DEFAULT
+#define BOARD_PROFILE_DEFAULT       "s19pro"
+#endif
+
+#define BOARD_MAX_CHAINS            4       // Most FPGA chain slots (MAX_CHAINS)
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    const char *name;                   // Selection key
+    const char *model;                  // Display name
+    int chains;                         // FPGA chain slots
+    int domains;                        // Voltage domains per chain
+    int chips_per_domain;
+    int chips_per_chain;                // domains * chips_per_domain
+    uint32_t freq_mhz;                  // When the board EEPROM names none
+    uint32_t power_on_mv;               // PSU voltage for chain bring-up
+    uint32_t operating_mv;              // PSU voltage once chains are up
+    bool verified;                      // Power defaults match stock firmware
+} board_profile_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// Returns: profile, or NULL for an unknown name (NULL name = build default)
+const board_profile_t *board_profile_find(const char *name);
+void board_profile_list(void);
+
+// Derived parameters
+uint32_t board_profile_chain_mask(const board_profile_t *p);
+int board_profile_interval(const board_profile_t *p);
+
+#endif // BOARD_PROFILE_H
@@ -0,0 +1,66 @@
+/*
+ * Startup Timeline Profiler
+ *
+ * Bring-up is made of FPGA setup, PSU and PIC I2C waits, UART commands and
+ * hardware settles, some of which overlap (startup.h). Scoped probes record
+ * every phase and sub-step with CLOCK_MONOTONIC timestamps into a
+ * preallocated event buffer. The result is exported as Chrome trace JSON
+ * (chrome://tracing, ui.perfetto.dev), with one track per chain. A summary
+ * ranks the steps by self time.
+ *
+ * Probes nest: boot_trace_begin() opens an event under the innermost open
+ * one and boot_trace_end() closes it. An event left open by an early error
+ * return is closed together with its parent. Outside boot_trace_start() /
+ * boot_trace_stop() a probe costs one branch.
+ *
+ * The recorder is process-wide and not thread-safe; probes must come from
+ * the thread doing the bring-up.
+ */
+
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define BOOT_TRACE_MAX_EVENTS       4096    // ~200 per chain bring-up
+#define BOOT_TRACE_MAX_DEPTH        16
+#define BOOT_TRACE_SUMMARY_STEPS    10      // Steps listed by boot_trace_print()
+
+#define BOOT_TRACE_NO_CHAIN         -1      // Event not tied to a chain
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    const char *name;                   // Static string, also the summary key
+    int8_t   chain;                     // BOOT_TRACE_NO_CHAIN or chain index
+    uint8_t  depth;                     // 0 = top-level phase
+    int16_t  parent;                    // Event index, -1 at top level
+    uint64_t start_us;                  // Since boot_trace_start()
+    uint64_t dur_us;
+    uint64_t child_us;                  // Time inside nested events
+} boot_trace_event_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// Recording window (start discards any previous recording)
+void boot_trace_start(void);
+void boot_trace_stop(void);
+
+// Probes: begin returns an id for end, or -1 when not recording
+int boot_trace_begin(const char *name, int chain);
+void boot_trace_end(int id);
+
+// Results
+void boot_trace_print(void);
+int boot_trace_write_json(const char *path);
+
+#endif // BOOT_TRACE_H
@@ -0,0 +1,143 @@
+/*
+ * Per-Chain Fault Supervisor
+ *
+ * Watches every active chain for three symptoms and recovers only the
+ * faulty chain. The other chains keep hashing.
+ *
+ *   - Stall: the chain has been returning nonces, then goes quiet for
+ *     SUPERVISOR_STALL_INTERVALS of its own mean nonce interval (never
+ *     less than SUPERVISOR_STALL_MIN_MS), while another chain keeps
+ *     returning nonces or work was queued to it since its last nonce.
+ *   - Unresponsive: the chain has answered temperature reads, then answers
+ *     none for SUPERVISOR_RESPONSE_MS while SUPERVISOR_RESPONSE_MISSES of
+ *     them time out.
+ *   - CRC burst: REG_CRC_ERROR_CNT_ADDR grows by SUPERVISOR_CRC_BURST in one
+ *     tick. The counter is FPGA-wide, so the burst is blamed on the only
+ *     active chain, or on the chains that also missed register responses in
+ *     that tick. Otherwise it is only counted.
+ *
+ * Nonces are credited to a chain by the FIFO chain number, the low nibble
+ * of the nonce word, which is not verified on hardware. The stall check
+ * therefore only runs when enabled (stall_check); otherwise nonces are not
+ * counted per chain, the check never arms, and a silent chain is caught
+ * only by the register-response and CRC checks.
+ *
+ * Each check is armed only after the chain has shown the healthy behaviour
+ * since its last bring-up. A board that returns no nonces because it has
+ * no work, or that does not report temperatures, is therefore never
+ * flagged. When every armed chain goes quiet together, the work source is
+ * the likely cause: chains that were given no work are left alone, and
+ * those that were are recovered without counting toward giving up.
+ *
+ * Recovery reuses the hot-plug bring-up (hotplug_recover()): stage 1 reset,
+ * stage 2 configuration and the frequency ramp for that chain only. The
+ * FPGA-wide setup in bm1398_init() is not repeated. The time from fault
+ * detection until the chain is ACTIVE again is kept per chain as the mean
+ * time to recover (MTTR). After SUPERVISOR_MAX_STREAK faults, each within
+ * SUPERVISOR_STABLE_MS of the last recovery, the supervisor stops
+ * recovering that chain.
+ */
+
+#ifndef CHAIN_SUPERVISOR_H
+#define CHAIN_SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bm1398_asic.h"
+#include "temp_monitor.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define SUPERVISOR_ARM_NONCES       32      // Nonces before stalls are checked
+#define SUPERVISOR_STALL_INTERVALS  20      // Mean nonce intervals of silence
+#define SUPERVISOR_STALL_MIN_MS     10000
+#define SUPERVISOR_RATE_ALPHA       0.05f   // Nonce rate EWMA, per tick
+#define SUPERVISOR_RESPONSE_MS      5000    // = TEMP_STALE_MS
+#define SUPERVISOR_RESPONSE_MISSES  8
+#define SUPERVISOR_CRC_BURST        64      // CRC errors in one tick
+#define SUPERVISOR_MAX_STREAK       3
+#define SUPERVISOR_STABLE_MS        300000  // Healthy this long → streak reset
+
+typedef enum {
+    SUPERVISOR_IDLE = 0,                // No chain
+    SUPERVISOR_WATCHING,
+    SUPERVISOR_RECOVERING,              // Waiting for the chain to come back
+    SUPERVISOR_GAVE_UP,                 // Faults too often: left alone
+} supervisor_state_t;
+
+typedef enum {
+    SUPERVISOR_FAULT_STALL = 0,
+    SUPERVISOR_FAULT_UNRESPONSIVE,
+    SUPERVISOR_FAULT_CRC,
+    SUPERVISOR_FAULT_TYPES,
+} supervisor_fault_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    supervisor_state_t state;
+    uint64_t up_ms;                     // Last (re)bring-up
+    uint64_t fault_ms;                  // Detection of the fault being recovered
+
+    // Nonce stall
+    uint32_t tick_nonces;               // Since the last tick
+    uint32_t nonces_since_up;
+    float rate;                         // EWMA nonces per second
+    uint64_t last_nonce_ms;
+    uint32_t stall_ms;                  // Silence allowed, set at the last nonce
+    uint32_t work_at_nonce;             // ctx->works_sent at the last nonce
+
+    // Register responses (temperature reads)
+    uint32_t samples;                   // Sensor totals at the last tick
+    uint32_t timeouts;
+    uint32_t misses;                    // Timeouts since the last answer
+    uint64_t last_answer_ms;            // 0 = none since bring-up
+
+    // History
+    uint32_t faults[SUPERVISOR_FAULT_TYPES];
+    int streak;
+    uint32_t recoveries;
+    uint64_t recovery_ms_total;
+    uint32_t last_recovery_ms;
+    uint32_t max_recovery_ms;
+} supervisor_chain_t;
+
+typedef struct {
+    bm1398_context_t *ctx;
+    const temp_monitor_t *temps;
+    supervisor_chain_t chain[MAX_CHAINS];
+    uint64_t last_tick_ms;
+    uint32_t crc_last;
+    uint32_t crc_unattributed;          // Bursts no chain could be blamed for
+    bool stall_check;                   // Count nonces per chain (unverified)
+    bool all_stalled;                   // Every armed chain quiet at once
+    uint32_t common_stalls;             // Times that happened
+} chain_supervisor_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void chain_supervisor_init(chain_supervisor_t *sv, bm1398_context_t *ctx,
+                           const temp_monitor_t *temps, bool stall_check);
+
+// Chain became ACTIVE (startup, insertion or end of a recovery)
+void chain_supervisor_chain_up(chain_supervisor_t *sv, int chain);
+// Board removed: stop watching the chain
+void chain_supervisor_chain_gone(chain_supervisor_t *sv, int chain);
+
+// Hot path: count a nonce from the chain (ignored without stall_check)
+void chain_supervisor_nonce(chain_supervisor_t *sv, int chain);
+
+// Run the checks (call about once per second)
+// Returns: bit per chain that needs recovery (hand to hotplug_recover())
+uint32_t chain_supervisor_tick(chain_supervisor_t *sv);
+
+const char *chain_supervisor_fault_name(supervisor_fault_t fault);
+void chain_supervisor_print(const chain_supervisor_t *sv);
+
+#endif // CHAIN_SUPERVISOR_H
@@ -0,0 +1,77 @@
+/*
+ * Test Completion Tracker
+ *
+ * Lets pattern/work tests stop as soon as their results are in instead of
+ * sleeping for a fixed time. Results are tracked per group (e.g. one chip
+ * core). A group is finished when all its expected results have arrived, or
+ * when it has been idle - nothing sent to it and nothing received from it -
+ * for longer than the adaptive timeout:
+ *
+ *   timeout = max(min_timeout_ms, COMPLETION_LATENCY_FACTOR * worst latency)
+ *
+ * where latency is measured from the group's last send to each arrival. A
+ * result that has not shown up after several times the slowest observed
+ * turnaround is not coming. Groups with no expected count (unknown result
+ * set) finish on the idle timeout alone.
+ */
+
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define COMPLETION_LATENCY_FACTOR   4
+
+typedef enum {
+    COMPLETION_PENDING = 0,
+    COMPLETION_ALL_RECEIVED,        // Every expected result arrived
+    COMPLETION_TIMED_OUT,           // Remaining results given up on
+} completion_state_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+// Times are milliseconds since completion_init(); 0 = never
+typedef struct {
+    uint32_t expected;
+    uint32_t received;
+    uint32_t last_send_ms;
+    uint32_t first_ms;              // First result
+    uint32_t last_ms;               // Latest result
+} completion_group_t;
+
+typedef struct {
+    completion_group_t *groups;
+    int num_groups;
+    uint64_t start_ms;
+    uint32_t min_timeout_ms;
+    uint32_t max_latency_ms;        // Worst send → result turnaround seen
+    uint32_t expected_total;
+    uint32_t received_total;
+} completion_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+int completion_init(completion_t *c, int num_groups, uint32_t min_timeout_ms);
+void completion_free(completion_t *c);
+
+uint32_t completion_now(const completion_t *c);
+void completion_sent(completion_t *c, int group, uint32_t expected);
+void completion_received(completion_t *c, int group);
+
+uint32_t completion_timeout_ms(const completion_t *c);
+completion_state_t completion_check(const completion_t *c);
+
+// First/last result time over groups [first, first + count); -1 if none
+int completion_span(const completion_t *c, int first, int count,
+                    uint32_t *first_ms, uint32_t *last_ms);
+
+#endif // COMPLETION_H
@@ -0,0 +1,122 @@
+/*
+ * Dead-Core / Weak-Chip Detector
+ *
+ * Every nonce names the chip (top byte, via the address table) and the core
+ * (byte 2: big core in the high nibble, small core in the low nibble) that
+ * found it. With all chips at the same frequency each chip should return an
+ * equal share of its chain's nonces and each core an equal share of its
+ * chip's. This module counts nonces per chip and per core and tests those
+ * shares in batches:
+ *
+ *   - Chips: once the chain has collected CORE_YIELD_MIN_EXPECTED nonces per
+ *     chip, each chip's count x is compared with the fair share e. A lower
+ *     one-sided CUSUM, S = max(0, S + (e - x) / sqrt(e) - K), flags a chip as
+ *     weak when S exceeds H. A chi-square statistic across all chips is also
+ *     kept for the chain.
+ *   - Cores: the same per-core CUSUM runs over each chip's cores, once the
+ *     chip has CORE_YIELD_MIN_EXPECTED nonces per core. It flags dead or slow
+ *     cores. A chi-square test across the chip's 80 cores flags chips whose
+ *     cores are not uniform.
+ *
+ * A flag clears when its CUSUM falls back to zero. Flag changes are queued
+ * as events. Counting is a few table lookups and increments, with no
+ * allocation. Unknown chips and cores are counted in a sink slot, so the
+ * hot path has no branches apart from the chain bounds check.
+ *
+ * At difficulty 256 a chip returns well under one nonce per second, so chip
+ * batches take minutes and core batches take hours. The detector is for
+ * slow leaks, not sudden failures (see kat_inject.h for those).
+ */
+
+#ifndef CORE_YIELD_H
+#define CORE_YIELD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bm1398_asic.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define CORE_YIELD_MAX_CHIPS        128
+#define CORE_YIELD_CORES            80      // 5 big × 16 small
+#define CORE_YIELD_MIN_EXPECTED     20      // Nonces per chip/core per batch
+#define CORE_YIELD_CUSUM_K          1.0f    // Slack, in standard deviations
+#define CORE_YIELD_CUSUM_H          6.0f    // Alarm threshold: 2 batches for a dead core,
+                                            // rare false alarms over 114 chips
+#define CORE_YIELD_CHI2_Z           3.72    // Chi-square test at p ~ 0.0001
+#define CORE_YIELD_MAX_EVENTS       64
+#define CORE_YIELD_NO_CORE          0xFF
+
+typedef enum {
+    CORE_YIELD_CHIP_WEAK = 0,
+    CORE_YIELD_CHIP_RECOVERED,
+    CORE_YIELD_CHIP_SKEWED,             // Cores fail the uniformity test
+    CORE_YIELD_CHIP_UNIFORM,
+    CORE_YIELD_CORE_DEAD,
+    CORE_YIELD_CORE_RECOVERED,
+} core_yield_event_type_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    core_yield_event_type_t type;
+    uint8_t chain;
+    uint8_t chip;
+    uint8_t core;                       // CORE_YIELD_NO_CORE for chip events
+    float statistic;                    // CUSUM or chi-square value
+    float expected;                     // Fair share in the batch
+    uint32_t observed;
+} core_yield_event_t;
+
+// Per-chip state; index CORE_YIELD_MAX_CHIPS is the unknown-address sink
+typedef struct {
+    uint32_t batch;                     // Chain batch: nonces from this chip
+    uint16_t core_batch[CORE_YIELD_CORES + 1];  // Chip batch, + unknown core
+    float cusum;
+    float core_cusum[CORE_YIELD_CORES];
+    uint8_t core_dead[CORE_YIELD_CORES];
+    float core_chi2;                    // Last chip batch, across cores
+    uint32_t core_batches;
+    bool weak;
+    bool skewed;
+} core_yield_chip_t;
+
+typedef struct {
+    uint8_t addr_to_chip[MAX_CHAINS][256];  // Nonce top byte → chip or sink
+    uint8_t core_of_byte[256];              // Nonce byte 2 → core or sink
+    int num_chips[MAX_CHAINS];
+    uint32_t batch[MAX_CHAINS];             // Nonces in the current chain batch
+    float chip_chi2[MAX_CHAINS];            // Last chain batch, across chips
+    uint32_t chip_batches[MAX_CHAINS];
+    core_yield_chip_t chip[MAX_CHAINS][CORE_YIELD_MAX_CHIPS + 1];
+
+    core_yield_event_t events[CORE_YIELD_MAX_EVENTS];
+    int event_head;
+    int event_count;
+    uint32_t events_dropped;
+} core_yield_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void core_yield_init(core_yield_t *cy);
+void core_yield_set_chain(core_yield_t *cy, int chain, int num_chips, int interval);
+
+// Hot path: O(1), no division
+void core_yield_add(core_yield_t *cy, int chain, uint32_t nonce);
+
+// Run the tests on every batch that is full (call about once per second)
+void core_yield_tick(core_yield_t *cy);
+
+// Returns: true and the oldest queued event, or false if none
+bool core_yield_next_event(core_yield_t *cy, core_yield_event_t *ev);
+const char *core_yield_event_name(core_yield_event_type_t type);
+
+void core_yield_print(const core_yield_t *cy);
+
+#endif // CORE_YIELD_H
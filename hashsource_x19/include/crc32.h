@@ -0,0 +1,16 @@
+/*
+ * CRC-32 (IEEE 802.3, reflected)
+ *
+ * Checksum of the on-disk EEPROM cache and pattern bundle files.
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Returns: CRC-32 of data[0..len-1] (init and final XOR 0xFFFFFFFF)
+uint32_t crc32_calc(const uint8_t *data, size_t len);
+
+#endif // CRC32_H
@@ -0,0 +1,109 @@
+/*
+ * Closed-Loop Fan Controller
+ *
+ * PID control of fan PWM towards a chip temperature setpoint. The FPGA has
+ * two PWM channels: main (0x084) and alternate (0x0A0). Each channel runs
+ * its own PID loop with independent gains, limits and output.
+ *
+ * Tachometer feedback comes from FAN_SPEED (0x004), which reports one fan per
+ * read (fan id in bits [11:8], pulse count in bits [7:0]). A channel whose
+ * fans stop turning while commanded on is flagged stalled, and the other
+ * channel is driven to full speed to compensate.
+ */
+
+#ifndef FAN_CONTROL_H
+#define FAN_CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Register Definitions
+//==============================================================================
+
+#define FAN_REG_TACH                (0x004 / 4)
+#define FAN_REG_PWM_MAIN            (0x084 / 4)
+#define FAN_REG_PWM_ALT             (0x0A0 / 4)
+
+// Tach register fields
+#define FAN_TACH_ID(v)              (((v) >> 8) & 0xF)
+#define FAN_TACH_COUNT(v)           ((v) & 0xFF)
+#define FAN_RPM_PER_COUNT           120     // bmminer fan[] values are multiples of 120
+
+// Stock firmware PWM format: (percent << 16) | (100 - percent)
+#define FAN_PWM_VALUE(pct)          (((uint32_t)(pct) << 16) | (100 - (uint32_t)(pct)))
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define FAN_NUM                     4
+#define FAN_PER_CHANNEL             2       // Fans 0-1 on main, 2-3 on alternate
+
+#define FAN_DEFAULT_SETPOINT_C      75.0f
+#define FAN_DEFAULT_KP              4.0f    // % per °C
+#define FAN_DEFAULT_KI              0.2f    // % per °C·s
+#define FAN_DEFAULT_KD              2.0f    // % per °C/s
+#define FAN_DEFAULT_MIN_PCT         20
+#define FAN_DEFAULT_MAX_PCT         100
+#define FAN_DEFAULT_SLEW_PCT_S      10.0f   // Max output change per second
+
+#define FAN_STALL_RPM               600     // Below this a commanded fan is stalled
+#define FAN_STALL_MIN_PCT           20      // Only check stall when driven at least this hard
+#define FAN_STALL_TIME_MS           5000    // Stall must persist this long
+#define FAN_TACH_STALE_MS           3000    // Fan not reported for this long = no data
+
+typedef enum {
+    FAN_CH_MAIN = 0,
+    FAN_CH_ALT,
+    FAN_NUM_CHANNELS
+} fan_channel_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    float setpoint_c;
+    float kp, ki, kd;
+    int min_pct;
+    int max_pct;
+    float slew_pct_s;
+} fan_pid_config_t;
+
+typedef struct {
+    fan_pid_config_t cfg;
+    float integral;             // Integral term contribution (% output)
+    float prev_temp;            // For derivative-on-measurement
+    bool primed;                // prev_temp valid
+    float output;               // Current PWM percent (rate limited)
+    bool stalled;
+    uint64_t low_rpm_since_ms;  // 0 = fans turning
+} fan_channel_state_t;
+
+typedef struct {
+    volatile uint32_t *regs;
+    fan_channel_state_t ch[FAN_NUM_CHANNELS];
+    int rpm[FAN_NUM];
+    uint64_t rpm_update_ms[FAN_NUM];
+    uint64_t last_update_ms;
+    bool failsafe;              // Temperature unavailable → full speed
+} fan_control_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void fan_control_init(fan_control_t *fc, volatile uint32_t *regs);
+void fan_control_set_config(fan_control_t *fc, fan_channel_t ch,
+                            const fan_pid_config_t *cfg);
+
+// Cheap; call every loop iteration to collect tach readings
+void fan_control_sample_tach(fan_control_t *fc);
+
+// Run one control step. temp_valid=false drives all fans to full (failsafe).
+void fan_control_update(fan_control_t *fc, float temp_c, bool temp_valid);
+
+void fan_control_print(const fan_control_t *fc);
+
+#endif // FAN_CONTROL_H
@@ -0,0 +1,71 @@
+/*
+ * FPGA Service Client
+ *
+ * Talks to whichever process owns the FPGA (fpga_service.h) through its
+ * shared-memory segment: commands go into this client's ring and their
+ * replies come back in the same entries, and the owner's stat snapshots
+ * are read from the stat ring.
+ *
+ * Commands can be pipelined: fpga_client_submit() queues without waiting
+ * and fpga_client_wait() collects replies oldest first. Waiting spins
+ * briefly, then sleeps on a futex the owner wakes. A client is one thread;
+ * use one fpga_client_t per thread.
+ */
+
+#ifndef FPGA_CLIENT_H
+#define FPGA_CLIENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fpga_service.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define FPGA_CLIENT_SPIN            1000    // Reply checks before sleeping
+#define FPGA_CLIENT_SLEEP_MS        100     // Owner liveness check interval
+#define FPGA_CLIENT_TIMEOUT_MS      3000    // I2C ops may queue behind others
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    fpga_service_shm_t *shm;
+    fpga_service_slot_t *slot;
+    uint32_t owner_pid;
+    uint32_t head;                      // Next command position
+    uint32_t tail;                      // Oldest reply not yet collected
+} fpga_client_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// Returns: 0 on success, -1 if no owner is serving or every slot is taken
+int fpga_client_open(fpga_client_t *cl);
+void fpga_client_close(fpga_client_t *cl);
+
+// Pipelined commands
+// Returns: 0 on success, -1 if the ring is full (collect a reply first)
+int fpga_client_submit(fpga_client_t *cl, const fpga_cmd_t *cmd);
+// Returns: 0 with the reply in *reply, -1 if the owner is gone or timed out
+int fpga_client_wait(fpga_client_t *cl, fpga_cmd_t *reply);
+// Submit and wait; Returns: reply status (FPGA_CMD_OK or -errno)
+int fpga_client_call(fpga_client_t *cl, fpga_cmd_t *cmd);
+// Replies overwrite cmds; Returns: FPGA_CMD_OK, or -EIO if the owner stopped
+int fpga_client_call_batch(fpga_client_t *cl, fpga_cmd_t *cmds, int count);
+
+// Register helpers; Returns: FPGA_CMD_OK or -errno
+int fpga_client_read_reg(fpga_client_t *cl, uint32_t addr, uint32_t *value);
+int fpga_client_write_reg(fpga_client_t *cl, uint32_t addr, uint32_t value);
+
+// Stats
+// Returns: 1 with a snapshot, 0 if none published yet
+int fpga_client_latest_stat(fpga_client_t *cl, fpga_stat_t *stat);
+// Next snapshot after *cursor (snapshots overwritten meanwhile are skipped)
+// Returns: 1 with a snapshot, 0 if there is no newer one
+int fpga_client_next_stat(fpga_client_t *cl, uint32_t *cursor, fpga_stat_t *stat);
+
+#endif // FPGA_CLIENT_H
@@ -0,0 +1,124 @@
+/*
+ * FPGA I2C Transaction Scheduler
+ *
+ * The FPGA exposes a single I2C controller at register 0x030 that is shared
+ * by the APW12 PSU, the per-chain PIC microcontrollers and the per-chain
+ * hashboard EEPROMs. This module owns that controller: clients queue
+ * byte-level transactions with a priority, and one worker thread issues
+ * them back to back, always picking the highest priority pending request.
+ *
+ * A transaction is a single controller command (one byte written or read).
+ * A multi-byte PSU or PIC message is queued as one frame, which runs back to
+ * back so no other client's byte lands inside it. The longest a PSU voltage
+ * step can be delayed is the EEPROM byte or PIC frame already on the wire.
+ */
+
+#ifndef FPGA_I2C_H
+#define FPGA_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+//==============================================================================
+// Controller Register Definitions
+//==============================================================================
+
+#define FPGA_I2C_REG                (0x030 / 4)
+
+// Controller status/command bits
+#define FPGA_I2C_READY              (1U << 31)
+#define FPGA_I2C_DATA_READY         (0x2U << 30)
+#define FPGA_I2C_STATUS_MASK        (0x3U << 30)
+#define FPGA_I2C_READ_OP            (1U << 25)
+#define FPGA_I2C_REGADDR_VALID      (1U << 24)
+#define FPGA_I2C_READ_1BYTE         (1U << 19)
+
+// EEPROM reads use both operation bits (bits 24-25)
+#define FPGA_I2C_EEPROM_READ        0x03000000
+#define FPGA_I2C_EEPROM_SLAVE       0xA0
+
+//==============================================================================
+// Scheduler Configuration
+//==============================================================================
+
+#define FPGA_I2C_QUEUE_DEPTH        256     // Pending ops per priority level
+#define FPGA_I2C_TIMEOUT_MS         1000    // Per-op controller timeout
+#define FPGA_I2C_POLL_US            20      // Controller poll interval
+
+// Priority levels (lower value = served first)
+typedef enum {
+    FPGA_I2C_PRIO_PSU = 0,      // PSU voltage control (time-critical)
+    FPGA_I2C_PRIO_PIC,          // Hashboard PIC (DC-DC enable)
+    FPGA_I2C_PRIO_EEPROM,       // Bulk EEPROM reads
+    FPGA_I2C_NUM_PRIO
+} fpga_i2c_prio_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+// Single controller transaction (caller-owned until completed)
+typedef struct {
+    uint32_t cmd;               // Raw command word written to 0x030
+    uint32_t done_mask;         // Status bits that signal completion
+    uint32_t done_value;        // Expected value of the masked status bits
+    fpga_i2c_prio_t prio;
+    uint8_t data;               // Response byte (valid when status == 0)
+    int status;                 // 0 = success, -1 = controller timeout
+    bool done;
+    uint64_t submit_ns;         // Internal: enqueue timestamp
+    size_t frame_len;           // Internal: ops run as one unit from here
+    bool *batch_failed;         // Internal: set when a batch op fails
+} fpga_i2c_op_t;
+
+typedef struct {
+    uint64_t ops[FPGA_I2C_NUM_PRIO];            // Completed transactions
+    uint64_t errors[FPGA_I2C_NUM_PRIO];         // Timed-out transactions
+    uint64_t wait_ns_total[FPGA_I2C_NUM_PRIO];  // Sum of queue wait times
+    uint64_t wait_ns_max[FPGA_I2C_NUM_PRIO];    // Worst queue wait time
+    uint64_t busy_ns;                           // Time the controller was in use
+    uint64_t elapsed_ns;                        // Time since scheduler start
+} fpga_i2c_stats_t;
+
+typedef struct {
+    volatile uint32_t *regs;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;     // Signalled when ops are queued
+    pthread_cond_t done_cv;     // Signalled when ops complete or slots free up
+    fpga_i2c_op_t *queue[FPGA_I2C_NUM_PRIO][FPGA_I2C_QUEUE_DEPTH];  // Frame heads
+    unsigned int head[FPGA_I2C_NUM_PRIO];
+    unsigned int count[FPGA_I2C_NUM_PRIO];
+    bool running;
+    uint64_t start_ns;
+    fpga_i2c_stats_t stats;
+} fpga_i2c_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// Scheduler lifecycle
+int fpga_i2c_init(fpga_i2c_t *bus, volatile uint32_t *regs);
+void fpga_i2c_cleanup(fpga_i2c_t *bus);
+
+// Transaction builders
+void fpga_i2c_op_psu(fpga_i2c_op_t *op, uint8_t reg, uint8_t data, bool read);
+void fpga_i2c_op_pic(fpga_i2c_op_t *op, int chain, uint8_t data, bool read);
+void fpga_i2c_op_eeprom(fpga_i2c_op_t *op, int chain, uint8_t addr);
+
+// Queueing and completion
+int fpga_i2c_submit(fpga_i2c_t *bus, fpga_i2c_op_t *op);
+int fpga_i2c_wait(fpga_i2c_t *bus, fpga_i2c_op_t *op);
+bool fpga_i2c_done(fpga_i2c_t *bus, const fpga_i2c_op_t *op);
+int fpga_i2c_xfer(fpga_i2c_t *bus, fpga_i2c_op_t *op);
+int fpga_i2c_xfer_batch(fpga_i2c_t *bus, fpga_i2c_op_t *ops, size_t count);
+int fpga_i2c_xfer_frame(fpga_i2c_t *bus, fpga_i2c_op_t *ops, size_t count);
+
+// Metrics
+void fpga_i2c_get_stats(fpga_i2c_t *bus, fpga_i2c_stats_t *stats);
+void fpga_i2c_print_stats(fpga_i2c_t *bus);
+
+#endif // FPGA_I2C_H
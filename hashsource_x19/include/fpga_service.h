@@ -0,0 +1,171 @@
+/*
+ * FPGA Ownership and Shared-Memory Service
+ *
+ * Exactly one process maps /dev/axi_fpga_dev for writing: the owner. It
+ * claims FPGA_SERVICE_LOCK with flock() before mapping, so a second tool
+ * started against a running miner fails up front instead of racing it on
+ * the BC command buffer or the I2C controller. The kernel drops the claim
+ * when the owner exits, including on a crash.
+ *
+ * The owner (hashsource_miner, or fpgad when no miner runs) serves other
+ * processes through a POSIX shared-memory segment:
+ *
+ *   - one command ring per client slot, single producer (the client) and
+ *     single consumer (the owner's service loop). A command's reply is
+ *     written into its own ring entry, so a client can keep up to
+ *     FPGA_SERVICE_RING commands in flight and collect the replies in order.
+ *   - one stat ring the owner publishes a snapshot into every
+ *     FPGA_SERVICE_STAT_MS. Each entry carries its own sequence number
+ *     (odd while being written), so any number of readers can follow it
+ *     without locks.
+ *
+ * The owner runs commands from its own loop (fpga_service_poll()), so they
+ * are serialized with its own register traffic. I2C commands go through the
+ * owner's priority scheduler (fpga_i2c.h) and complete on a later poll;
+ * the loop never waits on the bus. Registers whose access has side effects
+ * the owner depends on (nonce FIFO, work FIFO, BC command buffer, I2C
+ * controller) are refused.
+ *
+ * In steady state nothing enters the kernel: both sides only load and store
+ * ring counters. A client that has to wait sleeps on a futex, and the owner
+ * wakes it only when the client has said it is asleep. fpgad, which has
+ * nothing else to do, sleeps on a doorbell futex the same way.
+ */
+
+#ifndef FPGA_SERVICE_H
+#define FPGA_SERVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "board_profile.h"
+#include "fan_control.h"
+#include "fpga_i2c.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define FPGA_SERVICE_LOCK           "/var/run/hashsource_fpga.lock"
+#define FPGA_SERVICE_SHM            "/hashsource_fpga"      // shm_open() name
+#define FPGA_SERVICE_MAGIC          0x48534650              // "HSFP"
+#define FPGA_SERVICE_VERSION        2
+
+#define FPGA_SERVICE_CLIENTS        8       // Client slots
+#define FPGA_SERVICE_RING           64      // Commands in flight per client (power of 2)
+#define FPGA_SERVICE_STAT_RING      64      // Snapshots kept (power of 2)
+#define FPGA_SERVICE_STAT_MS        1000    // Snapshot interval
+#define FPGA_SERVICE_POLL_BUDGET    64      // Commands per client per poll
+
+//==============================================================================
+// Commands
+//==============================================================================
+
+typedef enum {
+    FPGA_CMD_READ_REG = 1,              // value = regs[addr]
+    FPGA_CMD_WRITE_REG,                 // regs[addr] = value
+    FPGA_CMD_MODIFY_REG,                // regs[addr] = (regs[addr] & ~mask) | (value & mask)
+    FPGA_CMD_PSU,                       // PSU register addr (read: FPGA_CMD_FLAG_READ)
+    FPGA_CMD_PIC,                       // PIC byte on chain (read: FPGA_CMD_FLAG_READ)
+    FPGA_CMD_EEPROM,                    // EEPROM byte addr on chain
+} fpga_cmd_op_t;
+
+#define FPGA_CMD_FLAG_READ          0x01
+
+// Reply status (negative errno values otherwise)
+#define FPGA_CMD_OK                 0
+
+typedef struct {
+    // Written by the client
+    uint16_t op;                        // fpga_cmd_op_t
+    uint8_t chain;
+    uint8_t flags;
+    uint32_t addr;                      // Register byte offset or I2C address
+    uint32_t value;
+    uint32_t mask;
+    // Written by the owner
+    int32_t status;                     // FPGA_CMD_OK or -errno
+    uint32_t result;
+} fpga_cmd_t;
+
+//==============================================================================
+// Shared Memory Layout
+//==============================================================================
+
+typedef struct {
+    uint32_t pid;                       // Client holding the slot, 0 = free
+    uint32_t waiting;                   // Client is asleep on `done`
+    uint32_t head;                      // Commands queued (client)
+    uint32_t done;                      // Commands answered (owner)
+    fpga_cmd_t cmd[FPGA_SERVICE_RING];
+} fpga_service_slot_t;
+
+typedef struct {
+    uint32_t seq;                       // Odd while being written
+    uint32_t plugged;                   // REG_HASH_ON_PLUG
+    uint32_t hashing;                   // Chains brought up by the owner
+    uint32_t temp_valid;                // Chains with a fresh temperature
+    uint32_t ghs_valid;                 // Chains with an attributed hashrate
+    uint64_t time_ms;                   // CLOCK_MONOTONIC
+    float ghs_total;                    // 1 min hashrate, all chains
+    float ghs[BOARD_MAX_CHAINS];        // 1 min hashrate
+    float temp_c[BOARD_MAX_CHAINS];     // Hottest fresh sensor
+    int32_t fan_rpm[FAN_NUM];
+    float fan_pct;                      // Main PWM channel output
+    uint32_t crc_errors;                // REG_CRC_ERROR_CNT_ADDR
+    uint64_t commands;                  // Client commands answered
+    uint64_t rejected;                  // Client commands refused
+    uint64_t i2c_ops;
+    uint64_t i2c_errors;
+} fpga_stat_t;
+
+typedef struct {
+    uint32_t magic;                     // Set last, once the segment is ready
+    uint32_t version;
+    uint32_t owner_pid;
+    char owner[16];                     // Owner program name
+    uint32_t sleeping;                  // Owner is asleep on `doorbell`
+    uint32_t doorbell;                  // Bumped by clients that wake it
+    uint32_t stat_head;                 // Snapshots published
+    fpga_stat_t stat[FPGA_SERVICE_STAT_RING];
+    fpga_service_slot_t slot[FPGA_SERVICE_CLIENTS];
+} fpga_service_shm_t;
+
+//==============================================================================
+// Owner Side
+//==============================================================================
+
+typedef struct {
+    fpga_service_shm_t *shm;
+    volatile uint32_t *regs;
+    fpga_i2c_t *i2c;
+    bool read_only;                     // Refuse writes and I2C commands
+    uint32_t done[FPGA_SERVICE_CLIENTS];
+    fpga_i2c_op_t i2c_op[FPGA_SERVICE_CLIENTS];     // One I2C command per slot
+    bool i2c_busy[FPGA_SERVICE_CLIENTS];
+    uint64_t commands;
+    uint64_t rejected;
+    uint64_t last_stat_ms;
+} fpga_service_t;
+
+// Ownership (every process that maps the FPGA for writing)
+// Returns: lock fd to keep open, or -1 if another process owns the FPGA
+int fpga_service_claim(const char *who);
+void fpga_service_release(int fd);
+
+// Returns: 0 on success, -1 on error
+int fpga_service_open(fpga_service_t *svc, volatile uint32_t *regs,
+                      fpga_i2c_t *i2c, const char *owner);
+void fpga_service_close(fpga_service_t *svc);
+
+// Run queued client commands; never blocks
+// Returns: commands answered
+int fpga_service_poll(fpga_service_t *svc);
+
+// Sleep until a client queues a command or timeout_ms passes (fpgad only)
+void fpga_service_wait(fpga_service_t *svc, uint32_t timeout_ms);
+
+// Publish a snapshot (the service fills seq, time and its own counters)
+bool fpga_service_stat_due(fpga_service_t *svc);
+void fpga_service_publish(fpga_service_t *svc, fpga_stat_t *stat);
+
+#endif // FPGA_SERVICE_H
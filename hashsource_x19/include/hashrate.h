@@ -0,0 +1,92 @@
+/*
+ * Per-Chip / Per-Chain Hashrate Estimator
+ *
+ * Every returned nonce is a share at the ticket-mask difficulty, so it stands
+ * for difficulty * 2^32 hashes on average. Nonces are attributed to a chip
+ * through a per-chain 256-entry table indexed by the nonce's top byte (the
+ * chip address), avoiding a division per nonce.
+ *
+ * Rates are kept as bias-corrected EWMAs over several windows (5 s, 1 min,
+ * 15 min). Nonce arrivals are Poisson, so each estimate carries a ~95%
+ * confidence interval of rate * (1 +/- 1.96 / sqrt(n)), where n is the
+ * effective number of nonces in the window. All storage is fixed-size.
+ *
+ * The chain number comes from the low nibble of the nonce FIFO word, which
+ * is also nonce data until checked on hardware. Per-chain and per-chip
+ * counters are therefore only kept when asked for (per_chain); the total
+ * over all chains is always kept and does not depend on attribution.
+ */
+
+#ifndef HASHRATE_H
+#define HASHRATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bm1398_asic.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define HASHRATE_MAX_CHIPS          128     // 8-bit address space / interval >= 2
+#define HASHRATE_NO_CHIP            0xFF    // Address table: no chip at address
+#define HASHRATE_Z95                1.96f
+
+typedef enum {
+    HASHRATE_WIN_5S = 0,
+    HASHRATE_WIN_1M,
+    HASHRATE_WIN_15M,
+    HASHRATE_NUM_WINDOWS
+} hashrate_window_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+// One counter stream (a chip or a whole chain)
+typedef struct {
+    uint32_t pending;                       // Nonces since last tick
+    uint64_t total;                         // Nonces since start
+    float ewma[HASHRATE_NUM_WINDOWS];       // Nonces per second (biased)
+    float weight[HASHRATE_NUM_WINDOWS];     // EWMA bias correction
+} hashrate_counter_t;
+
+typedef struct {
+    double ghs;                             // Estimated hashrate (GH/s)
+    double low_ghs;                         // ~95% lower bound
+    double high_ghs;                        // ~95% upper bound
+    double nonces;                          // Effective nonces in window
+} hashrate_estimate_t;
+
+typedef struct {
+    uint8_t addr_to_chip[MAX_CHAINS][256];  // Nonce top byte → chip index
+    int num_chips[MAX_CHAINS];
+    hashrate_counter_t chip[MAX_CHAINS][HASHRATE_MAX_CHIPS];
+    hashrate_counter_t chain[MAX_CHAINS];
+    hashrate_counter_t all;                 // Every nonce, any chain
+    bool per_chain;                         // Attribute by FIFO chain number
+    uint64_t unattributed;                  // Bad chain or address
+    uint32_t difficulty;                    // Ticket mask difficulty
+    uint64_t last_tick_ms;
+} hashrate_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void hashrate_init(hashrate_t *hr, uint32_t difficulty, bool per_chain);
+void hashrate_set_chain(hashrate_t *hr, int chain, int num_chips, int interval);
+uint32_t hashrate_difficulty_from_mask(uint32_t ticket_mask);
+
+// Hot path: O(1), no division
+int hashrate_add_nonce(hashrate_t *hr, int chain, uint32_t nonce);
+
+// Fold pending counts into the EWMAs (call about once per second)
+void hashrate_tick(hashrate_t *hr);
+
+// chain < 0 selects all chains, chip < 0 the whole chain
+int hashrate_get(const hashrate_t *hr, int chain, int chip,
+                 hashrate_window_t window, hashrate_estimate_t *est);
+void hashrate_print(const hashrate_t *hr);
+
+#endif // HASHRATE_H
@@ -0,0 +1,108 @@
+/*
+ * Hashboard Hot-Plug
+ *
+ * bm1398_init() reads REG_HASH_ON_PLUG once. This module keeps watching it
+ * from the service loop. A board that appears is brought up on its own,
+ * while the other chains keep hashing, and a board that disappears is
+ * retired.
+ *
+ *   ABSENT ─(present bit held HOTPLUG_DEBOUNCE_MS)→ attach + PIC DC-DC enable
+ *     → POWERING ─(HOTPLUG_POWER_SETTLE_MS)→ reset + configure (bm1398_init_chain)
+ *     → RAMPING ─(HOTPLUG_RAMP_STEP_MHZ every HOTPLUG_RAMP_STEP_MS)→ ACTIVE
+ *
+ * A failed bring-up retires the chain into FAILED. It is retried after
+ * HOTPLUG_RETRY_MS, at most HOTPLUG_MAX_ATTEMPTS times per insertion. A
+ * present bit that stays clear for HOTPLUG_DEBOUNCE_MS retires the chain
+ * from any state.
+ *
+ * hotplug_recover() sends an ACTIVE chain back through POWERING without
+ * touching its DC-DC: stage 1 reset, stage 2 configuration and the ramp
+ * run for that chain alone (see chain_supervisor.h). The first attempt
+ * replays the chain's recorded bring-up (bm1398_replay_chain()).
+ * HOTPLUG_REPLAY_HOLD_PERCENT scales its hardware settles, and it should
+ * only be lowered once the shorter settles have been verified on the board.
+ *
+ * Every wait is a deadline checked on the next poll, so the loop keeps
+ * draining nonces and running the fans. Only bm1398_init_chain() and the
+ * PIC handshake block, for a few hundred milliseconds. The PSU rail is
+ * shared, so a new board is initialized at the running voltage. It then
+ * starts at HOTPLUG_RAMP_START_MHZ and ramps to the frequency of the
+ * running chains, which spreads its inrush current on the rail.
+ */
+
+#ifndef HOTPLUG_H
+#define HOTPLUG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bm1398_asic.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define HOTPLUG_POLL_MS             500
+#define HOTPLUG_DEBOUNCE_MS         2000    // Board seated / really gone
+#define HOTPLUG_POWER_SETTLE_MS     1000    // After DC-DC enable (main: sleep(1))
+#define HOTPLUG_RAMP_START_MHZ      FREQUENCY_MIN_MHZ
+#define HOTPLUG_RAMP_STEP_MHZ       25
+#define HOTPLUG_RAMP_STEP_MS        200
+#define HOTPLUG_RETRY_MS            30000
+#define HOTPLUG_MAX_ATTEMPTS        3
+#define HOTPLUG_REPLAY_HOLD_PERCENT 100
+
+typedef enum {
+    HOTPLUG_ABSENT = 0,
+    HOTPLUG_DEBOUNCE,                   // Present bit seen, waiting for it to hold
+    HOTPLUG_POWERING,                   // DC-DC enabled, rails settling
+    HOTPLUG_RAMPING,                    // Initialized, stepping up the PLL
+    HOTPLUG_ACTIVE,
+    HOTPLUG_FAILED,                     // Bring-up failed, waiting to retry
+} hotplug_state_t;
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    hotplug_state_t state;
+    uint64_t deadline_ms;               // Next step of the current state
+    uint64_t plugged_ms;                // Present bit first seen
+    uint64_t absent_since_ms;           // 0 = present bit set
+    uint32_t ramp_mhz;
+    uint32_t target_mhz;
+    int attempts;                       // Bring-ups since insertion
+    uint32_t insertions;
+    uint32_t removals;
+    uint32_t bringup_ms;                // Last insertion → ACTIVE
+    bool recover;                       // Re-initialize on the next poll
+    bool recovering;                    // Left ACTIVE for a recovery
+} hotplug_chain_t;
+
+typedef struct {
+    bm1398_context_t *ctx;
+    hotplug_chain_t chain[MAX_CHAINS];
+    uint64_t next_poll_ms;
+} hotplug_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// Chains with chips are taken as ACTIVE, detected ones without as FAILED
+void hotplug_init(hotplug_t *hp, bm1398_context_t *ctx);
+
+// Advance every chain's state machine (call from the service loop)
+// *added / *removed get a bit per chain that became ACTIVE / left ACTIVE
+// (board removed, or taken down for recovery) during this call
+// Returns: 0
+int hotplug_poll(hotplug_t *hp, uint32_t *added, uint32_t *removed);
+
+// Re-initialize an ACTIVE chain in place, on the next poll
+// Returns: 0, or -1 if the chain is not ACTIVE
+int hotplug_recover(hotplug_t *hp, int chain);
+
+const char *hotplug_state_name(hotplug_state_t state);
+void hotplug_print(const hotplug_t *hp);
+
+#endif // HOTPLUG_H
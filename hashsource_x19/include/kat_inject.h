@@ -0,0 +1,138 @@
+/*
+ * Live Known-Answer Injection
+ *
+ * Mixes pattern packets with known nonces into the work stream while mining,
+ * so a core that silently stops hashing is noticed without taking the board
+ * out of service.
+ *
+ * Every TW packet occupies the whole chain for one nonce sweep
+ * (work_timing_t.sweep_us), whatever it carries. A probe packet therefore
+ * costs exactly one sweep of hashing, and injecting permille/1000 packets per
+ * sweep caps the hashrate cost at that fraction. Probes are paced on elapsed
+ * time, not on the number of live packets, so the cost holds even while the
+ * live feeder is idle.
+ *
+ * Each probe packet targets one chip. Up to four of its cores go in one
+ * packet, one per midstate slot, when their patterns share work_data. Chips
+ * are visited round-robin. Within a chip the cores are covered in order,
+ * moving to the next pattern slot after each pass. A probe that has not come
+ * back within KAT_DEADLINE_MS counts as a miss for its core. KAT_FLAG_STREAK
+ * consecutive misses flag the core, and its next hit clears the flag.
+ *
+ * A chip whose last KAT_STUCK_STREAK probes all missed, across its cores, is
+ * reported as stuck (kat_inject_next_stuck()). The caller soft-resets it
+ * alone (bm1398_reset_chip()) and calls kat_inject_verify_chip(), which
+ * sends it one probe packet at once. The first hit marks the chip as
+ * recovered. A stuck chip is reported again after KAT_STUCK_RETRY_MS while
+ * it stays silent.
+ *
+ * Patterns come from a pattern bundle (pattern_pack). Probe nonces are
+ * matched by value against the probes in flight on every chain: the chain
+ * number in the FIFO word is not verified, so it is not used. A pattern is
+ * never in flight on two chains at once, and each chain starts its pattern
+ * slots at a different offset, so an answer belongs to exactly one probe.
+ * Probes are sent with work ID KAT_WORK_ID, which the live feeder must not
+ * use.
+ */
+
+#ifndef KAT_INJECT_H
+#define KAT_INJECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bm1398_asic.h"
+#include "pattern_bundle.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define KAT_MAX_CHIPS               PATTERN_MAX_CHIPS
+#define KAT_DEFAULT_PERMILLE        10      // 1% of chain time
+#define KAT_MAX_PERMILLE            500
+#define KAT_MAX_BURST               4       // Probes owed while the FIFO is full
+#define KAT_DEADLINE_MS             2000    // Queue latency is a few sweeps
+#define KAT_FLAG_STREAK             3       // Consecutive misses to flag a core
+#define KAT_SWEEP_INTERVAL_MS       250     // Deadline scan period
+#define KAT_WORK_ID                 0x1F    // Reserved for probe packets
+#define KAT_MIDSTATE_SLOTS          4
+#define KAT_STUCK_STREAK            8       // Chip-wide consecutive misses
+#define KAT_STUCK_RETRY_MS          60000   // Between resets of a silent chip
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+// One (chip, core) under observation
+typedef struct {
+    uint32_t expect;                // Nonce of the probe in flight
+    uint64_t deadline_ms;           // 0 = nothing in flight
+    uint32_t hits;
+    uint32_t misses;
+    uint8_t streak;                 // Consecutive misses
+    bool flagged;
+} kat_core_t;
+
+// Chip-wide state for stuck-chip recovery
+typedef struct {
+    uint8_t streak;                 // Consecutive misses on any core
+    bool stuck;
+    uint64_t reported_ms;           // Last handed out by kat_inject_next_stuck()
+    uint64_t verify_sent_ms;
+    uint64_t verify_deadline_ms;    // 0 = no verification in flight
+} kat_chip_t;
+
+typedef struct {
+    uint64_t probes;                // Patterns sent (up to 4 per packet)
+    uint64_t packets;
+    uint64_t hits;
+    uint64_t misses;
+    int flagged;                    // Cores currently flagged
+    uint32_t chip_resets;           // Verifications started after a reset
+    uint32_t chips_recovered;       // ... that the chip answered
+} kat_chain_stats_t;
+
+typedef struct {
+    const pattern_bundle_t *bundle;
+    int permille;                   // Share of chain time spent on probes
+
+    uint8_t addr_to_chip[MAX_CHAINS][256];  // Nonce top byte → chip index
+    int num_chips[MAX_CHAINS];
+    int next_chip[MAX_CHAINS];
+    uint8_t next_core[MAX_CHAINS][KAT_MAX_CHIPS];
+    uint8_t next_slot[MAX_CHAINS][KAT_MAX_CHIPS];
+    kat_core_t core[MAX_CHAINS][KAT_MAX_CHIPS][PATTERN_CORES];
+    kat_chip_t chip[MAX_CHAINS][KAT_MAX_CHIPS];
+
+    uint64_t credit[MAX_CHAINS];    // Probe packets owed, in 1/1000 units
+    uint64_t last_us[MAX_CHAINS];
+    uint64_t last_sweep_ms;
+    kat_chain_stats_t stats[MAX_CHAINS];
+} kat_inject_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// bundle must stay open while the injector is in use
+void kat_inject_init(kat_inject_t *kat, const pattern_bundle_t *bundle, int permille);
+void kat_inject_set_chain(kat_inject_t *kat, int chain, int num_chips, int interval);
+
+// Send the probes owed since the last call and expire overdue ones
+// Returns: probe packets sent, or -1 on a send error
+int kat_inject_poll(kat_inject_t *kat, bm1398_context_t *ctx);
+
+// Hot path: true if the nonce answered a probe (not a share for the pool)
+bool kat_inject_nonce(kat_inject_t *kat, uint32_t nonce);
+
+// Next stuck chip due for a reset
+// Returns: true with *chain / *chip set, or false if none
+bool kat_inject_next_stuck(kat_inject_t *kat, int *chain, int *chip);
+// Probe a chip at once after its reset; the verdict is printed and counted
+// Returns: 0 on success, -1 if no probe could be sent
+int kat_inject_verify_chip(kat_inject_t *kat, bm1398_context_t *ctx, int chain, int chip);
+
+bool kat_inject_core_flagged(const kat_inject_t *kat, int chain, int chip, int core);
+void kat_inject_print(const kat_inject_t *kat);
+
+#endif // KAT_INJECT_H
@@ -0,0 +1,89 @@
+/*
+ * Compact Pattern Bundle (.hspb)
+ *
+ * Only 48 of the 116 bytes in each btc-asic-NNN.bin entry are ever used
+ * (work_data, midstate, nonce). A bundle keeps just those fields for every
+ * chip file in one file:
+ *
+ *   0x00  pattern_bundle_header_t (64 bytes, little-endian)
+ *   0x40  entries[chips][cores][slots], 48 bytes each (16-byte aligned)
+ *
+ * work_data and midstate are stored as the 32-bit words that go to the TW
+ * FIFO (already byte-swapped, see bm1398_send_work_swapped()). The nonce is
+ * stored as the value read back from the nonce FIFO. All 128 chip files fit
+ * in about 4 MB instead of 73 MB.
+ *
+ * Both the header and the payload carry a CRC-32. Bundles are built with
+ * the pattern_pack tool.
+ */
+
+#ifndef PATTERN_BUNDLE_H
+#define PATTERN_BUNDLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pattern_file.h"
+
+//==============================================================================
+// Format
+//==============================================================================
+
+#define PATTERN_BUNDLE_MAGIC        "HSPB"
+#define PATTERN_BUNDLE_VERSION      1
+#define PATTERN_BUNDLE_DEFAULT_NAME "patterns.hspb"
+
+typedef struct {
+    uint32_t work_data_be[3];   // TW words 2-4
+    uint32_t midstate_be[8];    // One midstate slot
+    uint32_t nonce;             // Expected nonce (host order)
+} pattern_bundle_entry_t;       // 48 bytes
+
+typedef struct {
+    char magic[4];              // "HSPB"
+    uint16_t version;
+    uint16_t header_size;       // Offset of entries[]
+    uint16_t num_chips;         // Chip slots in entries[] (present or not)
+    uint16_t cores;
+    uint16_t slots;             // Patterns per core
+    uint16_t entry_size;
+    uint32_t chip_present[PATTERN_MAX_CHIPS / 32];  // Bit n: chip n packed
+    uint32_t payload_crc;       // CRC-32 of entries[]
+    uint32_t reserved[6];
+    uint32_t header_crc;        // CRC-32 of all preceding header bytes
+} pattern_bundle_header_t;      // 64 bytes
+
+//==============================================================================
+// Runtime Access
+//==============================================================================
+
+typedef struct {
+    const uint8_t *base;        // Read-only mapping
+    size_t size;
+    const pattern_bundle_header_t *hdr;
+    const pattern_bundle_entry_t *entries;
+} pattern_bundle_t;
+
+int pattern_bundle_open(pattern_bundle_t *b, const char *path);
+void pattern_bundle_close(pattern_bundle_t *b);
+bool pattern_bundle_has_chip(const pattern_bundle_t *b, int chip);
+
+// Zero-copy entry, or NULL if out of range / chip not packed
+const pattern_bundle_entry_t *pattern_bundle_get(const pattern_bundle_t *b,
+                                                 int chip, int core, int slot);
+
+//==============================================================================
+// Conversion
+//==============================================================================
+
+// Pack chips [0, num_chips) from a pattern set; missing files are skipped
+// Returns: number of chips packed, or -1 on error
+int pattern_bundle_write(const char *path, pattern_set_t *ps, int num_chips);
+
+// Write entries[num_chips][PATTERN_CORES][PATTERN_SLOTS_PER_CORE] directly
+// (e.g. generated patterns); chip_present as in the header
+// Returns: 0 on success, -1 on error
+int pattern_bundle_write_entries(const char *path, const pattern_bundle_entry_t *entries,
+                                 int num_chips, const uint32_t *chip_present);
+
+#endif // PATTERN_BUNDLE_H
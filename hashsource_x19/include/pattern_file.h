@@ -0,0 +1,72 @@
+/*
+ * Pattern File Access (btc-asic-NNN.bin)
+ *
+ * Bitmain factory pattern files are mapped read-only on first use instead of
+ * being fread() 116 bytes at a time into a heap copy. Entries are located
+ * through a shared (core, pattern) → offset index, and callers get pointers
+ * straight into the mapping, so a full board costs page cache only.
+ *
+ * Layout (parse_bin_file_to_pattern_ex, see docs/PATTERN_TEST.md): entries
+ * are read sequentially, 8 slots per core, 0x74 bytes each.
+ */
+
+#ifndef PATTERN_FILE_H
+#define PATTERN_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+#define PATTERN_DEFAULT_DIR         "/tmp/BM1398-pattern"
+#define PATTERN_MAX_CHIPS           128     // btc-asic-000.bin .. btc-asic-127.bin
+#define PATTERN_CORES               80      // 16 small cores × 5 big cores
+#define PATTERN_SLOTS_PER_CORE      8       // Config.ini Pattern_Number
+#define PATTERN_ENTRY_SIZE          0x74    // 116 bytes per entry
+#define PATTERN_FILE_SIZE           579072  // Stock S19 Pro pattern file
+#define PATTERNS_PER_CHIP           (PATTERN_CORES * PATTERN_SLOTS_PER_CORE)
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+// Pattern file entry (116 bytes = 0x74)
+// Verified from Binary Ninja decompilation of single_board_test @ 0x1C890
+typedef struct __attribute__((packed)) {
+    uint8_t  header[15];     // Offset 0x00-0x0E: Header/metadata
+    uint8_t  work_data[12];  // Offset 0x0F-0x1A: Last 12 bytes of block header
+    uint8_t  midstate[32];   // Offset 0x1B-0x3A: SHA256 midstate
+    uint8_t  reserved[29];   // Offset 0x3B-0x57: Padding/reserved
+    uint32_t nonce;          // Offset 0x58-0x5B: Expected nonce (little-endian)
+    uint8_t  trailer[24];    // Offset 0x5C-0x73: Additional data
+} test_pattern_t;  // Total: 116 bytes (0x74)
+
+typedef struct {
+    const uint8_t *base;    // Read-only mapping, NULL until first use
+    size_t size;
+    int failed;             // Open/validate failed; don't retry
+} pattern_file_t;
+
+typedef struct {
+    char dir[256];
+    uint32_t index[PATTERN_CORES][PATTERN_SLOTS_PER_CORE];  // Entry offsets
+    size_t min_size;        // Smallest file covering every indexed entry
+    pattern_file_t files[PATTERN_MAX_CHIPS];
+} pattern_set_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void pattern_set_init(pattern_set_t *ps, const char *dir);
+void pattern_set_close(pattern_set_t *ps);
+
+// Map and validate one chip's file now (optional; pattern_get maps lazily)
+int pattern_set_map(pattern_set_t *ps, int chip);
+
+// Zero-copy entry pointer, or NULL if the chip's file is unusable
+const test_pattern_t *pattern_get(pattern_set_t *ps, int chip, int core, int slot);
+
+#endif // PATTERN_FILE_H
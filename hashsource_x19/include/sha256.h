@@ -0,0 +1,64 @@
+/*
+ * SHA-256 / Bitcoin Header Hashing (host tools)
+ *
+ * Double SHA-256 of an 80-byte block header, split the way the ASIC sees
+ * it: a midstate (state after header bytes 0-63) plus the three remaining
+ * header words and the nonce. All words are SHA-256 message words, i.e.
+ * header bytes read big-endian.
+ *
+ * Several scan implementations exist; sha256d_impls() lists the ones this
+ * CPU supports:
+ *   sha-ni     x86 SHA extensions, one nonce at a time
+ *   avx512     16 nonces per pass (GCC vector extensions)
+ *   avx2       8 nonces per pass
+ *   sse2/neon  4 nonces per pass
+ *   scalar     portable reference
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stdint.h>
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    uint32_t midstate[8];       // State after header bytes 0-63
+    uint32_t tail[3];           // Header words 16-18: merkle tail, ntime, nbits
+} sha256d_job_t;
+
+/**
+ * Hash nonces [first, first + count) and collect those whose hash, read as
+ * Bitcoin's little-endian 256-bit number, has its top 64 bits <= limit
+ * Returns: number of hits stored (stops early at max_hits)
+ */
+typedef int (*sha256d_scan_fn)(const sha256d_job_t *job, uint32_t first, uint32_t count,
+                               uint64_t limit, uint32_t *hits, int max_hits);
+
+typedef struct {
+    const char *name;
+    sha256d_scan_fn scan;
+} sha256d_impl_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void sha256_init_state(uint32_t state[8]);
+void sha256_compress(uint32_t state[8], const uint32_t block[16]);
+
+// Midstate of header bytes 0-63
+void sha256_midstate(const uint8_t header[64], uint32_t state[8]);
+
+// Top 64 bits of the double hash for one nonce (reference implementation)
+uint64_t sha256d_top64(const sha256d_job_t *job, uint32_t nonce);
+
+// Limit for sha256d_scan_fn at a share difficulty (1.0 = 32 leading zero bits)
+uint64_t sha256d_limit(double difficulty);
+
+// Implementations usable on this CPU, fastest expected first
+int sha256d_impls(const sha256d_impl_t **impls);
+
+#endif // SHA256_H
@@ -0,0 +1,94 @@
+/*
+ * Startup Dependency Scheduler
+ *
+ * Startup is a graph of tasks (PSU power-on, PIC DC-DC enable, EEPROM
+ * reads, fan spin-up check, chain init, ...) run by one event loop. A task
+ * is a step function called repeatedly. After each step it either finishes
+ * or names how long to wait before its next step. While one task waits,
+ * the loop runs any other task whose dependencies are met, so the long
+ * power-sequencing waits overlap instead of adding up.
+ *
+ * Dependencies come in two kinds:
+ *   - needs: the other task must succeed; if it fails this task fails too
+ *   - after: the other task must only have finished (ordering)
+ *
+ * Steps block the loop while they run (I2C transactions, a chain init), so
+ * only the waits between steps overlap. Ready tasks run in the order they
+ * were added. Everything runs on the calling thread.
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define STARTUP_MAX_TASKS           32      // One bit each in the dependency masks
+
+typedef enum {
+    STARTUP_DONE = 0,                   // Task finished successfully
+    STARTUP_NEXT,                       // Run the next step after *wait_ms
+    STARTUP_FAILED,
+} startup_result_t;
+
+typedef enum {
+    STARTUP_PENDING = 0,                // Waiting for dependencies
+    STARTUP_RUNNING,
+    STARTUP_SUCCEEDED,
+    STARTUP_ABORTED,                    // Failed, or a needed task failed
+} startup_state_t;
+
+// step counts from 0; chain is the value given to startup_add()
+typedef startup_result_t (*startup_step_fn)(void *arg, int chain, int step,
+                                            uint32_t *wait_ms);
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    const char *name;
+    int chain;                          // -1 = not tied to a chain
+    startup_step_fn fn;
+    void *arg;
+    uint32_t needs;                     // Task bits that must succeed
+    uint32_t after;                     // Task bits that must finish
+    startup_state_t state;
+    int step;
+    uint64_t wake_ms;                   // Next step not before this
+    uint64_t start_ms;                  // First step
+    uint64_t end_ms;
+    uint64_t busy_ms;                   // Time spent inside steps
+    uint64_t wait_ms;                   // Waits asked for between steps
+} startup_task_t;
+
+typedef struct {
+    startup_task_t tasks[STARTUP_MAX_TASKS];
+    int num_tasks;
+    uint64_t start_ms;
+    uint64_t end_ms;
+} startup_graph_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+void startup_init(startup_graph_t *g);
+
+// Returns: task id (use STARTUP_BIT(id) in needs/after), or -1 if full
+int startup_add(startup_graph_t *g, const char *name, int chain,
+                startup_step_fn fn, void *arg, uint32_t needs, uint32_t after);
+#define STARTUP_BIT(id)             ((id) >= 0 ? 1u << (id) : 0u)
+
+// Run every task to completion
+// Returns: number of tasks that did not succeed
+int startup_run(startup_graph_t *g);
+
+bool startup_succeeded(const startup_graph_t *g, int id);
+void startup_print(const startup_graph_t *g);
+
+#endif // STARTUP_H
@@ -0,0 +1,98 @@
+/*
+ * BM1398 On-Die Temperature Sampling Engine
+ *
+ * Stage 2 routes the on-die diode to ASIC_REG_DIODE_MUX (diode_vdd_mux_sel).
+ * This engine reads that register from a fixed set of sensor chips on each
+ * chain (bmminer: "max sensor num = 4") and keeps a fixed-size history per
+ * sensor with min/max/EWMA and a staleness flag.
+ *
+ * Reads are issued as unicast async register reads, one outstanding per
+ * chain, and their responses are picked out of the nonce FIFO by the normal
+ * nonce drain. temp_monitor_poll() never waits on the FIFO, so sampling
+ * cannot stall work submission or nonce draining. All calls (including the
+ * nonce drain that delivers responses) must come from the same thread.
+ *
+ * The diode scaling has not been checked against bmminer on hardware, so
+ * readings are only converted to degrees when the caller opts in. Without
+ * that the reads still run and count answers and timeouts (the chain
+ * supervisor uses them to see that a chain responds), but no sensor ever
+ * reports a temperature.
+ */
+
+#ifndef TEMP_MONITOR_H
+#define TEMP_MONITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bm1398_asic.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEMP_SENSORS_PER_CHAIN      4       // bmminer: "max sensor num = 4"
+#define TEMP_HISTORY_LEN            64      // Samples kept per sensor
+#define TEMP_SAMPLE_INTERVAL_MS     250     // Per-chain read spacing (round-robin)
+#define TEMP_READ_TIMEOUT_MS        100     // Drop a read with no response;
+                                            // the chain then rests one interval
+#define TEMP_STALE_MS               5000    // No fresh sample → stale
+#define TEMP_EWMA_ALPHA             0.2f
+
+#define TEMP_SENSOR_REG             ASIC_REG_DIODE_MUX
+
+// Valid reading range; anything outside is treated as a bad sample
+#define TEMP_MIN_VALID_C            -40.0f
+#define TEMP_MAX_VALID_C            150.0f
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    uint8_t  chip_addr;                 // Chip the sensor is read from
+    float    history[TEMP_HISTORY_LEN]; // Ring of recent samples (°C)
+    uint16_t head;                      // Next write position
+    uint16_t count;                     // Valid samples in ring
+    float    last;
+    float    min;
+    float    max;
+    float    ewma;
+    uint64_t last_update_ms;            // 0 = never sampled
+    uint32_t samples;
+    uint32_t responses;                 // Reads answered, converted or not
+    uint32_t last_raw;                  // Last response word
+    uint32_t timeouts;                  // Reads dropped without a response
+    uint32_t rejects;                   // Out-of-range readings
+} temp_sensor_t;
+
+typedef struct {
+    bm1398_context_t *ctx;
+    bool convert;                       // Report degrees (scaling unverified)
+    temp_sensor_t sensors[MAX_CHAINS][TEMP_SENSORS_PER_CHAIN];
+    int num_sensors[MAX_CHAINS];        // 0 = chain not sampled
+    int next_sensor[MAX_CHAINS];        // Round-robin position
+    int pending_sensor[MAX_CHAINS];     // Sensor awaiting response, -1 = idle
+    uint64_t pending_since_ms[MAX_CHAINS];
+    uint64_t next_sample_ms[MAX_CHAINS];
+} temp_monitor_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+// Lifecycle (registers the driver's register-response callback)
+int temp_monitor_init(temp_monitor_t *tm, bm1398_context_t *ctx, bool convert);
+void temp_monitor_cleanup(temp_monitor_t *tm);
+void temp_monitor_set_chain(temp_monitor_t *tm, int chain, int chips);
+void temp_monitor_set_sensor(temp_monitor_t *tm, int chain, int sensor,
+                             uint8_t chip_addr);
+
+// Non-blocking sampling step (call from the main loop after draining nonces)
+void temp_monitor_poll(temp_monitor_t *tm);
+
+// Queries
+bool temp_monitor_is_stale(const temp_monitor_t *tm, int chain, int sensor);
+int temp_monitor_chain_max(const temp_monitor_t *tm, int chain, float *temp_c);
+void temp_monitor_print(const temp_monitor_t *tm);
+
+#endif // TEMP_MONITOR_H
@@ -0,0 +1,66 @@
+/*
+ * Work Timing Calculator
+ *
+ * Derives the FPGA work timeout, the ASIC hash counting number (hcn) and the
+ * FPGA work-queue parameters from frequency, chain length, chip address
+ * interval and a target utilization percent.
+ *
+ * Reference point (bmminer log, S19 Pro, 114 chips, interval 2):
+ *   "freq = 525, percent = 90, hcn = 12480, timeout = 449"
+ *
+ * Each chip owns interval/256 of the 32-bit nonce space and sweeps it at
+ * 128 nonces per core clock, so one full sweep takes
+ *   sweep_us = 2^32 * interval / 256 / 128 / freq_mhz = 2^17 * interval / freq_mhz
+ * (499.3 us at 525 MHz). The FPGA timeout is that sweep scaled by percent
+ * (449), and hcn is the sweep counted in 25 MHz reference clocks, rounded
+ * down to the 64-count granularity of the counter (12483 → 12480).
+ */
+
+#ifndef WORK_TIMING_H
+#define WORK_TIMING_H
+
+#include <stdint.h>
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+#define WORK_TIMING_CLKI_MHZ            25      // ASIC reference clock
+#define WORK_TIMING_NONCES_PER_CLK      128     // Nonces per core clock per chip
+#define WORK_TIMING_HCN_GRANULARITY     64
+#define WORK_TIMING_DEFAULT_PERCENT     90      // bmminer "percent = 90"
+
+#define WORK_TIMING_TIMEOUT_MASK        0x1FFFF
+#define WORK_TIMING_TIMEOUT_ENABLE      0x80000000
+
+// FPGA work queue registers (factory test: base + 32 * chip count)
+#define WORK_QUEUE_PARAM_BASE           0x2808
+#define WORK_QUEUE_PARAM(chips)         (WORK_QUEUE_PARAM_BASE + 32 * (uint32_t)(chips))
+#define CHAIN_WORK_CONFIG(chips)        ((uint32_t)(chips) << 8)
+
+//==============================================================================
+// Data Structures
+//==============================================================================
+
+typedef struct {
+    uint32_t freq_mhz;
+    int chips;
+    int interval;                   // Chip address interval
+    int percent;                    // Target utilization of one nonce sweep
+    uint32_t sweep_us;              // Full nonce-range sweep time per chip
+    uint32_t timeout;               // FPGA work timeout (FPGA_REG_TIMEOUT units)
+    uint32_t hcn;                   // ASIC_REG_HASH_COUNTING value
+    uint32_t chain_work_config;     // FPGA_REG_CHAIN_WORK_CONFIG value
+    uint32_t work_queue_param;      // FPGA_REG_WORK_QUEUE_PARAM value
+} work_timing_t;
+
+//==============================================================================
+// Function Prototypes
+//==============================================================================
+
+int work_timing_interval(int chips);
+void work_timing_addr_table(uint8_t table[256], int chips, int interval, uint8_t none);
+int work_timing_calc(work_timing_t *t, uint32_t freq_mhz, int chips,
+                     int interval, int percent);
+
+#endif // WORK_TIMING_H
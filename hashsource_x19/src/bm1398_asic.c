@@ -17,7 +17,10 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <time.h>
 #include "../include/bm1398_asic.h"
+#include "../include/boot_trace.h"
+#include "../include/fpga_service.h"
 
 //==============================================================================
 // Linux I2C Constants
@@ -123,33 +126,33 @@ void fpga_write_indirect(bm1398_context_t *ctx, int logical_index, uint32_t valu
 // Initialization and Cleanup
 //==============================================================================
 
-int bm1398_init(bm1398_context_t *ctx) {
-    if (!ctx) {
-        return -1;
-    }
-
-    memset(ctx, 0, sizeof(*ctx));
-
-    // Open FPGA device
-    int fd = open("/dev/axi_fpga_dev", O_RDWR | O_SYNC);
-    if (fd < 0) {
-        fprintf(stderr, "Error: Cannot open /dev/axi_fpga_dev: %s\n", strerror(errno));
-        fprintf(stderr, "Hint: Ensure bitmain_axi.ko kernel module is loaded\n");
+/**
+ * Read (or take from the cache) a chain's board identity into ctx->eeprom
+ * Returns: 0 on success, -1 if the EEPROM is unreadable
+ */
+int bm1398_load_eeprom(bm1398_context_t *ctx, int chain) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS) {
         return -1;
     }
 
-    // Memory map FPGA registers
-    ctx->fpga_regs = mmap(NULL, FPGA_REG_SIZE, PROT_READ | PROT_WRITE,
-                          MAP_SHARED, fd, 0);
-    close(fd);
-
-    if (ctx->fpga_regs == MAP_FAILED) {
-        fprintf(stderr, "Error: mmap failed: %s\n", strerror(errno));
+    const int ret = eeprom_load(&ctx->i2c, chain, &ctx->eeprom[chain],
+                                EEPROM_CACHE_PATH, true);
+    if (ret < 0) {
+        fprintf(stderr, "Warning: Chain %d EEPROM unreadable\n", chain);
         return -1;
     }
+    printf("  Chain %d: SN %s, bin %u, %u MHz (%s)\n", chain,
+           ctx->eeprom[chain].board_serial_no, ctx->eeprom[chain].chip_bin,
+           ctx->eeprom[chain].default_freq,
+           ret == EEPROM_LOAD_CACHED ? "cached" : "EEPROM");
+    return 0;
+}
 
-    ctx->initialized = true;
-    ctx->num_chains = 0;
+/**
+ * FPGA mode and work-control setup (bmminer / factory test sequence)
+ */
+static void configure_fpga(bm1398_context_t *ctx) {
+    const int trace = boot_trace_begin("fpga config", BOOT_TRACE_NO_CHAIN);
 
     // CRITICAL: Direct register 0x080/0x088 init MUST happen FIRST
     // Before ANY other FPGA register operations!
@@ -211,15 +214,17 @@ int bm1398_init(bm1398_context_t *ctx) {
 
     // Register 36 (0x11C): Chain/work configuration
     // Factory test uses complex calculation based on config values
-    // Using basic default: (114 chips << 8) = 0x7200
-    fpga_write_indirect(ctx, FPGA_REG_CHAIN_WORK_CONFIG, 0x00007200);
+    // Using basic default from the board profile: chips << 8 (0x7200 for 114)
+    // Recomputed by bm1398_update_work_timing() once chains are configured
+    const int chips = ctx->profile->chips_per_chain;
+    fpga_write_indirect(ctx, FPGA_REG_CHAIN_WORK_CONFIG, CHAIN_WORK_CONFIG(chips));
     printf("  Chain work config register (0x11C): 0x%08X\n",
            fpga_read_indirect(ctx, FPGA_REG_CHAIN_WORK_CONFIG));
 
     // Register 42 (0x140): Work queue parameter
     // Factory test uses: (value + 32 * config[20])
-    // Using basic default based on 114 chips
-    fpga_write_indirect(ctx, FPGA_REG_WORK_QUEUE_PARAM, 0x00003648);
+    // Using basic default from the board profile (0x2808 + 32 * 114 = 0x3648)
+    fpga_write_indirect(ctx, FPGA_REG_WORK_QUEUE_PARAM, WORK_QUEUE_PARAM(chips));
     printf("  Work queue param register (0x140): 0x%08X\n",
            fpga_read_indirect(ctx, FPGA_REG_WORK_QUEUE_PARAM));
 
@@ -251,7 +256,7 @@ int bm1398_init(bm1398_context_t *ctx) {
 
     // Control registers (0x000-0x01C)
     ctx->fpga_regs[REG_FAN_SPEED] = 0x00000500;  // 0x004: Status register
-    ctx->fpga_regs[REG_HASH_ON_PLUG] = 0x00000007;  // 0x008: Control
+    ctx->fpga_regs[REG_HASH_ON_PLUG] = board_profile_chain_mask(ctx->profile);  // 0x008
     ctx->fpga_regs[REG_RETURN_NONCE] = 0x00000004;  // 0x010: Control
     ctx->fpga_regs[0x014 / 4] = 0x5555AAAA;  // 0x014: Test pattern
     ctx->fpga_regs[REG_NONCE_FIFO_INTERRUPT] = 0x00000001;  // 0x01C: Control
@@ -275,6 +280,96 @@ int bm1398_init(bm1398_context_t *ctx) {
     usleep(50000);  // 50ms settle time
 
     printf("FPGA registers initialized (indirect mapping verified)\n");
+    boot_trace_end(trace);
+}
+
+/**
+ * Warm-start check: does the FPGA still hold what configure_fpga() leaves?
+ *
+ * A previous run (or bmminer) that configured the FPGA leaves these values in
+ * place until power is cut. Rewriting them only costs the sleeps.
+ */
+static bool fpga_configured(bm1398_context_t *ctx) {
+    return ctx->fpga_regs[0x080 / 4] == 0x0080800F &&
+           ctx->fpga_regs[0x088 / 4] == 0x8001FFFF &&
+           fpga_read_indirect(ctx, FPGA_REG_SPECIAL_18) == 0x80808000 &&
+           (fpga_read_indirect(ctx, FPGA_REG_CONTROL) & 0x40000000) &&
+           (fpga_read_indirect(ctx, FPGA_REG_WORK_CTRL_ENABLE) & 0x8060) == 0x8060 &&
+           (fpga_read_indirect(ctx, FPGA_REG_TIMEOUT) & WORK_TIMING_TIMEOUT_ENABLE);
+}
+
+/**
+ * Map the FPGA, configure it and detect the chains
+ *
+ * flags: BM1398_INIT_WARM keeps an FPGA that is already configured (sets
+ * ctx->warm_start; the caller then tries bm1398_adopt_chain() before a full
+ * chain init). BM1398_INIT_NO_EEPROM leaves the board EEPROMs to
+ * bm1398_load_eeprom(), so their I2C reads can be scheduled by the caller.
+ * profile: board geometry, NULL for the build default (board_profile.h)
+ */
+int bm1398_init_ex(bm1398_context_t *ctx, uint32_t flags,
+                   const board_profile_t *profile) {
+    if (!ctx) {
+        return -1;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->owner_fd = -1;
+    ctx->profile = profile ? profile : board_profile_find(NULL);
+    if (!ctx->profile) {
+        fprintf(stderr, "Error: No board profile \"%s\"\n", BOARD_PROFILE_DEFAULT);
+        return -1;
+    }
+    printf("Board profile: %s\n", ctx->profile->model);
+    if (!ctx->profile->verified) {
+        fprintf(stderr, "Warning: %s frequency and voltages (%u MHz, %u/%u mV) are not "
+                "checked against stock firmware\n", ctx->profile->model,
+                ctx->profile->freq_mhz, ctx->profile->power_on_mv,
+                ctx->profile->operating_mv);
+    }
+
+    // Only one process may drive the FPGA; others go through its service
+    ctx->owner_fd = fpga_service_claim(program_invocation_short_name);
+    if (ctx->owner_fd < 0) {
+        return -1;
+    }
+
+    // Open FPGA device
+    int fd = open("/dev/axi_fpga_dev", O_RDWR | O_SYNC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open /dev/axi_fpga_dev: %s\n", strerror(errno));
+        fprintf(stderr, "Hint: Ensure bitmain_axi.ko kernel module is loaded\n");
+        fpga_service_release(ctx->owner_fd);
+        return -1;
+    }
+
+    // Memory map FPGA registers
+    ctx->fpga_regs = mmap(NULL, FPGA_REG_SIZE, PROT_READ | PROT_WRITE,
+                          MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ctx->fpga_regs == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap failed: %s\n", strerror(errno));
+        fpga_service_release(ctx->owner_fd);
+        return -1;
+    }
+
+    ctx->initialized = true;
+    ctx->num_chains = 0;
+    ctx->timing_percent = WORK_TIMING_DEFAULT_PERCENT;
+
+    if ((flags & BM1398_INIT_WARM) && fpga_configured(ctx)) {
+        printf("FPGA already configured: skipping mode init (warm start)\n");
+        ctx->warm_start = true;
+    } else {
+        configure_fpga(ctx);
+    }
+
+    // I2C controller is configured above; from here on it is owned by the scheduler
+    if (fpga_i2c_init(&ctx->i2c, ctx->fpga_regs) < 0) {
+        bm1398_cleanup(ctx);
+        return -1;
+    }
 
     // Detect chains
     uint32_t detected = bm1398_detect_chains(ctx);
@@ -283,19 +378,51 @@ int bm1398_init(bm1398_context_t *ctx) {
     for (int i = 0; i < MAX_CHAINS; i++) {
         if (detected & (1 << i)) {
             ctx->num_chains++;
-            ctx->chips_per_chain[i] = CHIPS_PER_CHAIN_S19PRO;
+            ctx->chips_per_chain[i] = ctx->profile->chips_per_chain;
             printf("  Chain %d: %d chips\n", i, ctx->chips_per_chain[i]);
         }
     }
 
+    // Board identity: only the EEPROM fingerprint is read when the cache matches
+    for (int i = 0; i < MAX_CHAINS && !(flags & BM1398_INIT_NO_EEPROM); i++) {
+        if (detected & (1 << i)) {
+            bm1398_load_eeprom(ctx, i);
+        }
+    }
+
     return 0;
 }
 
+int bm1398_init(bm1398_context_t *ctx) {
+    return bm1398_init_ex(ctx, 0, NULL);
+}
+
+/**
+ * As bm1398_init(), but keep an FPGA that is already configured
+ *
+ * For process restarts on a running machine. ctx->warm_start tells the
+ * caller to try bm1398_adopt_chain() before a full chain init.
+ */
+int bm1398_init_warm(bm1398_context_t *ctx) {
+    return bm1398_init_ex(ctx, BM1398_INIT_WARM, NULL);
+}
+
 void bm1398_cleanup(bm1398_context_t *ctx) {
-    if (ctx && ctx->fpga_regs && ctx->fpga_regs != MAP_FAILED) {
+    if (!ctx) {
+        return;
+    }
+
+    fpga_i2c_cleanup(&ctx->i2c);
+    for (int i = 0; i < MAX_CHAINS; i++) {
+        free(ctx->script[i]);
+        ctx->script[i] = NULL;
+    }
+    if (ctx->fpga_regs && ctx->fpga_regs != MAP_FAILED) {
         munmap((void *)ctx->fpga_regs, FPGA_REG_SIZE);
         ctx->fpga_regs = NULL;
     }
+    fpga_service_release(ctx->owner_fd);
+    ctx->owner_fd = -1;
     ctx->initialized = false;
 }
 
@@ -352,9 +479,48 @@ int bm1398_send_uart_cmd(bm1398_context_t *ctx, int chain,
         return -1;
     }
 
+    // Bring-up being recorded: keep every command except readbacks
+    if (ctx->recording[chain] &&
+        cmd[0] != CMD_PREAMBLE_READ_REG && cmd[0] != CMD_PREAMBLE_READ_BCAST) {
+        bm1398_init_script_t *script = ctx->script[chain];
+        if (script->num_steps == BM1398_SCRIPT_MAX_STEPS) {
+            script->overflow = true;
+        } else {
+            bm1398_script_step_t *step = &script->steps[script->num_steps++];
+            step->len = (uint8_t)len;
+            memcpy(step->cmd, cmd, len);
+            step->hold_us = 0;
+        }
+    }
+
     return 0;
 }
 
+/**
+ * Wait between bring-up commands
+ *
+ * hold = true marks a hardware settle (PLL lock, baud switch, core reset).
+ * A recorded script keeps these. Other waits only pace the UART, and replay
+ * drops them.
+ */
+static void chain_settle(bm1398_context_t *ctx, int chain, uint32_t us, bool hold) {
+    const int trace = boot_trace_begin(hold ? "hold" : "pace", chain);
+    usleep(us);
+    boot_trace_end(trace);
+
+    if (hold && ctx->recording[chain]) {
+        bm1398_init_script_t *script = ctx->script[chain];
+        if (script->num_steps == BM1398_SCRIPT_MAX_STEPS) {
+            script->overflow = true;
+            return;
+        }
+        bm1398_script_step_t *step = &script->steps[script->num_steps++];
+        step->len = 0;
+        step->hold_us = us;
+        script->hold_us += us;
+    }
+}
+
 //==============================================================================
 // Chain Control Commands
 //==============================================================================
@@ -404,13 +570,14 @@ int bm1398_enumerate_chips(bm1398_context_t *ctx, int chain, int num_chips) {
     }
 
     printf("Enumerating %d chips on chain %d...\n", num_chips, chain);
+    const int trace = boot_trace_begin("enumerate", chain);
 
     // Send chain inactive first to stop relay
     if (bm1398_chain_inactive(ctx, chain) < 0) {
         fprintf(stderr, "Error: Failed to send chain inactive\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // Calculate address interval
     int interval = 256 / num_chips;
@@ -429,7 +596,7 @@ int bm1398_enumerate_chips(bm1398_context_t *ctx, int chain, int num_chips) {
         }
 
         // Small delay between chips
-        usleep(1000);  // 1ms
+        chain_settle(ctx, chain, 1000, false);  // 1ms
 
         // Progress indication every 10 chips
         if ((i + 1) % 10 == 0) {
@@ -440,6 +607,7 @@ int bm1398_enumerate_chips(bm1398_context_t *ctx, int chain, int num_chips) {
 
     printf("\n  Enumeration complete: %d chips addressed (%d errors)\n",
            num_chips, errors);
+    boot_trace_end(trace);
 
     return errors > 0 ? -1 : 0;
 }
@@ -477,18 +645,12 @@ int bm1398_write_register(bm1398_context_t *ctx, int chain, bool broadcast,
 }
 
 /**
- * Read ASIC register
+ * Send ASIC register read command without waiting for the response
  * Command: [0x42/0x52] 0x09 [chip_addr] [reg_addr] 0x00 0x00 0x00 0x00 [CRC5]
- *
- * Response comes back through FPGA RETURN_NONCE register
- * Response format: [reg_data:32bits] in bits [31:0]
- *
- * Note: This implementation uses polling of NONCE_NUMBER_IN_FIFO
  */
-int bm1398_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
-                         uint8_t chip_addr, uint8_t reg_addr, uint32_t *value,
-                         int timeout_ms) {
-    if (!ctx || !ctx->initialized || !value) {
+int bm1398_send_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
+                               uint8_t chip_addr, uint8_t reg_addr) {
+    if (!ctx || !ctx->initialized) {
         return -1;
     }
 
@@ -504,8 +666,26 @@ int bm1398_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
     cmd[7] = 0x00;
     cmd[8] = bm1398_crc5(cmd, 64);
 
+    return bm1398_send_uart_cmd(ctx, chain, cmd, sizeof(cmd));
+}
+
+/**
+ * Read ASIC register
+ *
+ * Response comes back through FPGA RETURN_NONCE register
+ * Response format: [reg_data:32bits] in bits [31:0]
+ *
+ * Note: This implementation uses polling of NONCE_NUMBER_IN_FIFO
+ */
+int bm1398_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
+                         uint8_t chip_addr, uint8_t reg_addr, uint32_t *value,
+                         int timeout_ms) {
+    if (!ctx || !ctx->initialized || !value) {
+        return -1;
+    }
+
     // Send read command
-    if (bm1398_send_uart_cmd(ctx, chain, cmd, sizeof(cmd)) < 0) {
+    if (bm1398_send_read_register(ctx, chain, broadcast, chip_addr, reg_addr) < 0) {
         return -1;
     }
 
@@ -535,6 +715,56 @@ int bm1398_read_register(bm1398_context_t *ctx, int chain, bool broadcast,
     return -1;
 }
 
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Issue a unicast register read whose response is picked up by the nonce drain
+ *
+ * The response is delivered to ctx->reg_response_cb from bm1398_read_nonces(),
+ * so callers never block on the FIFO while work is being submitted. Only one
+ * read may be outstanding per chain: the FIFO word carries no chip or register
+ * field, so a reply can only be matched to the single read in flight, and
+ * only until timeout_ms has passed.
+ * Returns: 0 on success, -1 on error or if a read is already outstanding
+ */
+int bm1398_read_register_async(bm1398_context_t *ctx, int chain,
+                               uint8_t chip_addr, uint8_t reg_addr,
+                               int timeout_ms) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS ||
+        timeout_ms <= 0) {
+        return -1;
+    }
+
+    bm1398_reg_read_t *rd = &ctx->reg_read[chain];
+    const uint64_t now = monotonic_ms();
+    if (rd->pending && now < rd->deadline_ms) {
+        return -1;
+    }
+
+    if (bm1398_send_read_register(ctx, chain, false, chip_addr, reg_addr) < 0) {
+        rd->pending = false;
+        return -1;
+    }
+    rd->pending = true;
+    rd->chip_addr = chip_addr;
+    rd->reg_addr = reg_addr;
+    rd->deadline_ms = now + (uint64_t)timeout_ms;
+    return 0;
+}
+
+/**
+ * Give up on an outstanding async register read (caller-side timeout)
+ */
+void bm1398_drop_register_read(bm1398_context_t *ctx, int chain) {
+    if (ctx && chain >= 0 && chain < MAX_CHAINS) {
+        ctx->reg_read[chain].pending = false;
+    }
+}
+
 /**
  * Read-modify-write register operation
  *
@@ -591,6 +821,7 @@ int bm1398_read_modify_write_register(bm1398_context_t *ctx, int chain,
  */
 int bm1398_reset_chain_stage1(bm1398_context_t *ctx, int chain) {
     printf("Stage 1: Hardware reset chain %d...\n", chain);
+    const int trace = boot_trace_begin("stage 1 reset", chain);
 
     // Hardware reset sequence verified from Binary Ninja analysis
     // Source: Bitmain single_board_test.c sub_1d07c @ 0x1d07c
@@ -602,32 +833,32 @@ int bm1398_reset_chain_stage1(bm1398_context_t *ctx, int chain) {
     // Step 1: Soft reset disable (register 0x18)
     printf("  Soft reset disable (reg 0x18)...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_CLK_CTRL, 0x00000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, true);   // Reset hold
 
     // Step 2: Clear power control bit (register 0x34)
     printf("  Clear power control bit (reg 0x34)...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_RESET_CTRL, 0x00000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // Step 3: Core reset enable (register 0x18)
     printf("  Core reset enable (reg 0x18)...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_CLK_CTRL, 0x0F400000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, true);   // Reset hold
 
     // Step 4: Core reset disable (register 0x18)
     printf("  Core reset disable (reg 0x18)...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_CLK_CTRL, 0xF0000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, true);   // Reset hold
 
     // Step 5: Soft reset enable (register 0x18)
     printf("  Soft reset enable (reg 0x18)...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_CLK_CTRL, 0xF0000400);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, true);   // Reset hold
 
     // Step 6: Set power control bit (register 0x34)
     printf("  Set power control bit (reg 0x34)...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_RESET_CTRL, 0x00000008);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // Step 7: Set ticket mask to all cores enabled (initialization value)
     printf("  Setting ticket mask to 0xFFFFFFFF...\n");
@@ -636,9 +867,10 @@ int bm1398_reset_chain_stage1(bm1398_context_t *ctx, int chain) {
         fprintf(stderr, "Error: Failed to set ticket mask\n");
         return -1;
     }
-    usleep(50000);  // 50ms settle time
+    chain_settle(ctx, chain, 50000, true);  // 50ms settle time
 
     printf("  Stage 1 complete\n");
+    boot_trace_end(trace);
     return 0;
 }
 
@@ -650,6 +882,7 @@ int bm1398_reset_chain_stage1(bm1398_context_t *ctx, int chain) {
 int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                                   uint8_t diode_vdd_mux_sel) {
     printf("Stage 2: Configure chain %d...\n", chain);
+    const int trace = boot_trace_begin("stage 2 config", chain);
 
     // 1. Set diode mux selector (voltage monitoring)
     printf("  Setting diode_vdd_mux_sel = %d...\n", diode_vdd_mux_sel);
@@ -658,7 +891,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to set diode mux\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 2. Chain inactive
     printf("  Chain inactive...\n");
@@ -666,7 +899,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to send chain inactive\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 3. Set LOW baud rate (115200) for chip enumeration
     // CRITICAL: Chip enumeration MUST happen at low speed!
@@ -675,7 +908,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to set low baud rate\n");
         return -1;
     }
-    usleep(50000);
+    chain_settle(ctx, chain, 50000, true);
 
     // 4. Enumerate chips
     printf("  Enumerating chips...\n");
@@ -684,7 +917,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Chip enumeration failed\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 5. CRITICAL: Register 0x3C reset sequence BEFORE pulse_mode config
     // Source: Binary Ninja sub_2959c @ 0x2959c - MUST DO THIS!
@@ -695,7 +928,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed core reset step 1\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     printf("    Step 2: Write 0x80000600...\n");
     if (bm1398_write_register(ctx, chain, true, 0, ASIC_REG_CORE_CONFIG,
@@ -703,7 +936,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed core reset step 2\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 6. Set core configuration (pulse_mode=1, clk_sel=0)
     uint32_t core_cfg = CORE_CONFIG_BASE | ((1 & 3) << CORE_CONFIG_PULSE_MODE_SHIFT) | (0 & CORE_CONFIG_CLK_SEL_MASK);
@@ -713,7 +946,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to set core config\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 7. Set core timing parameters (pwth_sel=1, ccdly_sel=1, swpf_mode=0)
     // FIXED: ccdly_sel=1 (verified from bmminer log line 441)
@@ -732,7 +965,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to set core timing parameters\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 4c. Set IO driver strength for clock output (clko_ds=1)
     // Register 0x58: Modify bits [7:4] to set clko_ds
@@ -742,25 +975,26 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               io_driver) < 0) {
         fprintf(stderr, "Warning: IO driver configuration failed\n");
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 5. Set PLL dividers to 0
     printf("  Setting PLL dividers...\n");
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_PLL_PARAM_0, 0x00000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_PLL_PARAM_1, 0x00000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_PLL_PARAM_2, 0x00000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
     bm1398_write_register(ctx, chain, true, 0, ASIC_REG_PLL_PARAM_3, 0x00000000);
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 6. Set frequency (525 MHz)
-    printf("  Setting frequency to %d MHz...\n", FREQUENCY_525MHZ);
-    if (bm1398_set_frequency(ctx, chain, FREQUENCY_525MHZ) < 0) {
+    const uint32_t freq_mhz = bm1398_start_freq(ctx, chain);
+    printf("  Setting frequency to %u MHz...\n", freq_mhz);
+    if (bm1398_set_frequency(ctx, chain, freq_mhz) < 0) {
         fprintf(stderr, "Warning: Frequency set failed\n");
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 7. Set HIGH baud rate (12 MHz) AFTER frequency configuration
     // This is phase 2 of two-phase baud rate setup
@@ -769,7 +1003,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to set high baud rate\n");
         return -1;
     }
-    usleep(50000);
+    chain_settle(ctx, chain, 50000, true);
 
     // 7a. Core reset sequence (critical for nonce reception)
     // Use broadcast writes to avoid system hang with 114 chips
@@ -781,7 +1015,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               SOFT_RESET_MASK) < 0) {
         fprintf(stderr, "Warning: Soft reset broadcast failed\n");
     }
-    usleep(100000);  // 100ms settle time
+    chain_settle(ctx, chain, 100000, true);  // 100ms settle time
 
     // Step 1b: Modify CLK_CTRL (register 0x18) - broadcast
     printf("    Broadcast CLK_CTRL (reg 0x18)...\n");
@@ -789,7 +1023,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               0xF0000000) < 0) {
         fprintf(stderr, "Warning: CLK_CTRL broadcast failed\n");
     }
-    usleep(100000);  // 100ms settle time
+    chain_settle(ctx, chain, 100000, true);  // 100ms settle time
 
     // Step 2: Re-configure clock select with clk_sel=0 - broadcast
     uint32_t core_config_reset = CORE_CONFIG_BASE | ((1 & 3) << CORE_CONFIG_PULSE_MODE_SHIFT);
@@ -798,7 +1032,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               core_config_reset) < 0) {
         fprintf(stderr, "Warning: Clock select reset broadcast failed\n");
     }
-    usleep(100000);  // 100ms settle time
+    chain_settle(ctx, chain, 100000, true);  // 100ms settle time
 
     // Step 3: Re-configure timing parameters - broadcast
     printf("    Broadcast timing params...\n");
@@ -806,7 +1040,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               core_param) < 0) {
         fprintf(stderr, "Warning: Timing param reset broadcast failed\n");
     }
-    usleep(100000);  // 100ms settle time
+    chain_settle(ctx, chain, 100000, true);  // 100ms settle time
 
     // Step 4: Core enable (register 0x3C with 0x800082AA) - broadcast
     printf("    Broadcast core enable...\n");
@@ -814,7 +1048,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               CORE_CONFIG_ENABLE) < 0) {
         fprintf(stderr, "Warning: Core enable broadcast failed\n");
     }
-    usleep(100000);  // 100ms settle time
+    chain_settle(ctx, chain, 100000, true);  // 100ms settle time
 
     printf("  Core reset sequence complete\n");
 
@@ -822,19 +1056,16 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
     // Factory test and bmminer both have significant delays here
     // ASICs need time to stabilize after reset before accepting work
     printf("  Waiting 2 seconds for core stabilization...\n");
-    sleep(2);
+    chain_settle(ctx, chain, 2000000, true);
 
-    // 7b. Configure FPGA nonce timeout based on chip frequency
+    // 7b. Configure FPGA nonce timeout and hash counting number
     // Factory test: dhash_set_timeout() at sub_222f8
-    // Writes to logical FPGA index 20 → physical offset 0x08C
-    // Formula: timeout_value = (calculated_timeout & 0x1FFFF) | 0x80000000
-    printf("  Configuring FPGA nonce timeout for %d MHz...\n", FREQUENCY_525MHZ);
-    uint32_t timeout_calc = 0x1FFFF / FREQUENCY_525MHZ;  // Formula: 0x1FFFF / freq_mhz
-    uint32_t timeout_reg = (timeout_calc & 0x1FFFF) | 0x80000000;
-    fpga_write_indirect(ctx, FPGA_REG_TIMEOUT, timeout_reg);
-    printf("    FPGA timeout = %u cycles (register value: 0x%08X at offset 0x08C)\n",
-           timeout_calc, timeout_reg);
-    usleep(10000);
+    // Core reset above may have cleared HASH_COUNTING, so reapply everything
+    printf("  Configuring work timing...\n");
+    if (bm1398_update_work_timing(ctx, chain) < 0) {
+        fprintf(stderr, "Warning: Work timing configuration failed\n");
+    }
+    chain_settle(ctx, chain, 10000, false);
 
     // 8. Set final ticket mask
     printf("  Setting final ticket mask = 0xFF...\n");
@@ -843,7 +1074,7 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
         fprintf(stderr, "Error: Failed to set final ticket mask\n");
         return -1;
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     // 9. Set nonce overflow control (disable overflow)
     // Register 0x3C: Final configuration with nonce overflow disabled
@@ -852,9 +1083,10 @@ int bm1398_configure_chain_stage2(bm1398_context_t *ctx, int chain,
                               CORE_CONFIG_NONCE_OVF_DIS) < 0) {
         fprintf(stderr, "Warning: Nonce overflow control failed\n");
     }
-    usleep(10000);
+    chain_settle(ctx, chain, 10000, false);
 
     printf("  Stage 2 complete\n");
+    boot_trace_end(trace);
     return 0;
 }
 
@@ -870,16 +1102,49 @@ int bm1398_init_chain(bm1398_context_t *ctx, int chain) {
     printf("Initializing Chain %d\n", chain);
     printf("====================================\n\n");
 
+    // Record the command stream for bm1398_replay_chain()
+    if (!ctx->script[chain]) {
+        ctx->script[chain] = malloc(sizeof(bm1398_init_script_t));
+    }
+    if (ctx->script[chain]) {
+        ctx->script[chain]->num_steps = 0;
+        ctx->script[chain]->overflow = false;
+        ctx->script[chain]->hold_us = 0;
+        ctx->recording[chain] = true;
+    }
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    const int trace = boot_trace_begin("chain init", chain);
+
     // Stage 1: Hardware reset
-    if (bm1398_reset_chain_stage1(ctx, chain) < 0) {
+    int ret = bm1398_reset_chain_stage1(ctx, chain);
+    if (ret < 0) {
         fprintf(stderr, "Error: Stage 1 failed\n");
-        return -1;
+    } else {
+        // Stage 2: Configuration (diode_vdd_mux_sel = 3 from Config.ini)
+        ret = bm1398_configure_chain_stage2(ctx, chain, 3);
+        if (ret < 0) {
+            fprintf(stderr, "Error: Stage 2 failed\n");
+        }
     }
 
-    // Stage 2: Configuration (diode_vdd_mux_sel = 3 from Config.ini)
-    if (bm1398_configure_chain_stage2(ctx, chain, 3) < 0) {
-        fprintf(stderr, "Error: Stage 2 failed\n");
-        return -1;
+    ctx->recording[chain] = false;
+    boot_trace_end(trace);
+    if (ret < 0 || !ctx->script[chain] || ctx->script[chain]->overflow) {
+        free(ctx->script[chain]);
+        ctx->script[chain] = NULL;
+        if (ret < 0) {
+            return -1;
+        }
+    } else {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        bm1398_init_script_t *script = ctx->script[chain];
+        script->freq_mhz = ctx->freq_mhz[chain];
+        script->record_ms = (uint32_t)((t1.tv_sec - t0.tv_sec) * 1000 +
+                                       (t1.tv_nsec - t0.tv_nsec) / 1000000);
+        printf("Recorded chain %d bring-up: %d steps, %u ms (%llu ms of hardware settles)\n",
+               chain, script->num_steps, script->record_ms,
+               (unsigned long long)(script->hold_us / 1000));
     }
 
     printf("\n====================================\n");
@@ -889,6 +1154,169 @@ int bm1398_init_chain(bm1398_context_t *ctx, int chain) {
     return 0;
 }
 
+/**
+ * Re-initialize a chain by replaying its recorded bring-up
+ *
+ * Sends the command stream of the last successful bm1398_init_chain() back
+ * to back, paced only by the FPGA command buffer. The recorded hardware
+ * settles (PLL lock, baud switches, core reset, stabilization) are kept,
+ * scaled by hold_percent. Readbacks, logging and pure UART pacing are
+ * skipped. Nothing is verified here: the caller watches the chain hash.
+ * Returns: 0 on success, -1 on error or if no script has been recorded
+ */
+int bm1398_replay_chain(bm1398_context_t *ctx, int chain, int hold_percent) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS ||
+        !ctx->script[chain] || hold_percent <= 0) {
+        return -1;
+    }
+
+    const bm1398_init_script_t *script = ctx->script[chain];
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (int i = 0; i < script->num_steps; i++) {
+        const bm1398_script_step_t *step = &script->steps[i];
+        if (step->len == 0) {
+            usleep((useconds_t)((uint64_t)step->hold_us * hold_percent / 100));
+            continue;
+        }
+        if (bm1398_send_uart_cmd(ctx, chain, step->cmd, step->len) < 0) {
+            fprintf(stderr, "Error: Chain %d replay failed at step %d\n", chain, i);
+            return -1;
+        }
+        usleep(BM1398_REPLAY_PACE_US);
+    }
+
+    // FPGA side is not part of the stream: retime for the replayed PLL
+    ctx->freq_mhz[chain] = script->freq_mhz;
+    bm1398_update_work_timing(ctx, chain);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("Chain %d re-initialized from script in %ld ms (recorded bring-up %u ms)\n",
+           chain, (long)((t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000),
+           script->record_ms);
+    return 0;
+}
+
+/**
+ * Discard everything in the nonce FIFO (stale nonces from a previous run)
+ */
+static void drain_fifo(bm1398_context_t *ctx) {
+    for (int i = 0; i < 4096 && ctx->fpga_regs[REG_NONCE_NUMBER_IN_FIFO] > 0; i++) {
+        (void)ctx->fpga_regs[REG_RETURN_NONCE];
+    }
+}
+
+/**
+ * Take over a chain a previous run left configured (warm start)
+ *
+ * The first and last chip must answer unicast reads at the running (12 MHz)
+ * baud, and their PLL0 must agree and decode to a valid frequency. A chain
+ * that was power-cycled or never initialized fails this check, because its
+ * chips have no addresses and run at the default baud. CLK_CTRL is not
+ * checked: the stage 2 core reset broadcasts 0xF0000000 after the baud
+ * switch, so its high-speed bit is clear on a configured chain too. On
+ * success the chain is used at the frequency read back, with no reset, so
+ * work can be fed at once.
+ * Returns: 0 if adopted, -1 if the chain needs bm1398_init_chain()
+ */
+int bm1398_adopt_chain(bm1398_context_t *ctx, int chain) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS ||
+        ctx->chips_per_chain[chain] <= 0) {
+        return -1;
+    }
+
+    const int trace = boot_trace_begin("chain adopt", chain);
+
+    // Chips finish their last work within a sweep; drop what they return
+    drain_fifo(ctx);
+    usleep(10000);
+    drain_fifo(ctx);
+
+    const int chips = ctx->chips_per_chain[chain];
+    const uint8_t last = (uint8_t)((chips - 1) * work_timing_interval(chips));
+    uint32_t pll0, pll0_first;
+    if (bm1398_read_register(ctx, chain, false, 0, ASIC_REG_PLL_PARAM_0, &pll0_first, 20) < 0 ||
+        bm1398_read_register(ctx, chain, false, last, ASIC_REG_PLL_PARAM_0, &pll0, 20) < 0) {
+        boot_trace_end(trace);
+        return -1;
+    }
+
+    // Inverse of bm1398_pll_value()
+    const uint32_t fbdiv = (pll0 >> 16) & 0xfff;
+    const uint32_t freq = PLL_CLKI_MHZ * fbdiv / PLL_CORE_DIV;
+    if ((pll0 & ~(0xfffu << 16) & ~PLL0_VCO_HIGH_RANGE) != PLL0_FIXED_DIVIDERS ||
+        freq < FREQUENCY_MIN_MHZ || freq > FREQUENCY_MAX_MHZ || pll0_first != pll0) {
+        printf("Chain %d not configured (PLL0 0x%08X / 0x%08X): full init\n",
+               chain, pll0_first, pll0);
+        boot_trace_end(trace);
+        return -1;
+    }
+
+    ctx->freq_mhz[chain] = freq;
+    const int ret = bm1398_update_work_timing(ctx, chain);
+    boot_trace_end(trace);
+    if (ret < 0) {
+        return -1;
+    }
+    printf("Chain %d already configured at %u MHz: adopted (warm start)\n", chain, freq);
+    return 0;
+}
+
+/**
+ * Recover one wedged chip without touching the rest of the chain
+ *
+ * Unicast replay of the stage 2 core reset (soft reset, CLK_CTRL, core
+ * config/param, core enable), then the chain's PLL, hash counting number,
+ * ticket mask and nonce overflow setting. A soft reset keeps the chip's UART address, so the other
+ * chips and their addresses are untouched. Settle times are per chip, so
+ * they are much shorter than the broadcast ones. The caller verifies the chip
+ * with known-answer work (kat_inject_verify_chip()).
+ */
+int bm1398_reset_chip(bm1398_context_t *ctx, int chain, uint8_t chip_addr) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS ||
+        ctx->freq_mhz[chain] == 0) {
+        return -1;
+    }
+
+    const uint32_t pll_value = bm1398_pll_value(ctx->freq_mhz[chain], NULL);
+
+    // Same hcn as bm1398_update_work_timing(): the core reset may clear it
+    const int chips = ctx->chips_per_chain[chain];
+    work_timing_t t;
+    if (work_timing_calc(&t, ctx->freq_mhz[chain], chips, work_timing_interval(chips),
+                         ctx->timing_percent) < 0) {
+        return -1;
+    }
+
+    const uint32_t core_param = (1 << CORE_PARAM_PWTH_SEL_SHIFT) |   // pwth_sel=1
+                                (1 << CORE_PARAM_CCDLY_SEL_SHIFT);   // ccdly_sel=1
+    const struct {
+        uint8_t reg;
+        uint32_t value;
+    } seq[] = {
+        { ASIC_REG_SOFT_RESET,  SOFT_RESET_MASK },
+        { ASIC_REG_CLK_CTRL,    0xF0000000 },
+        { ASIC_REG_CORE_CONFIG, CORE_CONFIG_BASE | (1 << CORE_CONFIG_PULSE_MODE_SHIFT) },
+        { ASIC_REG_CORE_PARAM,  core_param },
+        { ASIC_REG_CORE_CONFIG, CORE_CONFIG_ENABLE },
+        { ASIC_REG_PLL_PARAM_0, pll_value },
+        { ASIC_REG_HASH_COUNTING, t.hcn },
+        { ASIC_REG_TICKET_MASK, TICKET_MASK_256_CORES },
+        { ASIC_REG_CORE_CONFIG, CORE_CONFIG_NONCE_OVF_DIS },
+    };
+
+    for (size_t i = 0; i < sizeof(seq) / sizeof(seq[0]); i++) {
+        if (bm1398_write_register(ctx, chain, false, chip_addr, seq[i].reg, seq[i].value) < 0) {
+            fprintf(stderr, "Error: Chain %d chip 0x%02X reset failed at reg 0x%02X\n",
+                    chain, chip_addr, seq[i].reg);
+            return -1;
+        }
+        usleep(CHIP_RESET_SETTLE_US);
+    }
+    return 0;
+}
+
 //==============================================================================
 // Baud Rate and Frequency Configuration
 //==============================================================================
@@ -906,6 +1334,7 @@ int bm1398_set_baud_rate(bm1398_context_t *ctx, int chain, uint32_t baud_rate) {
         return -1;
     }
 
+    const int trace = boot_trace_begin("baud switch", chain);
     uint32_t baud_div;
     uint32_t reg_val;
 
@@ -931,13 +1360,13 @@ int bm1398_set_baud_rate(bm1398_context_t *ctx, int chain, uint32_t baud_rate) {
             // Fallback to known good value if read fails
             bm1398_write_register(ctx, chain, true, 0, ASIC_REG_PLL_PARAM_3, 0xC0700111);
         }
-        usleep(10000);
+        chain_settle(ctx, chain, 10000, true);   // UART PLL lock
 
         // Step 2: Configure BAUD_CONFIG register (0x28) - Write known-good value
         printf("    Configuring BAUD_CONFIG (reg 0x28) for high-speed mode...\n");
         // CRITICAL FIX: Don't use read-modify-write, use known-good value
         bm1398_write_register(ctx, chain, true, 0, ASIC_REG_BAUD_CONFIG, 0x06008F0F);
-        usleep(10000);
+        chain_settle(ctx, chain, 10000, false);
 
         // Step 3: Configure CLK_CTRL register (0x18) with divisor + high-speed bit
         printf("    Writing CLK_CTRL (reg 0x18) with divisor and high-speed bit...\n");
@@ -982,124 +1411,228 @@ int bm1398_set_baud_rate(bm1398_context_t *ctx, int chain, uint32_t baud_rate) {
         }
     }
 
-    usleep(50000);  // 50ms settle time for baud rate change
+    chain_settle(ctx, chain, 50000, true);  // 50ms settle time for baud rate change
     printf("    Baud rate %u Hz configuration complete\n", baud_rate);
+    boot_trace_end(trace);
     return 0;
 }
 
 /**
- * Set ASIC core frequency
+ * PLL0 register value for a core frequency
  *
- * Note: PLL configuration formula needs to be extracted from cgminer or bmminer.
- * This is a placeholder implementation.
+ * Encoding (Binary Ninja sub_29558): bits [27:16] fbdiv, [13:8] postdiv1-1,
+ * [6:4] refdiv-1, [2:0] postdiv2-1, bit 28 high VCO range. bmminer writes
+ * 0x40540100 for 525 MHz: VCO = 25 MHz * 84 = 2100 MHz and the core runs at
+ * VCO / 4. Only fbdiv is varied, giving 6.25 MHz steps across the VCO's
+ * 1600-3200 MHz range.
+ * fbdiv is rounded to the nearest step.
+ * Returns: register value (0 if out of range); *actual_mhz = that step's
+ *          frequency, truncated to whole MHz
  */
-int bm1398_set_frequency(bm1398_context_t *ctx, int chain, uint32_t freq_mhz) {
-    if (!ctx || !ctx->initialized) {
-        return -1;
+uint32_t bm1398_pll_value(uint32_t freq_mhz, uint32_t *actual_mhz) {
+    const uint32_t fbdiv = (freq_mhz * PLL_CORE_DIV + PLL_CLKI_MHZ / 2) / PLL_CLKI_MHZ;
+    const uint32_t vco = PLL_CLKI_MHZ * fbdiv;
+    if (vco < PLL_VCO_MIN_MHZ || vco > PLL_VCO_MAX_MHZ) {
+        return 0;
     }
 
-    printf("    Setting frequency to %u MHz...\n", freq_mhz);
+    uint32_t value = PLL0_FIXED_DIVIDERS | ((fbdiv & 0xfff) << 16);
+    if (vco >= PLL_VCO_HIGH_MHZ) {
+        value |= PLL0_VCO_HIGH_RANGE;
+    }
+    if (actual_mhz) {
+        *actual_mhz = vco / PLL_CORE_DIV;
+    }
+    return value;
+}
 
-    // PLL configuration for BM1398
-    // Formula: freq = CLKI * fbdiv / (refdiv * postdiv1 * postdiv2)
-    // Where CLKI = 25 MHz
-    // VCO = CLKI / refdiv * fbdiv (must be 1600-3200 MHz)
+/**
+ * Bring-up frequency for a chain: the board EEPROM's default when it holds
+ * one the PLL can make, otherwise the board profile's
+ */
+uint32_t bm1398_start_freq(const bm1398_context_t *ctx, int chain) {
+    const eeprom_info_t *e = &ctx->eeprom[chain];
+    if (e->valid && e->default_freq >= FREQUENCY_MIN_MHZ &&
+        e->default_freq <= FREQUENCY_MAX_MHZ) {
+        return e->default_freq;
+    }
+    return ctx->profile->freq_mhz;
+}
 
-    uint8_t refdiv, postdiv1, postdiv2;
-    uint16_t fbdiv;
+/**
+ * Set ASIC core frequency (broadcast to the chain)
+ */
+int bm1398_set_frequency(bm1398_context_t *ctx, int chain, uint32_t freq_mhz) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS) {
+        return -1;
+    }
 
-    // For 525 MHz (standard BM1398 frequency):
-    // Register encoding verified from Binary Ninja sub_29558 @ 0x29558:
-    // Bits [2:0] = postdiv2 (value-1 encoding)
-    // Bits [6:4] = refdiv (value-1 encoding)
-    // Bits [13:8] = postdiv1 (value-1 encoding)
-    // Bits [27:16] = fbdiv (direct value)
-    //
-    // Formula: freq = CLKI * fbdiv / (refdiv * (postdiv1+1) * (postdiv2+1))
-    // Where CLKI = 25 MHz
-    //
-    // For 525 MHz with register value 0x40540100:
-    // - fbdiv = 84 (bits [27:16] = 0x054)
-    // - postdiv1 = 1 (bits [13:8] = 0x01, actual divisor = 1+1 = 2)
-    // - refdiv = 0 (bits [6:4] = 0x0, actual divisor = 0+1 = 1)
-    // - postdiv2 = 0 (bits [2:0] = 0x0, actual divisor = 0+1 = 1)
-    //
-    // VCO = 25 * 84 / 1 = 2100 MHz
-    // freq = 2100 / (2 * 1) = 1050 MHz... WAIT, this doesn't match!
-    //
-    // Let me recalculate based on actual divisor values:
-    // If stored value is value-1, then:
-    // - refdiv_actual = 0+1 = 1
-    // - postdiv1_actual = 1+1 = 2
-    // - postdiv2_actual = 0+1 = 1
-    //
-    // But 2100/(1*2*1) = 1050, not 525!
-    //
-    // Maybe both postdiv contribute to divisor differently?
-    // Or maybe the formula is: freq = VCO / (postdiv1 * postdiv2)
-    // where VCO = CLKI / refdiv * fbdiv
-    //
-    // Let's use the values that work empirically from the doc:
-    uint8_t refdiv_reg, postdiv1_reg, postdiv2_reg;
-    uint16_t fbdiv_reg;
-
-    if (freq_mhz == 525) {
-        refdiv_reg = 0;    // Stored value (actual = 1)
-        fbdiv_reg = 84;    // Direct value
-        postdiv1_reg = 1;  // Stored value (actual = 2)
-        postdiv2_reg = 0;  // Stored value (actual = 1)
-    } else {
-        fprintf(stderr, "    Warning: Frequency %u MHz not supported, using 525 MHz\n", freq_mhz);
-        refdiv_reg = 0;
-        fbdiv_reg = 84;
-        postdiv1_reg = 1;
-        postdiv2_reg = 0;
-    }
-
-    // Calculate VCO frequency for range check (using actual divisor values)
-    uint8_t refdiv_actual = refdiv_reg + 1;
-    uint8_t postdiv1_actual = postdiv1_reg + 1;
-    uint8_t postdiv2_actual = postdiv2_reg + 1;
-    float vco = 25.0f / refdiv_actual * fbdiv_reg;
-    float freq_actual = vco / (postdiv1_actual * postdiv2_actual);
-
-    printf("    PLL config: refdiv=%u (reg=0x%X), fbdiv=%u, postdiv1=%u (reg=0x%X), postdiv2=%u (reg=0x%X)\n",
-           refdiv_actual, refdiv_reg, fbdiv_reg, postdiv1_actual, postdiv1_reg, postdiv2_actual, postdiv2_reg);
-    printf("    VCO=%.0f MHz, calculated freq=%.0f MHz\n", vco, freq_actual);
-
-    // Build PLL register value (verified encoding from Binary Ninja sub_29558)
-    // Bits [2:0] = postdiv2 & 7
-    // Bits [6:4] = refdiv & 7
-    // Bits [13:8] = postdiv1 & 0x3f
-    // Bits [27:16] = fbdiv & 0xfff
-    uint32_t pll_value = 0x40000000 |
-                         (postdiv2_reg & 0x7) |
-                         ((refdiv_reg & 0x7) << 4) |
-                         ((postdiv1_reg & 0x3f) << 8) |
-                         ((fbdiv_reg & 0xfff) << 16);
-
-    // Set VCO range bit based on VCO frequency
-    if (vco >= 2400.0f && vco <= 3200.0f) {
-        pll_value |= 0x10000000;  // High VCO range (bit 28)
-    } else if (vco < 1600.0f || vco > 3200.0f) {
-        fprintf(stderr, "    Error: VCO %.0f MHz out of range (1600-3200 MHz)\n", vco);
-        return -1;
-    }
-
-    printf("    Writing PLL0 register 0x08 = 0x%08X (expected 0x40540100)\n", pll_value);
-
-    // Write PLL0 parameter to register 0x08 (broadcast to all chips)
-    if (bm1398_write_register(ctx, chain, true, 0, 0x08, pll_value) < 0) {
+    uint32_t actual_mhz;
+    const uint32_t pll_value = bm1398_pll_value(freq_mhz, &actual_mhz);
+    if (pll_value == 0) {
+        fprintf(stderr, "    Error: Frequency %u MHz outside PLL range (%u-%u MHz)\n",
+                freq_mhz, FREQUENCY_MIN_MHZ, FREQUENCY_MAX_MHZ);
+        return -1;
+    }
+
+    printf("    Setting frequency to %u MHz (PLL0 register 0x08 = 0x%08X)...\n",
+           actual_mhz, pll_value);
+    const int trace = boot_trace_begin("set frequency", chain);
+
+    if (bm1398_write_register(ctx, chain, true, 0, ASIC_REG_PLL_PARAM_0, pll_value) < 0) {
         fprintf(stderr, "    Error: Failed to write PLL0 register\n");
         return -1;
     }
 
-    usleep(10000);  // Wait for PLL to stabilize
-    printf("    Frequency configuration complete\n");
+    chain_settle(ctx, chain, 10000, true);  // Wait for PLL to stabilize
+
+    // Nonce sweep time changed: keep timeout/hcn in step with the PLL
+    ctx->freq_mhz[chain] = actual_mhz;
+    bm1398_update_work_timing(ctx, chain);
+    boot_trace_end(trace);
+
+    return 0;
+}
+
+//==============================================================================
+// Work Timing
+//==============================================================================
+
+/**
+ * Global FPGA side: fastest frequency, longest chain across active chains
+ * Returns: 0 on success (or with no active chain), -1 on error
+ */
+static int update_global_timing(bm1398_context_t *ctx) {
+    uint32_t fastest = 0;
+    int longest = 0;
+    for (int i = 0; i < MAX_CHAINS; i++) {
+        if (ctx->freq_mhz[i] == 0 || ctx->chips_per_chain[i] <= 0) {
+            continue;
+        }
+        if (ctx->freq_mhz[i] > fastest) fastest = ctx->freq_mhz[i];
+        if (ctx->chips_per_chain[i] > longest) longest = ctx->chips_per_chain[i];
+    }
+    if (fastest == 0) {
+        return 0;   // No chain left to time
+    }
+
+    work_timing_t g;
+    if (work_timing_calc(&g, fastest, longest, work_timing_interval(longest),
+                         ctx->timing_percent) < 0) {
+        return -1;
+    }
+
+    if (g.timeout != ctx->timing.timeout) {
+        fpga_write_indirect(ctx, FPGA_REG_TIMEOUT,
+                            (g.timeout & WORK_TIMING_TIMEOUT_MASK) | WORK_TIMING_TIMEOUT_ENABLE);
+    }
+    if (g.chain_work_config != ctx->timing.chain_work_config) {
+        fpga_write_indirect(ctx, FPGA_REG_CHAIN_WORK_CONFIG, g.chain_work_config);
+    }
+    if (g.work_queue_param != ctx->timing.work_queue_param) {
+        fpga_write_indirect(ctx, FPGA_REG_WORK_QUEUE_PARAM, g.work_queue_param);
+    }
+    ctx->timing = g;
+
+    printf("    FPGA timeout = %u (0x%08X), chain work config = 0x%08X, work queue param = 0x%08X\n",
+           g.timeout, fpga_read_indirect(ctx, FPGA_REG_TIMEOUT),
+           g.chain_work_config, g.work_queue_param);
+    return 0;
+}
+
+/**
+ * Reprogram frequency/chain-length dependent work parameters
+ *
+ * Per chain: ASIC HASH_COUNTING (hcn), broadcast to the chain.
+ * Global FPGA registers (timeout, chain work config, work queue param) are
+ * shared by all chains, so they follow the fastest active chain (shortest
+ * sweep, so no chain idles on finished work) and the longest chain.
+ *
+ * Source: bmminer log "freq = 525, percent = 90, hcn = 12480, timeout = 449"
+ */
+int bm1398_update_work_timing(bm1398_context_t *ctx, int chain) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS) {
+        return -1;
+    }
+
+    const int chips = ctx->chips_per_chain[chain];
+    if (ctx->freq_mhz[chain] == 0 || chips <= 0) {
+        return 0;   // Nothing to derive yet
+    }
+
+    work_timing_t t;
+    if (work_timing_calc(&t, ctx->freq_mhz[chain], chips,
+                         work_timing_interval(chips), ctx->timing_percent) < 0) {
+        return -1;
+    }
+
+    printf("    Chain %d: freq = %u, percent = %d, hcn = %u, timeout = %u\n",
+           chain, t.freq_mhz, t.percent, t.hcn, t.timeout);
+    if (bm1398_write_register(ctx, chain, true, 0, ASIC_REG_HASH_COUNTING, t.hcn) < 0) {
+        fprintf(stderr, "Error: Failed to write hash counting number\n");
+        return -1;
+    }
+
+    return update_global_timing(ctx);
+}
+
+/**
+ * Add a chain found after bm1398_init() (hot-plugged board)
+ *
+ * Takes the chain into the context with the default chip count and loads
+ * its EEPROM. The chain still needs DC-DC enable and bm1398_init_chain().
+ */
+int bm1398_attach_chain(bm1398_context_t *ctx, int chain) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS) {
+        return -1;
+    }
 
+    if (ctx->chips_per_chain[chain] == 0) {
+        ctx->num_chains++;
+    }
+    ctx->chips_per_chain[chain] = ctx->profile->chips_per_chain;
+    ctx->freq_mhz[chain] = 0;
+    ctx->reg_read[chain].pending = false;
+    memset(&ctx->eeprom[chain], 0, sizeof(ctx->eeprom[chain]));
+    bm1398_load_eeprom(ctx, chain);
     return 0;
 }
 
+/**
+ * Retire a chain whose board was removed or failed bring-up
+ *
+ * Forgets outstanding register reads and retimes the shared FPGA work
+ * parameters for the chains that remain. Nothing is sent to the chain.
+ */
+void bm1398_detach_chain(bm1398_context_t *ctx, int chain) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+
+    if (ctx->chips_per_chain[chain] > 0) {
+        ctx->num_chains--;
+    }
+    ctx->chips_per_chain[chain] = 0;
+    ctx->freq_mhz[chain] = 0;
+    ctx->reg_read[chain].pending = false;
+    free(ctx->script[chain]);       // The next board records its own
+    ctx->script[chain] = NULL;
+    update_global_timing(ctx);
+}
+
+/**
+ * Change the chip count of a chain (e.g. chips lost or board swapped)
+ * and reprogram the dependent work parameters
+ */
+int bm1398_set_chip_count(bm1398_context_t *ctx, int chain, int num_chips) {
+    if (!ctx || !ctx->initialized || chain < 0 || chain >= MAX_CHAINS || num_chips < 0) {
+        return -1;
+    }
+
+    ctx->chips_per_chain[chain] = num_chips;
+    return bm1398_update_work_timing(ctx, chain);
+}
+
 //==============================================================================
 // Utility Functions
 //==============================================================================
@@ -1113,7 +1646,7 @@ uint32_t bm1398_detect_chains(bm1398_context_t *ctx) {
         return 0;
     }
 
-    return ctx->fpga_regs[REG_HASH_ON_PLUG];
+    return ctx->fpga_regs[REG_HASH_ON_PLUG] & board_profile_chain_mask(ctx->profile);
 }
 
 /**
@@ -1189,6 +1722,47 @@ int bm1398_check_work_fifo_ready(bm1398_context_t *ctx) {
     return ctx->fpga_regs[REG_BUFFER_SPACE];
 }
 
+/**
+ * Wait for FPGA work FIFO space before sending
+ * Factory test checks buffer space to avoid overwhelming FPGA
+ */
+static int wait_work_fifo(bm1398_context_t *ctx, int chain) {
+    int timeout = 1000;  // 1 second max wait
+    while (bm1398_check_work_fifo_ready(ctx) < 1 && timeout > 0) {
+        usleep(1000);  // 1ms
+        timeout--;
+    }
+    if (timeout == 0) {
+        fprintf(stderr, "Error: Work FIFO timeout on chain %d\n", chain);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Write work packet to FPGA using INDIRECT MAPPING (FIFO-style)
+ *
+ * CRITICAL: Matches factory test sub_22B10 @ line 19430
+ * First word: logical index 16 (FPGA_REG_TW_WRITE_CMD_FIRST)
+ * Rest: logical index 17 (FPGA_REG_TW_WRITE_CMD_REST)
+ * Both map to same physical register 0x040!
+ *
+ * Factory test code:
+ *   fpga_write(16, words[0]);
+ *   for (i = 1; i < num_words; i++) {
+ *       fpga_write(17, words[i]);  // Note: index 17, not 16+i!
+ *   }
+ */
+static void write_tw_packet(bm1398_context_t *ctx, const uint32_t *words, int num_words) {
+    // First word to index 16
+    fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_FIRST, words[0]);
+
+    // Remaining words to index 17 (FIFO writes to same physical register)
+    for (int i = 1; i < num_words; i++) {
+        fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_REST, words[i]);
+    }
+}
+
 /**
  * Send work to ASIC chain via FPGA
  *
@@ -1207,15 +1781,7 @@ int bm1398_send_work(bm1398_context_t *ctx, int chain, uint32_t work_id,
         return -1;
     }
 
-    // CRITICAL: Wait for FPGA work FIFO space before sending
-    // Factory test checks buffer space to avoid overwhelming FPGA
-    int timeout = 1000;  // 1 second max wait
-    while (bm1398_check_work_fifo_ready(ctx) < 1 && timeout > 0) {
-        usleep(1000);  // 1ms
-        timeout--;
-    }
-    if (timeout == 0) {
-        fprintf(stderr, "Error: Work FIFO timeout on chain %d\n", chain);
+    if (wait_work_fifo(ctx, chain) < 0) {
         return -1;
     }
 
@@ -1232,7 +1798,7 @@ int bm1398_send_work(bm1398_context_t *ctx, int chain, uint32_t work_id,
     // Will be byte-swapped later with all other fields
     // CRITICAL FIX: Don't pre-swap work_id, let the global swap handle it
     // Factory test: work_id << 3, then whole packet byte-swapped
-    work.work_id = work_id << 3;
+    work.work_id = work_id << WORK_ID_SHIFT;
 
     // Copy last 12 bytes of block header
     memcpy(work.work_data, work_data_12bytes, 12);
@@ -1250,28 +1816,51 @@ int bm1398_send_work(bm1398_context_t *ctx, int chain, uint32_t work_id,
         words[i] = __builtin_bswap32(words[i]);
     }
 
-    // Write work packet to FPGA using INDIRECT MAPPING (FIFO-style)
-    // CRITICAL: Matches factory test sub_22B10 @ line 19430
-    // First word: logical index 16 (FPGA_REG_TW_WRITE_CMD_FIRST)
-    // Rest: logical index 17 (FPGA_REG_TW_WRITE_CMD_REST)
-    // Both map to same physical register 0x040!
-    //
-    // Factory test code:
-    //   fpga_write(16, words[0]);
-    //   for (i = 1; i < num_words; i++) {
-    //       fpga_write(17, words[i]);  // Note: index 17, not 16+i!
-    //   }
+    write_tw_packet(ctx, words, sizeof(work) / 4);  // 148 bytes / 4 = 37 words
+    ctx->works_sent[chain]++;
+    return 0;
+}
 
-    int num_words = sizeof(work) / 4;  // 148 bytes / 4 = 37 words
+/**
+ * Send work whose fields are already in FPGA (big-endian word) order
+ *
+ * Same packet as bm1398_send_work(), but nothing is copied or swapped: the
+ * header words are built here and the payload words go straight from the
+ * caller's buffers (e.g. a mapped pattern bundle) to the TW FIFO.
+ */
+int bm1398_send_work_swapped(bm1398_context_t *ctx, int chain, uint32_t work_id,
+                             const uint32_t work_data_be[3],
+                             const uint32_t *const midstates_be[4]) {
+    if (!ctx || !ctx->initialized || !work_data_be || !midstates_be) {
+        return -1;
+    }
 
-    // First word to index 16
-    fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_FIRST, words[0]);
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        fprintf(stderr, "Error: Invalid chain %d\n", chain);
+        return -1;
+    }
 
-    // Remaining words to index 17 (FIFO writes to same physical register)
-    for (int i = 1; i < num_words; i++) {
-        fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_REST, words[i]);
+    if (wait_work_fifo(ctx, chain) < 0) {
+        return -1;
+    }
+
+    // Header words exactly as the swapped work_packet_t: 0x01, chain | 0x80,
+    // 0x00, 0x00, then work_id << 3 byte-swapped with the rest
+    fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_FIRST,
+                        (0x01u << 24) | ((uint32_t)(chain | 0x80) << 16));
+    fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_REST,
+                        __builtin_bswap32(work_id << WORK_ID_SHIFT));
+
+    for (int i = 0; i < 3; i++) {
+        fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_REST, work_data_be[i]);
+    }
+    for (int m = 0; m < 4; m++) {
+        for (int i = 0; i < 8; i++) {
+            fpga_write_indirect(ctx, FPGA_REG_TW_WRITE_CMD_REST, midstates_be[m][i]);
+        }
     }
 
+    ctx->works_sent[chain]++;
     return 0;
 }
 
@@ -1341,10 +1930,40 @@ int bm1398_read_nonces(bm1398_context_t *ctx, nonce_response_t *nonces,
     int count = available < max_count ? available : max_count;
     int read_count = 0;
 
+    // Reads past their deadline no longer claim FIFO words
+    const uint64_t now = monotonic_ms();
+    bool reads_pending = false;
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (ctx->reg_read[chain].pending && now >= ctx->reg_read[chain].deadline_ms) {
+            ctx->reg_read[chain].pending = false;
+        }
+        reads_pending |= ctx->reg_read[chain].pending;
+    }
+
     for (int i = 0; i < count; i++) {
-        if (bm1398_read_nonce(ctx, &nonces[read_count]) > 0) {
-            read_count++;
+        if (bm1398_read_nonce(ctx, &nonces[read_count]) <= 0) {
+            continue;
         }
+
+        // Register responses lack NONCE_INDICATOR. About 1 in 32 real nonces
+        // look the same, so a word is only taken as a reply while the one
+        // read on that chain is in flight, and it completes that read: a
+        // misread nonce costs at most one sample, never a stream of them.
+        // The word has no chip/register field; the consumer gets the address
+        // and register of the read it was matched to.
+        const uint32_t raw = nonces[read_count].nonce;
+        const int src = NONCE_CHAIN_NUMBER(raw);
+        if (reads_pending && !(raw & NONCE_INDICATOR) && src < MAX_CHAINS &&
+            ctx->reg_read[src].pending) {
+            bm1398_reg_read_t *rd = &ctx->reg_read[src];
+            rd->pending = false;
+            if (ctx->reg_response_cb) {
+                ctx->reg_response_cb(ctx->reg_response_arg, src, rd->chip_addr,
+                                     rd->reg_addr, raw);
+            }
+            continue;
+        }
+        read_count++;
     }
 
     return read_count;
@@ -1358,19 +1977,6 @@ int bm1398_read_nonces(bm1398_context_t *ctx, nonce_response_t *nonces,
 #define PSU_ENABLE_GPIO     907
 #define GPIO_SYSFS_PATH     "/sys/class/gpio"
 
-// I2C control bits (FPGA register 0x0C)
-#define REG_I2C_CTRL        0x0C
-#define I2C_READY           (1U << 31)
-#define I2C_DATA_READY      (0x2U << 30)
-#define I2C_READ_OP         (1U << 25)
-#define I2C_READ_1BYTE      (1U << 19)
-#define I2C_REGADDR_VALID   (1U << 24)
-
-// PSU I2C addressing
-#define PSU_I2C_MASTER      1
-#define PSU_I2C_SLAVE_HIGH  0x02
-#define PSU_I2C_SLAVE_LOW   0x00
-
 // PSU protocol
 #define PSU_REG_LEGACY      0x00
 #define PSU_REG_V2          0x11
@@ -1381,7 +1987,6 @@ int bm1398_read_nonces(bm1398_context_t *ctx, nonce_response_t *nonces,
 #define CMD_SET_VOLTAGE     0x83
 
 // Timeouts
-#define I2C_TIMEOUT_MS      1000
 #define PSU_SEND_DELAY_MS   400
 #define PSU_READ_DELAY_MS   100
 #define PSU_RETRIES         3
@@ -1428,62 +2033,31 @@ static int gpio_setup(int gpio, int value) {
 }
 
 /**
- * I2C helper functions
+ * PSU I2C helpers (routed through the shared FPGA I2C scheduler)
  */
-static inline uint32_t i2c_build_cmd(uint8_t reg, uint8_t data, bool read) {
-    uint32_t cmd = (PSU_I2C_MASTER << 26) |
-                   (PSU_I2C_SLAVE_HIGH << 20) |
-                   ((PSU_I2C_SLAVE_LOW & 0x0E) << 15) |
-                   I2C_REGADDR_VALID | (reg << 8);
-
-    if (read) {
-        cmd |= I2C_READ_OP | I2C_READ_1BYTE;
-    } else {
-        cmd |= data;
-    }
+static int psu_write_bytes(fpga_i2c_t *bus, uint8_t reg, const uint8_t *data,
+                           size_t len) {
+    fpga_i2c_op_t ops[8];
 
-    return cmd;
-}
+    if (len > sizeof(ops) / sizeof(ops[0])) return -1;
+    for (size_t i = 0; i < len; i++)
+        fpga_i2c_op_psu(&ops[i], reg, data[i], false);
 
-static int i2c_wait_ready(volatile uint32_t *regs) {
-    for (int i = 0; i < I2C_TIMEOUT_MS / 5; i++) {
-        if (regs[REG_I2C_CTRL] & I2C_READY)
-            return 0;
-        usleep(5000);
-    }
-    return -1;
+    return fpga_i2c_xfer_frame(bus, ops, len);
 }
 
-static int i2c_wait_data(volatile uint32_t *regs, uint8_t *data) {
-    for (int i = 0; i < I2C_TIMEOUT_MS / 5; i++) {
-        uint32_t val = regs[REG_I2C_CTRL];
-        if ((val >> 30) == 2) {
-            *data = (uint8_t)(val & 0xFF);
-            return 0;
-        }
-        usleep(5000);
-    }
-    return -1;
-}
-
-static int i2c_write_byte(volatile uint32_t *regs, uint8_t reg, uint8_t data) {
-    uint8_t dummy;
-
-    if (i2c_wait_ready(regs) < 0) return -1;
-
-    regs[REG_I2C_CTRL] = i2c_build_cmd(reg, data, false);
-    __sync_synchronize();
-
-    return i2c_wait_data(regs, &dummy);
-}
+static int psu_read_bytes(fpga_i2c_t *bus, uint8_t reg, uint8_t *data, size_t len) {
+    fpga_i2c_op_t ops[8];
 
-static int i2c_read_byte(volatile uint32_t *regs, uint8_t reg, uint8_t *data) {
-    if (i2c_wait_ready(regs) < 0) return -1;
+    if (len > sizeof(ops) / sizeof(ops[0])) return -1;
+    for (size_t i = 0; i < len; i++)
+        fpga_i2c_op_psu(&ops[i], reg, 0, true);
 
-    regs[REG_I2C_CTRL] = i2c_build_cmd(reg, 0, true);
-    __sync_synchronize();
+    if (fpga_i2c_xfer_frame(bus, ops, len) < 0) return -1;
+    for (size_t i = 0; i < len; i++)
+        data[i] = ops[i].data;
 
-    return i2c_wait_data(regs, data);
+    return 0;
 }
 
 /**
@@ -1496,41 +2070,39 @@ static uint16_t calc_checksum(const uint8_t *data, size_t start, size_t end) {
     return sum;
 }
 
-static int psu_transact(volatile uint32_t *regs, const uint8_t *tx, size_t tx_len,
+static int psu_transact(fpga_i2c_t *bus, const uint8_t *tx, size_t tx_len,
                        uint8_t *rx, size_t rx_len) {
+    const int trace = boot_trace_begin("psu transaction", BOOT_TRACE_NO_CHAIN);
     for (int retry = 0; retry < PSU_RETRIES; retry++) {
         // Send command
-        bool tx_ok = true;
-        for (size_t i = 0; i < tx_len && tx_ok; i++)
-            tx_ok = (i2c_write_byte(regs, g_psu_reg, tx[i]) == 0);
-        if (!tx_ok) continue;
+        if (psu_write_bytes(bus, g_psu_reg, tx, tx_len) < 0) continue;
 
         usleep(PSU_SEND_DELAY_MS * 1000);
 
         // Read response
-        bool rx_ok = true;
-        for (size_t i = 0; i < rx_len && rx_ok; i++)
-            rx_ok = (i2c_read_byte(regs, g_psu_reg, &rx[i]) == 0);
-        if (!rx_ok) continue;
+        if (psu_read_bytes(bus, g_psu_reg, rx, rx_len) < 0) continue;
 
         usleep(PSU_READ_DELAY_MS * 1000);
 
         // Validate magic bytes
-        if (rx[0] == PSU_MAGIC_1 && rx[1] == PSU_MAGIC_2)
+        if (rx[0] == PSU_MAGIC_1 && rx[1] == PSU_MAGIC_2) {
+            boot_trace_end(trace);
             return 0;
+        }
     }
 
+    boot_trace_end(trace);
     return -1;
 }
 
-static int psu_detect_protocol(volatile uint32_t *regs) {
+static int psu_detect_protocol(fpga_i2c_t *bus) {
     uint8_t test_val = PSU_DETECT_MAGIC, read_val;
 
     // Try V2 first
     g_psu_reg = PSU_REG_V2;
-    if (i2c_write_byte(regs, g_psu_reg, test_val) == 0) {
+    if (psu_write_bytes(bus, g_psu_reg, &test_val, 1) == 0) {
         usleep(10000);
-        if (i2c_read_byte(regs, g_psu_reg, &read_val) == 0 && read_val == test_val) {
+        if (psu_read_bytes(bus, g_psu_reg, &read_val, 1) == 0 && read_val == test_val) {
             return 0;  // V2 protocol
         }
     }
@@ -1540,14 +2112,14 @@ static int psu_detect_protocol(volatile uint32_t *regs) {
     return 0;
 }
 
-static int psu_get_version(volatile uint32_t *regs) {
+static int psu_get_version(fpga_i2c_t *bus) {
     uint8_t tx[8] = {PSU_MAGIC_1, PSU_MAGIC_2, 4, CMD_GET_TYPE};
     uint8_t rx[8];
     uint16_t csum = calc_checksum(tx, 2, 4);
     tx[4] = csum & 0xFF;
     tx[5] = (csum >> 8) & 0xFF;
 
-    if (psu_transact(regs, tx, 6, rx, 8) < 0)
+    if (psu_transact(bus, tx, 6, rx, 8) < 0)
         return -1;
 
     g_psu_version = rx[4];
@@ -1562,7 +2134,7 @@ static uint16_t voltage_to_psu(uint32_t mv) {
     return (uint16_t)n;
 }
 
-static int psu_set_voltage(volatile uint32_t *regs, uint32_t mv) {
+static int psu_set_voltage(fpga_i2c_t *bus, uint32_t mv) {
     if (g_psu_version != 0x71) {
         fprintf(stderr, "Error: Unsupported PSU version 0x%02X\n", g_psu_version);
         return -1;
@@ -1576,7 +2148,7 @@ static int psu_set_voltage(volatile uint32_t *regs, uint32_t mv) {
     tx[6] = csum & 0xFF;
     tx[7] = (csum >> 8) & 0xFF;
 
-    if (psu_transact(regs, tx, 8, rx, 8) < 0)
+    if (psu_transact(bus, tx, 8, rx, 8) < 0)
         return -1;
 
     return (rx[3] == CMD_SET_VOLTAGE) ? 0 : -1;
@@ -1586,69 +2158,18 @@ static int psu_set_voltage(volatile uint32_t *regs, uint32_t mv) {
 // PIC Hashboard Power Control (FPGA I2C)
 //==============================================================================
 
-// PIC I2C addressing via FPGA
-#define PIC_I2C_MASTER      0
-#define PIC_I2C_SLAVE_HIGH  0x04
-
 /**
- * Build FPGA I2C command for PIC communication
+ * Send the DC-DC enable command to a hashboard PIC
  *
- * Based on factory test i2c_write-001ca624.c line 46:
- * fpga_write(0xc, (slave_addr >> 4) << 0x14 | master << 0x1a |
- *                 ((slave_addr << 0x1c) >> 0x1d) << 0x10 | data)
- *
- * Where slave_addr = (chain << 1) | (0x04 << 4)
+ * The PIC needs PIC_DC_DC_WAIT_MS before bm1398_dc_dc_confirm() can read
+ * its answer. Based on factory test enable_dc_dc-001c5ae4.c and
+ * i2c_write-001ca624.c
  */
-static inline uint32_t pic_i2c_build_cmd(uint8_t chain, uint8_t data, bool read) {
-    uint8_t slave_addr = (chain << 1) | (PIC_I2C_SLAVE_HIGH << 4);
-
-    uint32_t cmd = (PIC_I2C_MASTER << 26) |
-                   ((slave_addr >> 4) << 20) |
-                   ((slave_addr & 0x0E) << 15);
-
-    if (read) {
-        cmd |= I2C_READ_OP | I2C_READ_1BYTE;
-    } else {
-        cmd |= data;
-    }
-
-    return cmd;
-}
-
-static int pic_i2c_write_byte(volatile uint32_t *regs, uint8_t chain, uint8_t data) {
-    uint8_t dummy;
-
-    if (i2c_wait_ready(regs) < 0) return -1;
-
-    regs[REG_I2C_CTRL] = pic_i2c_build_cmd(chain, data, false);
-    __sync_synchronize();
-
-    return i2c_wait_data(regs, &dummy);
-}
-
-static int pic_i2c_read_byte(volatile uint32_t *regs, uint8_t chain, uint8_t *data) {
-    if (i2c_wait_ready(regs) < 0) return -1;
-
-    regs[REG_I2C_CTRL] = pic_i2c_build_cmd(chain, 0, true);
-    __sync_synchronize();
-
-    return i2c_wait_data(regs, data);
-}
-
-/**
- * Enable hashboard DC-DC converter via PIC I2C
- *
- * NOTE: This may not be necessary if DC-DC is already enabled from
- * previous run or if it auto-enables on PSU power-on.
- *
- * Based on factory test enable_dc_dc-001c5ae4.c and i2c_write-001ca624.c
- */
-int bm1398_enable_dc_dc(bm1398_context_t *ctx, int chain) {
+int bm1398_dc_dc_request(bm1398_context_t *ctx, int chain) {
     if (!ctx || !ctx->initialized) {
         return -1;
     }
 
-    volatile uint32_t *regs = ctx->fpga_regs;
     uint8_t send_data[7] = {
         0x55,       // Magic byte 1
         0xAA,       // Magic byte 2
@@ -1658,29 +2179,42 @@ int bm1398_enable_dc_dc(bm1398_context_t *ctx, int chain) {
         0x00,       // Padding
         0x1B        // Checksum
     };
+    fpga_i2c_op_t ops[7];
 
     printf("Attempting to enable PIC DC-DC converter for chain %d...\n", chain);
-    printf("  PIC slave address: 0x%02X\n", (chain << 1) | (PIC_I2C_SLAVE_HIGH << 4));
+    printf("  PIC slave address: 0x%02X\n", (chain << 1) | (0x04 << 4));
 
     // Send command
     for (int i = 0; i < 7; i++) {
-        if (pic_i2c_write_byte(regs, chain, send_data[i]) < 0) {
-            fprintf(stderr, "  Warning: PIC write byte %d failed (may already be enabled)\n", i);
-            return -1;
-        }
+        fpga_i2c_op_pic(&ops[i], chain, send_data[i], false);
+    }
+    if (fpga_i2c_xfer_frame(&ctx->i2c, ops, 7) < 0) {
+        fprintf(stderr, "  Warning: PIC write failed (may already be enabled)\n");
+        return -1;
     }
+    return 0;
+}
 
-    // Wait for PIC to process
-    usleep(300000);
+/**
+ * Read the PIC's answer to bm1398_dc_dc_request()
+ */
+int bm1398_dc_dc_confirm(bm1398_context_t *ctx, int chain) {
+    if (!ctx || !ctx->initialized) {
+        return -1;
+    }
 
     // Read response
+    fpga_i2c_op_t ops[2];
     uint8_t read_data[2] = {0};
     for (int i = 0; i < 2; i++) {
-        if (pic_i2c_read_byte(regs, chain, &read_data[i]) < 0) {
-            fprintf(stderr, "  Warning: PIC read byte %d failed (may already be enabled)\n", i);
-            return -1;
-        }
+        fpga_i2c_op_pic(&ops[i], chain, 0, true);
+    }
+    if (fpga_i2c_xfer_frame(&ctx->i2c, ops, 2) < 0) {
+        fprintf(stderr, "  Warning: PIC read failed (may already be enabled)\n");
+        return -1;
     }
+    read_data[0] = ops[0].data;
+    read_data[1] = ops[1].data;
 
     // Validate response
     if (read_data[0] != 0x15 || read_data[1] != 0x01) {
@@ -1695,50 +2229,100 @@ int bm1398_enable_dc_dc(bm1398_context_t *ctx, int chain) {
 }
 
 /**
- * Power on PSU at specified voltage
+ * Enable hashboard DC-DC converter via PIC I2C
  *
- * Sequence:
- * 1. Detect PSU protocol (V2 or legacy)
- * 2. Read PSU version
- * 3. Set voltage via I2C
- * 4. Enable PSU via GPIO 907 (write 0 to enable)
- * 5. Wait 2 seconds for power to settle
+ * NOTE: This may not be necessary if DC-DC is already enabled from
+ * previous run or if it auto-enables on PSU power-on.
+ */
+int bm1398_enable_dc_dc(bm1398_context_t *ctx, int chain) {
+    if (bm1398_dc_dc_request(ctx, chain) < 0) {
+        return -1;
+    }
+
+    // Wait for PIC to process
+    const int trace = boot_trace_begin("pic dc-dc settle", chain);
+    usleep(PIC_DC_DC_WAIT_MS * 1000);
+    boot_trace_end(trace);
+
+    return bm1398_dc_dc_confirm(ctx, chain);
+}
+
+/**
+ * Take over a PSU that is already on (warm start)
  *
- * Based on psu_test.c and factory test APW_power_on-0005e6f8.c
+ * Detects the protocol and sets the voltage, without toggling the enable
+ * GPIO or waiting for the rails to come up. Also steps 1-3 of
+ * bm1398_psu_power_on().
  */
-int bm1398_psu_power_on(bm1398_context_t *ctx, uint32_t voltage_mv) {
+int bm1398_psu_adopt(bm1398_context_t *ctx, uint32_t voltage_mv) {
     if (!ctx || !ctx->initialized) {
         return -1;
     }
 
-    // Detect PSU protocol (if not already detected)
     if (g_psu_version == 0) {
-        if (psu_detect_protocol(ctx->fpga_regs) < 0) {
+        if (psu_detect_protocol(&ctx->i2c) < 0) {
             fprintf(stderr, "Error: PSU protocol detection failed\n");
             return -1;
         }
-
-        // Read PSU version
-        if (psu_get_version(ctx->fpga_regs) < 0) {
+        if (psu_get_version(&ctx->i2c) < 0) {
             fprintf(stderr, "Warning: Could not read PSU version, assuming 0x71\n");
             g_psu_version = 0x71;
         }
     }
 
-    // Set voltage via I2C
-    if (psu_set_voltage(ctx->fpga_regs, voltage_mv) < 0) {
+    if (psu_set_voltage(&ctx->i2c, voltage_mv) < 0) {
         fprintf(stderr, "Error: Failed to set PSU voltage to %umV\n", voltage_mv);
         return -1;
     }
+    return 0;
+}
 
-    // Enable PSU via GPIO 907 (write 0 to enable)
+/**
+ * Switch the PSU output on (GPIO 907, active low)
+ *
+ * The rails need PSU_SETTLE_MS before the hashboards are usable.
+ */
+int bm1398_psu_enable(bm1398_context_t *ctx) {
+    if (!ctx || !ctx->initialized) {
+        return -1;
+    }
     if (gpio_setup(PSU_ENABLE_GPIO, 0) < 0) {
         fprintf(stderr, "Error: Failed to enable PSU GPIO %d\n", PSU_ENABLE_GPIO);
         return -1;
     }
+    return 0;
+}
+
+/**
+ * Power on PSU at specified voltage
+ *
+ * Sequence:
+ * 1. Detect PSU protocol (V2 or legacy)
+ * 2. Read PSU version
+ * 3. Set voltage via I2C
+ * 4. Enable PSU via GPIO 907 (write 0 to enable)
+ * 5. Wait 2 seconds for power to settle
+ *
+ * Based on psu_test.c and factory test APW_power_on-0005e6f8.c
+ */
+int bm1398_psu_power_on(bm1398_context_t *ctx, uint32_t voltage_mv) {
+    if (!ctx || !ctx->initialized) {
+        return -1;
+    }
+
+    // Detect protocol and version, set voltage via I2C
+    if (bm1398_psu_adopt(ctx, voltage_mv) < 0) {
+        return -1;
+    }
+
+    if (bm1398_psu_enable(ctx) < 0) {
+        return -1;
+    }
 
-    // Wait 2 seconds for power to settle (from psu_test.c)
-    sleep(2);
+    // Wait for power to settle (from psu_test.c)
+    const int trace = boot_trace_begin("psu rail settle", BOOT_TRACE_NO_CHAIN);
+    usleep(PSU_SETTLE_MS * 1000);
+    boot_trace_end(trace);
 
     return 0;
 }
@@ -1756,7 +2340,7 @@ int bm1398_psu_set_voltage(bm1398_context_t *ctx, uint32_t voltage_mv) {
     }
 
     // Set voltage via I2C
-    if (psu_set_voltage(ctx->fpga_regs, voltage_mv) < 0) {
+    if (psu_set_voltage(&ctx->i2c, voltage_mv) < 0) {
         fprintf(stderr, "Error: Failed to set PSU voltage to %umV\n", voltage_mv);
         return -1;
     }
@@ -0,0 +1,59 @@
+/*
+ * BM1398 Hashboard Profiles Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/board_profile.h"
+#include "../include/work_timing.h"
+
+static const board_profile_t g_profiles[] = {
+    // bmminer log: "freq = 525"; voltages from work_test / bmminer
+    { "s19pro",   "Antminer S19 Pro",                3, 38, 3, 114, 525, 15000, 12600, true },
+    { "s19pro-4", "Antminer S19 Pro (4-chain FPGA)", 4, 38, 3, 114, 525, 15000, 12600, true },
+    // No stock S19 config in hand: S19 Pro power defaults, flagged at runtime
+    { "s19",      "Antminer S19",                    3, 38, 2,  76, 525, 15000, 12600, false },
+};
+
+#define NUM_PROFILES (sizeof(g_profiles) / sizeof(g_profiles[0]))
+
+const board_profile_t *board_profile_find(const char *name) {
+    if (!name) {
+        name = BOARD_PROFILE_DEFAULT;
+    }
+    for (size_t i = 0; i < NUM_PROFILES; i++) {
+        if (strcmp(g_profiles[i].name, name) == 0) {
+            return &g_profiles[i];
+        }
+    }
+    return NULL;
+}
+
+void board_profile_list(void) {
+    for (size_t i = 0; i < NUM_PROFILES; i++) {
+        const board_profile_t *p = &g_profiles[i];
+        printf("  %-10s %s: %d chains x %d chips (%d domains x %d), %u MHz%s%s\n",
+               p->name, p->model, p->chains, p->chips_per_chain, p->domains,
+               p->chips_per_domain, p->freq_mhz, p->verified ? "" : " (unverified)",
+               strcmp(p->name, BOARD_PROFILE_DEFAULT) == 0 ? " (default)" : "");
+    }
+}
+
+//==============================================================================
+// Derived Parameters
+//==============================================================================
+
+/**
+ * Plug-detect bits the FPGA has slots for
+ */
+uint32_t board_profile_chain_mask(const board_profile_t *p) {
+    return (1u << p->chains) - 1;
+}
+
+/**
+ * Chip address interval (the spacing bm1398_enumerate_chips() assigns)
+ */
+int board_profile_interval(const board_profile_t *p) {
+    return work_timing_interval(p->chips_per_chain);
+}
@@ -0,0 +1,235 @@
+/*
+ * Startup Timeline Profiler Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../include/boot_trace.h"
+
+#define SUMMARY_MAX_NAMES           64
+
+static boot_trace_event_t g_events[BOOT_TRACE_MAX_EVENTS];
+static int g_num_events = 0;
+static int g_open[BOOT_TRACE_MAX_DEPTH];    // Open events, innermost last
+static int g_depth = 0;
+static bool g_recording = false;
+static uint64_t g_t0_us = 0;
+static uint64_t g_wall_us = 0;
+static uint32_t g_dropped = 0;              // Buffer or depth exhausted
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000ULL;
+}
+
+//==============================================================================
+// Recording
+//==============================================================================
+
+void boot_trace_start(void) {
+    g_num_events = 0;
+    g_depth = 0;
+    g_dropped = 0;
+    g_wall_us = 0;
+    g_t0_us = now_us();
+    g_recording = true;
+}
+
+/**
+ * Close the open events down to (and including) depth `level`
+ */
+static void close_to(int level, uint64_t t) {
+    while (g_depth > level) {
+        boot_trace_event_t *e = &g_events[g_open[--g_depth]];
+        e->dur_us = t - e->start_us;
+        if (e->parent >= 0) {
+            g_events[e->parent].child_us += e->dur_us;
+        }
+    }
+}
+
+void boot_trace_stop(void) {
+    if (!g_recording) {
+        return;
+    }
+    const uint64_t t = now_us() - g_t0_us;
+    close_to(0, t);
+    g_wall_us = t;
+    g_recording = false;
+}
+
+int boot_trace_begin(const char *name, int chain) {
+    if (!g_recording) {
+        return -1;
+    }
+    if (g_num_events == BOOT_TRACE_MAX_EVENTS || g_depth == BOOT_TRACE_MAX_DEPTH) {
+        g_dropped++;
+        return -1;
+    }
+
+    const int id = g_num_events++;
+    boot_trace_event_t *e = &g_events[id];
+    e->name = name;
+    e->chain = (int8_t)chain;
+    e->depth = (uint8_t)g_depth;
+    e->parent = g_depth > 0 ? (int16_t)g_open[g_depth - 1] : -1;
+    e->dur_us = 0;
+    e->child_us = 0;
+    e->start_us = now_us() - g_t0_us;
+    g_open[g_depth++] = id;
+    return id;
+}
+
+void boot_trace_end(int id) {
+    if (!g_recording || id < 0) {
+        return;
+    }
+    const uint64_t t = now_us() - g_t0_us;
+
+    // Events opened after `id` and never ended end with it
+    for (int level = g_depth - 1; level >= 0; level--) {
+        if (g_open[level] == id) {
+            close_to(level, t);
+            return;
+        }
+    }
+}
+
+//==============================================================================
+// Results
+//==============================================================================
+
+typedef struct {
+    const char *name;
+    uint64_t self_us;
+    uint64_t total_us;
+    uint32_t count;
+} step_total_t;
+
+static int by_self_time(const void *a, const void *b) {
+    const step_total_t *x = a, *y = b;
+    return x->self_us < y->self_us ? 1 : x->self_us > y->self_us ? -1 : 0;
+}
+
+/**
+ * Print the top-level phases and the steps with the most self time
+ *
+ * Self time is an event's duration minus its nested events. Bring-up
+ * overlaps its waits (startup.h), so the ranking shows where the time went,
+ * not the critical path; startup_print() shows how the tasks overlapped.
+ */
+void boot_trace_print(void) {
+    if (g_num_events == 0) {
+        return;
+    }
+
+    const uint64_t wall = g_recording ? now_us() - g_t0_us : g_wall_us;
+    printf("Startup timeline: %.2f s, %d events", wall / 1e6, g_num_events);
+    if (g_dropped) {
+        printf(" (%u dropped)", g_dropped);
+    }
+    printf("\n");
+
+    uint64_t traced = 0;
+    for (int i = 0; i < g_num_events; i++) {
+        const boot_trace_event_t *e = &g_events[i];
+        if (e->depth != 0) {
+            continue;
+        }
+        traced += e->dur_us;
+        if (e->chain == BOOT_TRACE_NO_CHAIN) {
+            printf("  %-24s %8.3f s\n", e->name, e->dur_us / 1e6);
+        } else {
+            printf("  %-16s chain %d %8.3f s\n", e->name, e->chain, e->dur_us / 1e6);
+        }
+    }
+
+    step_total_t steps[SUMMARY_MAX_NAMES];
+    int num_steps = 0;
+    for (int i = 0; i < g_num_events; i++) {
+        const boot_trace_event_t *e = &g_events[i];
+        int s = 0;
+        while (s < num_steps && strcmp(steps[s].name, e->name) != 0) {
+            s++;
+        }
+        if (s == num_steps) {
+            if (num_steps == SUMMARY_MAX_NAMES) {
+                continue;
+            }
+            memset(&steps[s], 0, sizeof(steps[s]));
+            steps[s].name = e->name;
+            num_steps++;
+        }
+        steps[s].self_us += e->dur_us - e->child_us;
+        steps[s].total_us += e->dur_us;
+        steps[s].count++;
+    }
+    qsort(steps, num_steps, sizeof(steps[0]), by_self_time);
+
+    printf("  Steps by self time:\n");
+    for (int s = 0; s < num_steps && s < BOOT_TRACE_SUMMARY_STEPS; s++) {
+        printf("    %-20s %8.3f s %5.1f %%  (%u x, %.1f ms avg)\n",
+               steps[s].name, steps[s].self_us / 1e6,
+               wall ? 100.0 * steps[s].self_us / wall : 0.0,
+               steps[s].count, steps[s].total_us / 1e3 / steps[s].count);
+    }
+    if (wall > traced) {
+        printf("    %-20s %8.3f s %5.1f %%\n", "(untraced)",
+               (wall - traced) / 1e6, 100.0 * (wall - traced) / wall);
+    }
+}
+
+/**
+ * Write the recording as Chrome trace JSON
+ *
+ * Complete ("X") events with microsecond timestamps; tid 0 holds the
+ * FPGA/PSU phases and tid N + 1 holds chain N.
+ * Returns: 0 on success, -1 on error
+ */
+int boot_trace_write_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("boot trace");
+        return -1;
+    }
+
+    bool used[128] = { false };
+    for (int i = 0; i < g_num_events; i++) {
+        used[g_events[i].chain + 1] = true;
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"hashsource startup\"}}");
+    for (int tid = 0; tid < 128; tid++) {
+        if (!used[tid]) {
+            continue;
+        }
+        char track[32];
+        if (tid == 0) {
+            snprintf(track, sizeof(track), "system");
+        } else {
+            snprintf(track, sizeof(track), "chain %d", tid - 1);
+        }
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                   "\"args\":{\"name\":\"%s\"}}", tid, track);
+    }
+    for (int i = 0; i < g_num_events; i++) {
+        const boot_trace_event_t *e = &g_events[i];
+        fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"boot\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                   "\"ts\":%llu,\"dur\":%llu}",
+                e->name, e->chain + 1,
+                (unsigned long long)e->start_us, (unsigned long long)e->dur_us);
+    }
+    fprintf(f, "\n]}\n");
+
+    if (fclose(f) != 0) {
+        perror("boot trace");
+        return -1;
+    }
+    return 0;
+}
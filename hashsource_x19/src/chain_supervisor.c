@@ -0,0 +1,285 @@
+/*
+ * Per-Chain Fault Supervisor Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../include/chain_supervisor.h"
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+/**
+ * Totals of the chain's temperature reads (answered, timed out)
+ */
+static void response_totals(const temp_monitor_t *tm, int chain,
+                            uint32_t *samples, uint32_t *timeouts) {
+    *samples = 0;
+    *timeouts = 0;
+    for (int i = 0; i < tm->num_sensors[chain]; i++) {
+        *samples += tm->sensors[chain][i].responses;
+        *timeouts += tm->sensors[chain][i].timeouts;
+    }
+}
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+void chain_supervisor_init(chain_supervisor_t *sv, bm1398_context_t *ctx,
+                           const temp_monitor_t *temps, bool stall_check) {
+    memset(sv, 0, sizeof(*sv));
+    sv->ctx = ctx;
+    sv->temps = temps;
+    sv->stall_check = stall_check;
+    sv->crc_last = (uint32_t)bm1398_get_crc_error_count(ctx);
+    sv->last_tick_ms = now_ms();
+}
+
+void chain_supervisor_chain_up(chain_supervisor_t *sv, int chain) {
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+    supervisor_chain_t *c = &sv->chain[chain];
+    const uint64_t now = now_ms();
+
+    if (c->state == SUPERVISOR_RECOVERING) {
+        const uint32_t took = (uint32_t)(now - c->fault_ms);
+        c->recoveries++;
+        c->recovery_ms_total += took;
+        c->last_recovery_ms = took;
+        if (took > c->max_recovery_ms) {
+            c->max_recovery_ms = took;
+        }
+        printf("Supervisor: chain %d recovered in %.1f s (MTTR %.1f s over %u)\n",
+               chain, took / 1000.0,
+               c->recovery_ms_total / 1000.0 / c->recoveries, c->recoveries);
+    }
+
+    c->state = SUPERVISOR_WATCHING;
+    c->up_ms = now;
+    c->tick_nonces = 0;
+    c->nonces_since_up = 0;
+    c->rate = 0.0f;
+    c->last_nonce_ms = now;
+    c->stall_ms = SUPERVISOR_STALL_MIN_MS;
+    c->work_at_nonce = sv->ctx->works_sent[chain];
+    response_totals(sv->temps, chain, &c->samples, &c->timeouts);
+    c->misses = 0;
+    c->last_answer_ms = 0;
+}
+
+void chain_supervisor_chain_gone(chain_supervisor_t *sv, int chain) {
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+    // A different board may come back: start its history afresh
+    memset(&sv->chain[chain], 0, sizeof(sv->chain[chain]));
+}
+
+void chain_supervisor_nonce(chain_supervisor_t *sv, int chain) {
+    if (sv->stall_check && (unsigned)chain < MAX_CHAINS) {
+        sv->chain[chain].tick_nonces++;
+    }
+}
+
+//==============================================================================
+// Checks
+//==============================================================================
+
+const char *chain_supervisor_fault_name(supervisor_fault_t fault) {
+    switch (fault) {
+    case SUPERVISOR_FAULT_STALL:        return "nonce stall";
+    case SUPERVISOR_FAULT_UNRESPONSIVE: return "no register responses";
+    case SUPERVISOR_FAULT_CRC:          return "CRC error burst";
+    case SUPERVISOR_FAULT_TYPES:        break;
+    }
+    return "unknown";
+}
+
+/**
+ * Record a fault and decide whether to recover the chain
+ * A fault with a cause outside the chain (count_streak false) is recovered
+ * but does not bring the chain closer to being given up on.
+ * Returns: true if the chain should be recovered
+ */
+static bool fault(chain_supervisor_t *sv, int chain, supervisor_fault_t type,
+                  uint64_t now, bool count_streak) {
+    supervisor_chain_t *c = &sv->chain[chain];
+    c->faults[type]++;
+    if (now - c->up_ms >= SUPERVISOR_STABLE_MS) {
+        c->streak = 0;
+    }
+    if (count_streak) {
+        c->streak++;
+    }
+
+    if (c->streak > SUPERVISOR_MAX_STREAK) {
+        c->state = SUPERVISOR_GAVE_UP;
+        printf("Supervisor: chain %d %s, %d faults in a row: no more recovery\n",
+               chain, chain_supervisor_fault_name(type), c->streak);
+        return false;
+    }
+    c->state = SUPERVISOR_RECOVERING;
+    c->fault_ms = now;
+    printf("Supervisor: chain %d %s, recovering (%d/%d)\n",
+           chain, chain_supervisor_fault_name(type), c->streak, SUPERVISOR_MAX_STREAK);
+    return true;
+}
+
+uint32_t chain_supervisor_tick(chain_supervisor_t *sv) {
+    const uint64_t now = now_ms();
+    const uint64_t dt = now - sv->last_tick_ms;
+    sv->last_tick_ms = now;
+
+    // FPGA-wide counter; a reset or wrap counts as no new errors
+    const uint32_t crc = (uint32_t)bm1398_get_crc_error_count(sv->ctx);
+    const bool crc_burst = crc >= sv->crc_last && crc - sv->crc_last >= SUPERVISOR_CRC_BURST;
+    sv->crc_last = crc;
+
+    int watched = 0;
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        watched += sv->chain[chain].state == SUPERVISOR_WATCHING;
+    }
+
+    // Pass 1: nonce rates and register responses; find the quiet chains
+    bool answered[MAX_CHAINS] = {false};
+    uint32_t missed[MAX_CHAINS] = {0};
+    uint32_t armed = 0, stalled = 0, fed = 0;
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        supervisor_chain_t *c = &sv->chain[chain];
+        if (c->state != SUPERVISOR_WATCHING) {
+            continue;
+        }
+
+        const uint32_t n = c->tick_nonces;
+        c->tick_nonces = 0;
+        c->nonces_since_up += n;
+        if (dt > 0) {
+            c->rate += SUPERVISOR_RATE_ALPHA * (n * 1000.0f / dt - c->rate);
+        }
+        const uint32_t sent = sv->ctx->works_sent[chain];
+        if (n > 0) {
+            // Window from the rate while nonces flow: the EWMA decays in silence
+            c->last_nonce_ms = now;
+            c->work_at_nonce = sent;
+            c->stall_ms = SUPERVISOR_STALL_MIN_MS;
+            if (c->rate > 0.0f && SUPERVISOR_STALL_INTERVALS * 1000.0f / c->rate > c->stall_ms) {
+                c->stall_ms = (uint32_t)(SUPERVISOR_STALL_INTERVALS * 1000.0f / c->rate);
+            }
+        }
+
+        uint32_t samples, timeouts;
+        response_totals(sv->temps, chain, &samples, &timeouts);
+        answered[chain] = samples != c->samples;
+        missed[chain] = timeouts >= c->timeouts ? timeouts - c->timeouts : 0;
+        c->samples = samples;
+        c->timeouts = timeouts;
+        if (answered[chain]) {
+            c->last_answer_ms = now;
+            c->misses = 0;
+        } else {
+            c->misses += missed[chain];
+        }
+
+        if (c->nonces_since_up >= SUPERVISOR_ARM_NONCES) {
+            armed |= 1u << chain;
+            if (n == 0 && now - c->last_nonce_ms > c->stall_ms) {
+                stalled |= 1u << chain;
+                if (sent != c->work_at_nonce) {
+                    fed |= 1u << chain;
+                }
+            }
+        }
+    }
+
+    // Every armed chain quiet at once points at the work source. A lone
+    // chain has nothing to diverge from, so only queued work convicts it.
+    const bool all_stalled = stalled != 0 && stalled == armed &&
+                             __builtin_popcount(armed) > 1;
+    if (all_stalled && !sv->all_stalled) {
+        sv->common_stalls++;
+        printf("Supervisor: every chain stopped returning nonces at once%s\n",
+               fed ? "" : " with no work queued, not recovering");
+    }
+    sv->all_stalled = all_stalled;
+
+    // Pass 2: decide which chains are faulty
+    uint32_t recover = 0;
+    bool crc_blamed = false;
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        supervisor_chain_t *c = &sv->chain[chain];
+        if (c->state != SUPERVISOR_WATCHING) {
+            continue;
+        }
+
+        bool faulty = false;
+        bool count_streak = true;
+        supervisor_fault_t type = SUPERVISOR_FAULT_STALL;
+        if (stalled & (1u << chain)) {
+            faulty = (armed & ~stalled) != 0 || (fed & (1u << chain));
+            count_streak = !all_stalled;
+        }
+        if (!faulty && c->last_answer_ms != 0 &&
+            now - c->last_answer_ms >= SUPERVISOR_RESPONSE_MS &&
+            c->misses >= SUPERVISOR_RESPONSE_MISSES) {
+            faulty = true;
+            type = SUPERVISOR_FAULT_UNRESPONSIVE;
+            count_streak = true;
+        }
+        if (!faulty && crc_burst &&
+            (watched == 1 || (missed[chain] > 0 && !answered[chain]))) {
+            faulty = true;
+            type = SUPERVISOR_FAULT_CRC;
+            count_streak = true;
+            crc_blamed = true;
+        }
+
+        if (faulty && fault(sv, chain, type, now, count_streak)) {
+            recover |= 1u << chain;
+        }
+    }
+
+    if (crc_burst && !crc_blamed) {
+        sv->crc_unattributed++;
+    }
+    return recover;
+}
+
+//==============================================================================
+// Reporting
+//==============================================================================
+
+void chain_supervisor_print(const chain_supervisor_t *sv) {
+    static const char *const state_names[] = {
+        "idle", "watching", "recovering", "gave up",
+    };
+
+    printf("Chain supervisor%s:\n", sv->stall_check ? "" : " (stall check off)");
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const supervisor_chain_t *c = &sv->chain[chain];
+        if (c->state == SUPERVISOR_IDLE) {
+            continue;
+        }
+        printf("  Chain %d: %s, faults: stall %u, unresponsive %u, CRC %u",
+               chain, state_names[c->state], c->faults[SUPERVISOR_FAULT_STALL],
+               c->faults[SUPERVISOR_FAULT_UNRESPONSIVE], c->faults[SUPERVISOR_FAULT_CRC]);
+        if (c->recoveries > 0) {
+            printf("; %u recovered, MTTR %.1f s (last %.1f s, max %.1f s)",
+                   c->recoveries, c->recovery_ms_total / 1000.0 / c->recoveries,
+                   c->last_recovery_ms / 1000.0, c->max_recovery_ms / 1000.0);
+        }
+        printf("\n");
+    }
+    if (sv->crc_unattributed) {
+        printf("  CRC bursts not attributed to a chain: %u\n", sv->crc_unattributed);
+    }
+    if (sv->common_stalls) {
+        printf("  All chains quiet at once (work source): %u\n", sv->common_stalls);
+    }
+}
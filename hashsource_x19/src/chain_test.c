@@ -101,8 +101,8 @@ int main(int argc, char *argv[]) {
 
     printf("Chain %d configuration:\n", chain_id);
     printf("  Chips per chain: %d\n", ctx.chips_per_chain[chain_id]);
-    printf("  Address interval: %d\n", CHIP_ADDRESS_INTERVAL);
-    printf("  Target frequency: %d MHz\n", FREQUENCY_525MHZ);
+    printf("  Address interval: %d\n", board_profile_interval(ctx.profile));
+    printf("  Target frequency: %u MHz\n", bm1398_start_freq(&ctx, chain_id));
     printf("  Target baud rate: %d Hz\n\n", BAUD_RATE_12MHZ);
 
     // Test 1: Chip enumeration only
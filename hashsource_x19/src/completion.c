@@ -0,0 +1,133 @@
+/*
+ * Test Completion Tracker Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../include/completion.h"
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+int completion_init(completion_t *c, int num_groups, uint32_t min_timeout_ms) {
+    memset(c, 0, sizeof(*c));
+    if (num_groups <= 0) {
+        return -1;
+    }
+
+    c->groups = calloc(num_groups, sizeof(completion_group_t));
+    if (!c->groups) {
+        fprintf(stderr, "Error: Failed to allocate completion tracker\n");
+        return -1;
+    }
+    c->num_groups = num_groups;
+    c->min_timeout_ms = min_timeout_ms;
+    c->start_ms = now_ms() - 1;     // Keep real timestamps non-zero
+    return 0;
+}
+
+void completion_free(completion_t *c) {
+    free(c->groups);
+    memset(c, 0, sizeof(*c));
+}
+
+//==============================================================================
+// Tracking
+//==============================================================================
+
+uint32_t completion_now(const completion_t *c) {
+    return (uint32_t)(now_ms() - c->start_ms);
+}
+
+void completion_sent(completion_t *c, int group, uint32_t expected) {
+    if (group < 0 || group >= c->num_groups) {
+        return;
+    }
+    completion_group_t *g = &c->groups[group];
+    g->expected += expected;
+    g->last_send_ms = completion_now(c);
+    c->expected_total += expected;
+}
+
+/**
+ * Record one new (non-duplicate) result for a group
+ */
+void completion_received(completion_t *c, int group) {
+    if (group < 0 || group >= c->num_groups) {
+        return;
+    }
+    completion_group_t *g = &c->groups[group];
+    const uint32_t now = completion_now(c);
+
+    if (g->first_ms == 0) {
+        g->first_ms = now;
+    }
+    g->last_ms = now;
+    g->received++;
+    c->received_total++;
+
+    if (g->last_send_ms && now - g->last_send_ms > c->max_latency_ms) {
+        c->max_latency_ms = now - g->last_send_ms;
+    }
+}
+
+//==============================================================================
+// Completion
+//==============================================================================
+
+uint32_t completion_timeout_ms(const completion_t *c) {
+    const uint32_t adaptive = COMPLETION_LATENCY_FACTOR * c->max_latency_ms;
+    return adaptive > c->min_timeout_ms ? adaptive : c->min_timeout_ms;
+}
+
+completion_state_t completion_check(const completion_t *c) {
+    if (c->expected_total > 0 && c->received_total >= c->expected_total) {
+        return COMPLETION_ALL_RECEIVED;
+    }
+
+    const uint32_t now = completion_now(c);
+    const uint32_t timeout = completion_timeout_ms(c);
+
+    for (int i = 0; i < c->num_groups; i++) {
+        const completion_group_t *g = &c->groups[i];
+        if (g->last_send_ms == 0 || (g->expected > 0 && g->received >= g->expected)) {
+            continue;   // Nothing sent, or complete
+        }
+        const uint32_t active = g->last_ms > g->last_send_ms ? g->last_ms : g->last_send_ms;
+        if (now - active <= timeout) {
+            return COMPLETION_PENDING;
+        }
+    }
+    return COMPLETION_TIMED_OUT;
+}
+
+int completion_span(const completion_t *c, int first, int count,
+                    uint32_t *first_ms, uint32_t *last_ms) {
+    uint32_t lo = 0, hi = 0;
+
+    for (int i = first; i < first + count && i < c->num_groups; i++) {
+        const completion_group_t *g = &c->groups[i];
+        if (g->first_ms == 0) {
+            continue;
+        }
+        if (lo == 0 || g->first_ms < lo) lo = g->first_ms;
+        if (g->last_ms > hi) hi = g->last_ms;
+    }
+
+    if (lo == 0) {
+        return -1;
+    }
+    *first_ms = lo;
+    *last_ms = hi;
+    return 0;
+}
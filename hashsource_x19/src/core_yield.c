@@ -0,0 +1,269 @@
+/*
+ * Dead-Core / Weak-Chip Detector Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "../include/core_yield.h"
+
+#define SINK_CHIP CORE_YIELD_MAX_CHIPS
+#define SINK_CORE CORE_YIELD_CORES
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+void core_yield_init(core_yield_t *cy) {
+    memset(cy, 0, sizeof(*cy));
+    memset(cy->addr_to_chip, SINK_CHIP, sizeof(cy->addr_to_chip));
+
+    // Byte 2 = (big << 4) | small; BM1398 has 5 big × 16 small cores
+    for (int b = 0; b < 256; b++) {
+        const int core = (b >> 4) * 16 + (b & 0xF);
+        cy->core_of_byte[b] = core < CORE_YIELD_CORES ? (uint8_t)core : SINK_CORE;
+    }
+}
+
+/**
+ * Address table for a chain (work_timing_addr_table())
+ */
+void core_yield_set_chain(core_yield_t *cy, int chain, int num_chips, int interval) {
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+    if (num_chips > CORE_YIELD_MAX_CHIPS) {
+        num_chips = CORE_YIELD_MAX_CHIPS;
+    }
+
+    work_timing_addr_table(cy->addr_to_chip[chain], num_chips, interval, SINK_CHIP);
+    cy->num_chips[chain] = num_chips > 0 ? num_chips : 0;
+    memset(cy->chip[chain], 0, sizeof(cy->chip[chain]));
+    cy->batch[chain] = 0;
+}
+
+//==============================================================================
+// Accounting
+//==============================================================================
+
+void core_yield_add(core_yield_t *cy, int chain, uint32_t nonce) {
+    if ((unsigned)chain >= MAX_CHAINS) {
+        return;
+    }
+    core_yield_chip_t *chip = &cy->chip[chain][cy->addr_to_chip[chain][nonce >> 24]];
+    chip->batch++;
+    chip->core_batch[cy->core_of_byte[(nonce >> 16) & 0xFF]]++;
+    cy->batch[chain]++;
+}
+
+//==============================================================================
+// Tests
+//==============================================================================
+
+/**
+ * Upper critical value of chi-square with df degrees of freedom
+ * (Wilson-Hilferty approximation, good to ~1% for df > 10)
+ */
+static double chi2_critical(int df) {
+    const double a = 2.0 / (9.0 * df);
+    const double t = 1.0 - a + CORE_YIELD_CHI2_Z * sqrt(a);
+    return df * t * t * t;
+}
+
+static void push_event(core_yield_t *cy, core_yield_event_type_t type, int chain,
+                       int chip, int core, float statistic, float expected,
+                       uint32_t observed) {
+    if (cy->event_count == CORE_YIELD_MAX_EVENTS) {
+        // Full: drop the oldest
+        cy->event_head = (cy->event_head + 1) % CORE_YIELD_MAX_EVENTS;
+        cy->event_count--;
+        cy->events_dropped++;
+    }
+    core_yield_event_t *ev =
+        &cy->events[(cy->event_head + cy->event_count) % CORE_YIELD_MAX_EVENTS];
+    ev->type = type;
+    ev->chain = (uint8_t)chain;
+    ev->chip = (uint8_t)chip;
+    ev->core = (uint8_t)core;
+    ev->statistic = statistic;
+    ev->expected = expected;
+    ev->observed = observed;
+    cy->event_count++;
+}
+
+/**
+ * One step of the lower CUSUM on a Poisson count with mean expected
+ * Returns: updated statistic
+ */
+static float cusum_step(float s, uint32_t observed, float expected) {
+    s += (expected - (float)observed) / sqrtf(expected) - CORE_YIELD_CUSUM_K;
+    return s > 0.0f ? s : 0.0f;
+}
+
+/**
+ * Chip batch: per-core CUSUM and chi-square uniformity across cores
+ */
+static void test_cores(core_yield_t *cy, int chain, int chip_idx) {
+    core_yield_chip_t *chip = &cy->chip[chain][chip_idx];
+    uint32_t total = 0;
+    for (int core = 0; core < CORE_YIELD_CORES; core++) {
+        total += chip->core_batch[core];
+    }
+    if (total < (uint32_t)CORE_YIELD_CORES * CORE_YIELD_MIN_EXPECTED) {
+        return;
+    }
+
+    const float expected = (float)total / CORE_YIELD_CORES;
+    double chi2 = 0.0;
+    for (int core = 0; core < CORE_YIELD_CORES; core++) {
+        const uint32_t observed = chip->core_batch[core];
+        const double d = observed - expected;
+        chi2 += d * d / expected;
+
+        const float s = cusum_step(chip->core_cusum[core], observed, expected);
+        chip->core_cusum[core] = s;
+        if (!chip->core_dead[core] && s > CORE_YIELD_CUSUM_H) {
+            chip->core_dead[core] = 1;
+            push_event(cy, CORE_YIELD_CORE_DEAD, chain, chip_idx, core, s, expected, observed);
+        } else if (chip->core_dead[core] && s == 0.0f) {
+            chip->core_dead[core] = 0;
+            push_event(cy, CORE_YIELD_CORE_RECOVERED, chain, chip_idx, core, s, expected, observed);
+        }
+    }
+
+    chip->core_chi2 = (float)chi2;
+    const bool skewed = chi2 > chi2_critical(CORE_YIELD_CORES - 1);
+    if (skewed != chip->skewed) {
+        chip->skewed = skewed;
+        push_event(cy, skewed ? CORE_YIELD_CHIP_SKEWED : CORE_YIELD_CHIP_UNIFORM,
+                   chain, chip_idx, CORE_YIELD_NO_CORE, (float)chi2, expected, total);
+    }
+
+    chip->core_batches++;
+    memset(chip->core_batch, 0, sizeof(chip->core_batch));
+}
+
+/**
+ * Chain batch: per-chip CUSUM and chi-square across chips
+ */
+static void test_chips(core_yield_t *cy, int chain) {
+    const int chips = cy->num_chips[chain];
+    uint32_t total = 0;
+    for (int c = 0; c < chips; c++) {
+        total += cy->chip[chain][c].batch;
+    }
+    const float expected = (float)total / chips;
+
+    double chi2 = 0.0;
+    for (int c = 0; c < chips; c++) {
+        core_yield_chip_t *chip = &cy->chip[chain][c];
+        const double d = chip->batch - expected;
+        chi2 += d * d / expected;
+
+        const float s = cusum_step(chip->cusum, chip->batch, expected);
+        chip->cusum = s;
+        if (!chip->weak && s > CORE_YIELD_CUSUM_H) {
+            chip->weak = true;
+            push_event(cy, CORE_YIELD_CHIP_WEAK, chain, c, CORE_YIELD_NO_CORE,
+                       s, expected, chip->batch);
+        } else if (chip->weak && s == 0.0f) {
+            chip->weak = false;
+            push_event(cy, CORE_YIELD_CHIP_RECOVERED, chain, c, CORE_YIELD_NO_CORE,
+                       s, expected, chip->batch);
+        }
+        chip->batch = 0;
+    }
+
+    cy->chip_chi2[chain] = (float)chi2;
+    cy->chip_batches[chain]++;
+    cy->chip[chain][SINK_CHIP].batch = 0;
+    cy->batch[chain] = 0;
+}
+
+void core_yield_tick(core_yield_t *cy) {
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const int chips = cy->num_chips[chain];
+        if (chips == 0) {
+            continue;
+        }
+        if (cy->batch[chain] >= (uint32_t)chips * CORE_YIELD_MIN_EXPECTED) {
+            test_chips(cy, chain);
+        }
+        for (int chip = 0; chip < chips; chip++) {
+            test_cores(cy, chain, chip);
+        }
+    }
+}
+
+//==============================================================================
+// Events and Reporting
+//==============================================================================
+
+bool core_yield_next_event(core_yield_t *cy, core_yield_event_t *ev) {
+    if (cy->event_count == 0) {
+        return false;
+    }
+    *ev = cy->events[cy->event_head];
+    cy->event_head = (cy->event_head + 1) % CORE_YIELD_MAX_EVENTS;
+    cy->event_count--;
+    return true;
+}
+
+const char *core_yield_event_name(core_yield_event_type_t type) {
+    switch (type) {
+    case CORE_YIELD_CHIP_WEAK:      return "chip weak";
+    case CORE_YIELD_CHIP_RECOVERED: return "chip recovered";
+    case CORE_YIELD_CHIP_SKEWED:    return "chip cores skewed";
+    case CORE_YIELD_CHIP_UNIFORM:   return "chip cores uniform";
+    case CORE_YIELD_CORE_DEAD:      return "core dead";
+    case CORE_YIELD_CORE_RECOVERED: return "core recovered";
+    }
+    return "unknown";
+}
+
+void core_yield_print(const core_yield_t *cy) {
+    printf("Nonce yield:\n");
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const int chips = cy->num_chips[chain];
+        if (chips == 0) {
+            continue;
+        }
+
+        printf("  Chain %d:", chain);
+        if (cy->chip_batches[chain] == 0) {
+            printf(" collecting (%u/%u nonces)\n", cy->batch[chain],
+                   (uint32_t)chips * CORE_YIELD_MIN_EXPECTED);
+            continue;
+        }
+        const double critical = chips > 1 ? chi2_critical(chips - 1) : 0.0;
+        printf(" %u batches, chip chi2 %.1f (limit %.1f)%s\n",
+               cy->chip_batches[chain], cy->chip_chi2[chain], critical,
+               cy->chip_chi2[chain] > critical ? " NOT UNIFORM" : "");
+
+        for (int c = 0; c < chips; c++) {
+            const core_yield_chip_t *chip = &cy->chip[chain][c];
+            int dead = 0;
+            for (int core = 0; core < CORE_YIELD_CORES; core++) {
+                dead += chip->core_dead[core];
+            }
+            if (!chip->weak && !chip->skewed && dead == 0) {
+                continue;
+            }
+            printf("    Chip %3d:%s%s", c, chip->weak ? " weak" : "",
+                   chip->skewed ? " skewed" : "");
+            if (dead > 0) {
+                printf(" dead cores");
+                for (int core = 0; core < CORE_YIELD_CORES; core++) {
+                    if (chip->core_dead[core]) {
+                        printf(" %d", core);
+                    }
+                }
+            }
+            printf("\n");
+        }
+    }
+    if (cy->events_dropped) {
+        printf("  Events dropped: %u\n", cy->events_dropped);
+    }
+}
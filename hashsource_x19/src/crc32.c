@@ -0,0 +1,28 @@
+/*
+ * CRC-32 Implementation
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/crc32.h"
+
+// Table-driven: pattern bundle payloads are megabytes
+static uint32_t crc32_table[256];
+
+uint32_t crc32_calc(const uint8_t *data, size_t len) {
+    if (crc32_table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int b = 0; b < 8; b++) {
+                c = (c >> 1) ^ (0xEDB88320 & -(c & 1));
+            }
+            crc32_table[i] = c;
+        }
+    }
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ crc32_table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
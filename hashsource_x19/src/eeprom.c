@@ -0,0 +1,356 @@
+/*
+ * Hashboard EEPROM Reader, Decoder and Persistent Cache
+ *
+ * Decoding reverse-engineered from:
+ * - bmminer FUN_00049e8c (I2C), FUN_0001740c (EEPROM parse)
+ * - S19 XP single_board_test xxtea_decode-000879b4.c
+ *
+ * See eeprom_detect.c for the key discovery notes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../include/eeprom.h"
+#include "../include/crc32.h"
+
+//==============================================================================
+// XXTEA Decryption
+//==============================================================================
+
+// XXTEA key extracted from S19 Pro bmminer binary at address 0x7E2AC
+// Source: bmminer-2f464d0989b763718a6fbbdee35424ae, IDA Pro disassembly
+// Key index: 1 (of 4 available keys)
+// ASCII: "uileynimggnagnau"
+// Discovery: Tested all 4 keys via S19 XP single_board_test analysis
+static const uint32_t XXTEA_KEY[4] = {
+    0x656C6975,  // "uile" (little-endian)
+    0x6D696E79,  // "ynim"
+    0x616E6767,  // "ggna"
+    0x75616E67   // "gnau"
+};
+
+#define XXTEA_DELTA             0x9E3779B9      // Golden ratio constant
+#define XXTEA_DELTA_INV         0x61C88647      // -DELTA in unsigned arithmetic
+
+/*
+ * XXTEA Block Cipher Decryption (Corrected Block TEA)
+ *
+ * Algorithm: XXTEA (eXtended Tiny Encryption Algorithm)
+ * Key size: 128 bits (4 × 32-bit words)
+ * Block size: Variable (minimum 64 bits, 2 × 32-bit words)
+ * Rounds: 6 + 52/n (where n = number of 32-bit words)
+ *
+ * Source: S19 XP single_board_test xxtea_decode-000879b4.c
+ * Reference: https://en.wikipedia.org/wiki/XXTEA
+ * Paper: "Correction to XTEA" by Needham and Wheeler (1998)
+ */
+static void xxtea_decrypt(uint32_t * restrict data, size_t len) {
+    const size_t n = len / sizeof(uint32_t);
+    if (n < 2) return;  // Minimum 2 words required
+
+    const uint32_t rounds = 6 + 52 / n;
+    uint32_t sum = rounds * XXTEA_DELTA;
+    uint32_t y = data[0];
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        const uint32_t e = (sum >> 2) & 3;
+
+        // Decrypt in reverse order (end to start)
+        for (size_t p = n - 1; p > 0; p--) {
+            const uint32_t z = data[p - 1];
+            const uint32_t mx = ((z ^ XXTEA_KEY[e ^ (p & 3)]) + (sum ^ y)) ^
+                                ((z >> 5 ^ y << 2) + (z << 4 ^ y >> 3));
+            data[p] -= mx;
+            y = data[p];
+        }
+
+        // Decrypt first element
+        const uint32_t z = data[n - 1];
+        const uint32_t mx = ((z ^ XXTEA_KEY[e]) + (sum ^ y)) ^
+                            ((z >> 5 ^ y << 2) + (z << 4 ^ y >> 3));
+        data[0] -= mx;
+        y = data[0];
+
+        sum += XXTEA_DELTA_INV;  // Equivalent to: sum -= XXTEA_DELTA
+    }
+}
+
+//==============================================================================
+// Raw EEPROM Access
+//==============================================================================
+
+/*
+ * Read a byte range of one chain's EEPROM
+ *
+ * I2C Command Format (32-bit register at 0x030):
+ *   Bits 26-27: Master ID (always 0 for S19 Pro)
+ *   Bits 24-25: Operation (0x3 = read)
+ *   Bits 20-23: Slave address high nibble (0xA)
+ *   Bits 16-19: Byte address bits 8-11 (chain N = 0xN00-0xNFF)
+ *   Bits 8-15:  Byte address bits 0-7
+ *   Bits 0-7:   Response data (after bit 31 set)
+ *
+ * All byte reads are queued at EEPROM priority in one batch, so the
+ * scheduler streams them back to back and PSU/PIC traffic can cut in.
+ */
+static int eeprom_read_range(fpga_i2c_t *bus, int chain, size_t offset,
+                             uint8_t *buffer, size_t size) {
+    fpga_i2c_op_t ops[EEPROM_SIZE];
+
+    if (chain < 0 || chain >= EEPROM_MAX_CHAINS || !buffer ||
+        offset + size > EEPROM_SIZE) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        fpga_i2c_op_eeprom(&ops[i], chain, (uint8_t)(offset + i));
+    }
+    if (fpga_i2c_xfer_batch(bus, ops, size) < 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = ops[i].data;
+    }
+    return 0;
+}
+
+int eeprom_read(fpga_i2c_t *bus, int chain, uint8_t *buffer, size_t size) {
+    return eeprom_read_range(bus, chain, 0, buffer, size);
+}
+
+//==============================================================================
+// EEPROM Parsing
+//==============================================================================
+
+/*
+ * Parse and decrypt EEPROM data
+ *
+ * Structure (Format 3, verified on S19 Pro):
+ *   Byte 0:       0x11 (magic header)
+ *   Byte 1:       Data length (0x4A = 74 bytes or 0x42 = 66 bytes)
+ *   Bytes 2-N:    Encrypted payload (XXTEA)
+ *   Byte 255:     0x5A (trailer marker)
+ *
+ * Decrypted payload (Format 3):
+ *   Offset 0:     Format byte (0x03)
+ *   Offset 1-17:  Serial number (17 bytes ASCII)
+ *   Offset 18-19: Chip die (2 bytes)
+ *   Offset 20-29: Chip marking (10 bytes)
+ *   Offset 33:    Chip bin
+ *   Offset 34-37: FT version (big-endian uint32)
+ *   Offset 45-46: PCB version (big-endian uint16)
+ *   Offset 47-48: BOM version (big-endian uint16)
+ *   Variable offset based on data_len:
+ *     0x42 → offset=5, 0x4A → offset=0
+ *   Offset 56-off: Chip tech (2 bytes)
+ *   Offset 58-off: Voltage raw (big-endian uint16, multiply by 10 for mV)
+ *   Offset 60-off: Frequency (big-endian uint16, MHz)
+ */
+int eeprom_parse(const uint8_t *raw_data, eeprom_info_t *info) {
+    memset(info, 0, sizeof(*info));
+
+    // Validate header
+    if (raw_data[0] != EEPROM_HEADER) {
+        fprintf(stderr, "Error: Invalid EEPROM header: 0x%02X\n", raw_data[0]);
+        return -1;
+    }
+
+    const uint8_t data_len = raw_data[1];
+    if (data_len < 2 || data_len > 250) {
+        fprintf(stderr, "Error: Invalid data length: %u\n", data_len);
+        return -1;
+    }
+
+    // Decrypt payload (XXTEA requires 8-byte alignment)
+    const size_t enc_len = (data_len + 5) & ~7;
+    uint32_t decrypted[64] = {0};
+    memcpy(decrypted, &raw_data[2], enc_len);
+    xxtea_decrypt(decrypted, enc_len);
+
+    // Parse fields
+    const uint8_t *payload = (const uint8_t *)decrypted;
+
+    // Variable offset for chip_tech/voltage/frequency fields
+    const int var_offset = (data_len == 0x42) ? 5 : 0;
+
+    // Header version (format byte)
+    info->header_version = payload[0];
+
+    // Board serial number: 17 bytes ASCII at offset 1-17
+    memcpy(info->board_serial_no, &payload[1], 17);
+    info->board_serial_no[17] = '\0';
+
+    // Chip die: 2 bytes at offset 18-19
+    memcpy(info->chip_die, &payload[18], 2);
+    info->chip_die[2] = '\0';
+
+    // Chip marking: 10 bytes at offset 20-29
+    memcpy(info->chip_marking, &payload[20], 10);
+    info->chip_marking[10] = '\0';
+
+    // Chip bin: 1 byte at offset 33
+    info->chip_bin = payload[33];
+
+    // FT version: 4 bytes at offset 34-37 (big-endian u32)
+    info->ft_version = ((uint32_t)payload[34] << 24) |
+                       ((uint32_t)payload[35] << 16) |
+                       ((uint32_t)payload[36] << 8) |
+                       ((uint32_t)payload[37]);
+
+    // PCB version: 2 bytes at offset 45-46 (big-endian u16)
+    info->pcb_version = (payload[45] << 8) | payload[46];
+
+    // BOM version: 2 bytes at offset 47-48 (big-endian u16)
+    info->bom_version = (payload[47] << 8) | payload[48];
+
+    // Default frequency: 2 bytes at offset (58 - var_offset), big-endian
+    // This is a DIRECT value in MHz (e.g., 525 = 525 MHz), NOT a lookup table index
+    // Bitmain's bmminer reads this at offset 0x23 and prints "min freq in eeprom = %d"
+    const int freq_offset = 58 - var_offset;
+    info->default_freq = (payload[freq_offset] << 8) | payload[freq_offset + 1];
+
+    info->valid = true;
+    return 0;
+}
+
+//==============================================================================
+// Persistent Cache
+//==============================================================================
+
+// On-disk layout (native endianness, only ever read back on the same board)
+typedef struct {
+    uint8_t valid;
+    uint8_t fingerprint[EEPROM_FINGERPRINT_LEN];
+    eeprom_info_t info;
+} eeprom_cache_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    eeprom_cache_entry_t entries[EEPROM_MAX_CHAINS];
+    uint32_t crc;               // CRC-32 of all preceding bytes
+} eeprom_cache_file_t;
+
+/**
+ * Load and validate cache file
+ * Returns: 0 on success, -1 if missing, truncated or corrupt
+ */
+static int cache_read(const char *path, eeprom_cache_file_t *cache) {
+    memset(cache, 0, sizeof(*cache));
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    const ssize_t n = read(fd, cache, sizeof(*cache));
+    close(fd);
+
+    if (n != (ssize_t)sizeof(*cache) ||
+        cache->magic != EEPROM_CACHE_MAGIC ||
+        cache->version != EEPROM_CACHE_VERSION ||
+        cache->crc != crc32_calc((const uint8_t *)cache,
+                                 offsetof(eeprom_cache_file_t, crc))) {
+        fprintf(stderr, "Warning: Ignoring invalid EEPROM cache %s\n", path);
+        memset(cache, 0, sizeof(*cache));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Write cache file atomically (temp file + rename)
+ */
+static int cache_write(const char *path, eeprom_cache_file_t *cache) {
+    char tmp_path[256];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    cache->magic = EEPROM_CACHE_MAGIC;
+    cache->version = EEPROM_CACHE_VERSION;
+    cache->crc = crc32_calc((const uint8_t *)cache,
+                            offsetof(eeprom_cache_file_t, crc));
+
+    const int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Warning: Cannot write EEPROM cache %s: %s\n",
+                tmp_path, strerror(errno));
+        return -1;
+    }
+    const ssize_t n = write(fd, cache, sizeof(*cache));
+    fsync(fd);
+    close(fd);
+
+    if (n != (ssize_t)sizeof(*cache) || rename(tmp_path, path) < 0) {
+        fprintf(stderr, "Warning: Failed to update EEPROM cache %s\n", path);
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int eeprom_cache_store(const char *cache_path, int chain,
+                       const uint8_t *raw_data, const eeprom_info_t *info) {
+    eeprom_cache_file_t cache;
+
+    if (!cache_path || chain < 0 || chain >= EEPROM_MAX_CHAINS || !info->valid) {
+        return -1;
+    }
+
+    cache_read(cache_path, &cache);   // Start from scratch if missing/corrupt
+
+    eeprom_cache_entry_t *entry = &cache.entries[chain];
+    memset(entry, 0, sizeof(*entry));
+    entry->valid = 1;
+    memcpy(entry->fingerprint, raw_data, EEPROM_FINGERPRINT_LEN);
+    entry->info = *info;
+
+    return cache_write(cache_path, &cache);
+}
+
+/**
+ * Load decoded EEPROM info for one chain
+ *
+ * Reads the fingerprint bytes first. If they match the cached entry the
+ * cached info is returned (16 I2C transactions instead of 256); otherwise
+ * the rest of the EEPROM is read, decoded and, if update_cache is set,
+ * written back to the cache.
+ */
+int eeprom_load(fpga_i2c_t *bus, int chain, eeprom_info_t *info,
+                const char *cache_path, bool update_cache) {
+    uint8_t raw[EEPROM_SIZE];
+    eeprom_cache_file_t cache;
+
+    if (eeprom_read_range(bus, chain, 0, raw, EEPROM_FINGERPRINT_LEN) < 0) {
+        return -1;
+    }
+
+    if (cache_path && cache_read(cache_path, &cache) == 0) {
+        const eeprom_cache_entry_t *entry = &cache.entries[chain];
+        if (entry->valid && entry->info.valid &&
+            memcmp(entry->fingerprint, raw, EEPROM_FINGERPRINT_LEN) == 0) {
+            *info = entry->info;
+            return EEPROM_LOAD_CACHED;
+        }
+    }
+
+    // Cache miss: fetch the remainder and decode
+    if (eeprom_read_range(bus, chain, EEPROM_FINGERPRINT_LEN,
+                          raw + EEPROM_FINGERPRINT_LEN,
+                          EEPROM_SIZE - EEPROM_FINGERPRINT_LEN) < 0) {
+        return -1;
+    }
+    if (eeprom_parse(raw, info) < 0) {
+        return -1;
+    }
+
+    if (cache_path && update_cache) {
+        eeprom_cache_store(cache_path, chain, raw, info);
+    }
+    return EEPROM_LOAD_FULL;
+}
@@ -0,0 +1,213 @@
+/*
+ * Closed-Loop Fan Controller Implementation
+ *
+ * PWM register format from stock firmware (see fan_test.c).
+ * Tach scaling from bmminer api stats: "fan": [5640, 5520, 4800, 4800]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "../include/fan_control.h"
+
+static const char *CHANNEL_NAMES[FAN_NUM_CHANNELS] = { "main", "alt" };
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void write_pwm(fan_control_t *fc, fan_channel_t ch, int pct) {
+    const int reg = (ch == FAN_CH_MAIN) ? FAN_REG_PWM_MAIN : FAN_REG_PWM_ALT;
+    fc->regs[reg] = FAN_PWM_VALUE(pct);
+    __sync_synchronize();
+}
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+/**
+ * Initialize controller with default gains; fans start at full speed and
+ * are slewed down once temperatures are available.
+ */
+void fan_control_init(fan_control_t *fc, volatile uint32_t *regs) {
+    memset(fc, 0, sizeof(*fc));
+    fc->regs = regs;
+
+    const fan_pid_config_t defaults = {
+        .setpoint_c = FAN_DEFAULT_SETPOINT_C,
+        .kp = FAN_DEFAULT_KP,
+        .ki = FAN_DEFAULT_KI,
+        .kd = FAN_DEFAULT_KD,
+        .min_pct = FAN_DEFAULT_MIN_PCT,
+        .max_pct = FAN_DEFAULT_MAX_PCT,
+        .slew_pct_s = FAN_DEFAULT_SLEW_PCT_S,
+    };
+
+    for (int ch = 0; ch < FAN_NUM_CHANNELS; ch++) {
+        fan_control_set_config(fc, ch, &defaults);
+        write_pwm(fc, ch, (int)fc->ch[ch].output);
+    }
+}
+
+void fan_control_set_config(fan_control_t *fc, fan_channel_t ch,
+                            const fan_pid_config_t *cfg) {
+    if (ch < 0 || ch >= FAN_NUM_CHANNELS) {
+        return;
+    }
+
+    fan_channel_state_t *s = &fc->ch[ch];
+    s->cfg = *cfg;
+    if (s->cfg.max_pct > 100) s->cfg.max_pct = 100;
+    if (s->cfg.min_pct < 0) s->cfg.min_pct = 0;
+    if (s->cfg.min_pct > s->cfg.max_pct) s->cfg.min_pct = s->cfg.max_pct;
+
+    s->integral = 0.0f;
+    s->primed = false;
+    s->output = (float)s->cfg.max_pct;
+}
+
+//==============================================================================
+// Tachometer
+//==============================================================================
+
+/**
+ * Read FAN_SPEED once; the FPGA rotates through the fans on successive reads
+ */
+void fan_control_sample_tach(fan_control_t *fc) {
+    const uint32_t v = fc->regs[FAN_REG_TACH];
+    const int id = FAN_TACH_ID(v);
+
+    if (id < FAN_NUM) {
+        fc->rpm[id] = FAN_TACH_COUNT(v) * FAN_RPM_PER_COUNT;
+        fc->rpm_update_ms[id] = now_ms();
+    }
+}
+
+/**
+ * Stall check: every fan on the channel must report at least FAN_STALL_RPM
+ * while the channel is driven at FAN_STALL_MIN_PCT or more
+ */
+static void check_stall(fan_control_t *fc, fan_channel_t ch, uint64_t now) {
+    fan_channel_state_t *s = &fc->ch[ch];
+    bool low = false;
+
+    if (s->output >= FAN_STALL_MIN_PCT) {
+        for (int i = 0; i < FAN_PER_CHANNEL; i++) {
+            const int fan = ch * FAN_PER_CHANNEL + i;
+            if (now - fc->rpm_update_ms[fan] > FAN_TACH_STALE_MS ||
+                fc->rpm[fan] < FAN_STALL_RPM) {
+                low = true;
+            }
+        }
+    }
+
+    if (!low) {
+        if (s->stalled) {
+            printf("Fan channel %s recovered\n", CHANNEL_NAMES[ch]);
+        }
+        s->low_rpm_since_ms = 0;
+        s->stalled = false;
+        return;
+    }
+
+    if (s->low_rpm_since_ms == 0) {
+        s->low_rpm_since_ms = now;
+    } else if (!s->stalled && now - s->low_rpm_since_ms >= FAN_STALL_TIME_MS) {
+        s->stalled = true;
+        fprintf(stderr, "Warning: Fan channel %s stalled (rpm %d/%d)\n",
+                CHANNEL_NAMES[ch], fc->rpm[ch * FAN_PER_CHANNEL],
+                fc->rpm[ch * FAN_PER_CHANNEL + 1]);
+    }
+}
+
+//==============================================================================
+// Control Loop
+//==============================================================================
+
+/**
+ * PID step for one channel
+ *
+ * - Derivative on measurement (no kick on setpoint change)
+ * - Conditional integration: the integral only grows when the output is not
+ *   saturated in the direction of the error (anti-windup)
+ * - Returns the unclamped-by-slew target percent
+ */
+static float pid_step(fan_channel_state_t *s, float temp_c, float dt) {
+    const fan_pid_config_t *c = &s->cfg;
+    const float error = temp_c - c->setpoint_c;
+
+    float deriv = 0.0f;
+    if (s->primed && dt > 0.0f) {
+        deriv = c->kd * (temp_c - s->prev_temp) / dt;
+    }
+    s->prev_temp = temp_c;
+    s->primed = true;
+
+    const float p = c->kp * error;
+    const float i_next = s->integral + c->ki * error * dt;
+    const float u = p + i_next + deriv;
+
+    const bool sat_high = u > c->max_pct && error > 0.0f;
+    const bool sat_low = u < c->min_pct && error < 0.0f;
+    if (!sat_high && !sat_low) {
+        s->integral = clampf(i_next, -(float)c->max_pct, (float)c->max_pct);
+    }
+
+    return clampf(p + s->integral + deriv, (float)c->min_pct, (float)c->max_pct);
+}
+
+void fan_control_update(fan_control_t *fc, float temp_c, bool temp_valid) {
+    const uint64_t now = now_ms();
+    const float dt = fc->last_update_ms ? (now - fc->last_update_ms) / 1000.0f : 0.0f;
+    fc->last_update_ms = now;
+
+    if (fc->failsafe != !temp_valid) {
+        fc->failsafe = !temp_valid;
+        if (fc->failsafe) {
+            fprintf(stderr, "Warning: Temperature unavailable, fans to full speed\n");
+        }
+    }
+
+    for (int ch = 0; ch < FAN_NUM_CHANNELS; ch++) {
+        check_stall(fc, ch, now);
+    }
+
+    for (int ch = 0; ch < FAN_NUM_CHANNELS; ch++) {
+        fan_channel_state_t *s = &fc->ch[ch];
+        const bool other_stalled = fc->ch[ch ^ 1].stalled;
+
+        if (fc->failsafe || other_stalled) {
+            // Emergency: jump straight to max, no slew limit
+            s->output = (float)s->cfg.max_pct;
+            s->primed = false;
+        } else {
+            const float target = pid_step(s, temp_c, dt);
+            const float max_step = s->cfg.slew_pct_s * dt;
+            s->output += clampf(target - s->output, -max_step, max_step);
+        }
+
+        write_pwm(fc, ch, (int)(s->output + 0.5f));
+    }
+}
+
+void fan_control_print(const fan_control_t *fc) {
+    for (int ch = 0; ch < FAN_NUM_CHANNELS; ch++) {
+        const fan_channel_state_t *s = &fc->ch[ch];
+        const int f0 = ch * FAN_PER_CHANNEL;
+        printf("  Fan %-4s: %3d%% (setpoint %.1f C) rpm %d/%d%s%s\n",
+               CHANNEL_NAMES[ch], (int)(s->output + 0.5f), s->cfg.setpoint_c,
+               fc->rpm[f0], fc->rpm[f0 + 1],
+               s->stalled ? " STALLED" : "",
+               fc->failsafe ? " FAILSAFE" : "");
+    }
+}
@@ -14,6 +14,7 @@
 #include <string.h>
 #include <errno.h>
 #include <signal.h>
+#include "../include/fpga_service.h"
 
 #define AXI_DEVICE      "/dev/axi_fpga_dev"
 #define AXI_SIZE        0x1200
@@ -22,6 +23,7 @@
 
 static volatile uint32_t *regs = NULL;
 static int fd = -1;
+static int owner_fd = -1;
 static volatile int g_shutdown = 0;
 
 void signal_handler(int sig) {
@@ -33,9 +35,16 @@ void signal_handler(int sig) {
 int fpga_init(void) {
     printf("Opening %s...\n", AXI_DEVICE);
 
+    owner_fd = fpga_service_claim("fan_test");
+    if (owner_fd < 0) {
+        return -1;
+    }
+
     fd = open(AXI_DEVICE, O_RDWR | O_SYNC);
     if (fd < 0) {
         fprintf(stderr, "Failed to open %s: %s\n", AXI_DEVICE, strerror(errno));
+        fpga_service_release(owner_fd);
+        owner_fd = -1;
         return -1;
     }
 
@@ -43,6 +52,8 @@ int fpga_init(void) {
     if (regs == MAP_FAILED) {
         fprintf(stderr, "Failed to mmap: %s\n", strerror(errno));
         close(fd);
+        fpga_service_release(owner_fd);
+        owner_fd = -1;
         return -1;
     }
 
@@ -57,6 +68,7 @@ void fpga_close(void) {
     if (fd >= 0) {
         close(fd);
     }
+    fpga_service_release(owner_fd);
 }
 
 // Set fan speed using stock firmware format
@@ -0,0 +1,281 @@
+/*
+ * FPGA Service Client Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "../include/fpga_client.h"
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+static void futex_wake(uint32_t *addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static void futex_wait(uint32_t *addr, uint32_t val, uint32_t timeout_ms) {
+    const struct timespec ts = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_nsec = (long)(timeout_ms % 1000) * 1000000L,
+    };
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static bool pid_alive(uint32_t pid) {
+    return pid != 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+}
+
+static bool owner_alive(const fpga_client_t *cl) {
+    return __atomic_load_n(&cl->shm->magic, __ATOMIC_ACQUIRE) == FPGA_SERVICE_MAGIC &&
+           cl->shm->owner_pid == cl->owner_pid && pid_alive(cl->owner_pid);
+}
+
+/**
+ * Wait until the owner has answered every command before position `target`
+ * Returns: 0, or -1 if the owner went away or did not answer in time
+ */
+static int wait_done(fpga_client_t *cl, uint32_t target) {
+    fpga_service_slot_t *slot = cl->slot;
+    const uint64_t deadline = now_ms() + FPGA_CLIENT_TIMEOUT_MS;
+
+    for (int spin = 0;; spin++) {
+        const uint32_t done = __atomic_load_n(&slot->done, __ATOMIC_ACQUIRE);
+        if ((int32_t)(done - target) >= 0) {
+            return 0;
+        }
+        if (spin < FPGA_CLIENT_SPIN) {
+            continue;
+        }
+
+        if (!owner_alive(cl)) {
+            fprintf(stderr, "Error: FPGA owner (pid %u) has exited\n", cl->owner_pid);
+            return -1;
+        }
+        if (now_ms() > deadline) {
+            fprintf(stderr, "Error: FPGA owner (pid %u) did not answer\n", cl->owner_pid);
+            return -1;
+        }
+
+        // Pairs with the owner storing `done` before it checks `waiting`
+        __atomic_store_n(&slot->waiting, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&slot->done, __ATOMIC_SEQ_CST) == done) {
+            futex_wait(&slot->done, done, FPGA_CLIENT_SLEEP_MS);
+        }
+        __atomic_store_n(&slot->waiting, 0, __ATOMIC_RELAXED);
+    }
+}
+
+//==============================================================================
+// Connection
+//==============================================================================
+
+int fpga_client_open(fpga_client_t *cl) {
+    memset(cl, 0, sizeof(*cl));
+
+    const int fd = shm_open(FPGA_SERVICE_SHM, O_RDWR, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: No FPGA owner is serving (start hashsource_miner or fpgad)\n");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(fpga_service_shm_t)) {
+        fprintf(stderr, "Error: %s is not an FPGA service segment\n", FPGA_SERVICE_SHM);
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, sizeof(fpga_service_shm_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    cl->shm = base;
+    cl->owner_pid = cl->shm->owner_pid;
+    if (cl->shm->version != FPGA_SERVICE_VERSION || !owner_alive(cl)) {
+        fprintf(stderr, "Error: No FPGA owner is serving (stale segment)\n");
+        fpga_client_close(cl);
+        return -1;
+    }
+
+    // Take a free slot, or one whose client died without closing it
+    const uint32_t self = (uint32_t)getpid();
+    for (int s = 0; s < FPGA_SERVICE_CLIENTS && !cl->slot; s++) {
+        uint32_t pid = __atomic_load_n(&cl->shm->slot[s].pid, __ATOMIC_ACQUIRE);
+        if ((pid == 0 || !pid_alive(pid)) &&
+            __atomic_compare_exchange_n(&cl->shm->slot[s].pid, &pid, self, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            cl->slot = &cl->shm->slot[s];
+        }
+    }
+    if (!cl->slot) {
+        fprintf(stderr, "Error: All %d FPGA client slots are in use\n", FPGA_SERVICE_CLIENTS);
+        fpga_client_close(cl);
+        return -1;
+    }
+
+    // Commands a dead client left in flight are answered before ours
+    cl->head = __atomic_load_n(&cl->slot->head, __ATOMIC_ACQUIRE);
+    cl->tail = cl->head;
+    cl->slot->waiting = 0;
+    if (wait_done(cl, cl->head) < 0) {
+        fpga_client_close(cl);
+        return -1;
+    }
+    return 0;
+}
+
+void fpga_client_close(fpga_client_t *cl) {
+    if (cl->slot) {
+        __atomic_store_n(&cl->slot->pid, 0, __ATOMIC_RELEASE);
+        cl->slot = NULL;
+    }
+    if (cl->shm) {
+        munmap(cl->shm, sizeof(fpga_service_shm_t));
+        cl->shm = NULL;
+    }
+}
+
+//==============================================================================
+// Commands
+//==============================================================================
+
+int fpga_client_submit(fpga_client_t *cl, const fpga_cmd_t *cmd) {
+    if (cl->head - cl->tail == FPGA_SERVICE_RING) {
+        return -1;
+    }
+
+    fpga_cmd_t *entry = &cl->slot->cmd[cl->head % FPGA_SERVICE_RING];
+    *entry = *cmd;
+    entry->status = -EINPROGRESS;
+    entry->result = 0;
+    cl->head++;
+
+    // Pairs with fpga_service_wait(): ring only an owner that went to sleep
+    __atomic_store_n(&cl->slot->head, cl->head, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&cl->shm->sleeping, __ATOMIC_SEQ_CST)) {
+        __atomic_add_fetch(&cl->shm->doorbell, 1, __ATOMIC_SEQ_CST);
+        futex_wake(&cl->shm->doorbell);
+    }
+    return 0;
+}
+
+int fpga_client_wait(fpga_client_t *cl, fpga_cmd_t *reply) {
+    if (cl->tail == cl->head || wait_done(cl, cl->tail + 1) < 0) {
+        return -1;
+    }
+    *reply = cl->slot->cmd[cl->tail % FPGA_SERVICE_RING];
+    cl->tail++;
+    return 0;
+}
+
+int fpga_client_call(fpga_client_t *cl, fpga_cmd_t *cmd) {
+    if (fpga_client_submit(cl, cmd) < 0 || fpga_client_wait(cl, cmd) < 0) {
+        return -EIO;
+    }
+    return cmd->status;
+}
+
+int fpga_client_read_reg(fpga_client_t *cl, uint32_t addr, uint32_t *value) {
+    fpga_cmd_t cmd = { .op = FPGA_CMD_READ_REG, .addr = addr };
+    const int status = fpga_client_call(cl, &cmd);
+    *value = cmd.result;
+    return status;
+}
+
+int fpga_client_write_reg(fpga_client_t *cl, uint32_t addr, uint32_t value) {
+    fpga_cmd_t cmd = { .op = FPGA_CMD_WRITE_REG, .addr = addr, .value = value };
+    return fpga_client_call(cl, &cmd);
+}
+
+/**
+ * Run a batch with the ring kept full
+ * Each entry of cmds is replaced by its reply, status included.
+ */
+int fpga_client_call_batch(fpga_client_t *cl, fpga_cmd_t *cmds, int count) {
+    int sent = 0;
+    for (int got = 0; got < count; got++) {
+        while (sent < count && fpga_client_submit(cl, &cmds[sent]) == 0) {
+            sent++;
+        }
+        if (fpga_client_wait(cl, &cmds[got]) < 0) {
+            return -EIO;
+        }
+    }
+    return FPGA_CMD_OK;
+}
+
+//==============================================================================
+// Stats
+//==============================================================================
+
+/**
+ * Copy one stat ring entry, retrying while the owner rewrites it
+ * Returns: true on a consistent copy of the snapshot numbered `index`
+ */
+static bool read_stat(const fpga_client_t *cl, uint32_t index, fpga_stat_t *stat) {
+    const fpga_stat_t *e = &cl->shm->stat[index % FPGA_SERVICE_STAT_RING];
+
+    for (int tries = 0; tries < 100; tries++) {
+        const uint32_t seq = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(stat, e, sizeof(*stat));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) != seq) {
+            continue;
+        }
+        // Still the snapshot asked for, not one a lap later
+        return __atomic_load_n(&cl->shm->stat_head, __ATOMIC_ACQUIRE) - index <=
+               FPGA_SERVICE_STAT_RING;
+    }
+    return false;
+}
+
+int fpga_client_latest_stat(fpga_client_t *cl, fpga_stat_t *stat) {
+    // A miss means the owner published meanwhile; the next entry is newer
+    for (int tries = 0; tries < FPGA_SERVICE_STAT_RING; tries++) {
+        const uint32_t head = __atomic_load_n(&cl->shm->stat_head, __ATOMIC_ACQUIRE);
+        if (head == 0) {
+            return 0;
+        }
+        if (read_stat(cl, head - 1, stat)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int fpga_client_next_stat(fpga_client_t *cl, uint32_t *cursor, fpga_stat_t *stat) {
+    for (;;) {
+        const uint32_t head = __atomic_load_n(&cl->shm->stat_head, __ATOMIC_ACQUIRE);
+        if (head - *cursor > FPGA_SERVICE_STAT_RING) {
+            *cursor = head - FPGA_SERVICE_STAT_RING;
+        }
+        if (*cursor == head) {
+            return 0;
+        }
+        if (read_stat(cl, *cursor, stat)) {
+            (*cursor)++;
+            return 1;
+        }
+        (*cursor)++;
+    }
+}
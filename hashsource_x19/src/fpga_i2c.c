@@ -0,0 +1,442 @@
+/*
+ * FPGA I2C Transaction Scheduler Implementation
+ *
+ * Command encodings reverse-engineered from:
+ * - Bitmain single_board_test i2c_write-001ca624.c (PIC)
+ * - bmminer exec_power_cmd / i2c_write_reg / wait4i2c_ready (PSU)
+ * - bmminer FUN_00049e8c (EEPROM)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "../include/fpga_i2c.h"
+
+//==============================================================================
+// Slave Addressing
+//==============================================================================
+
+// PSU (APW12) lives behind I2C master 1
+#define PSU_I2C_MASTER      1
+#define PSU_I2C_SLAVE_HIGH  0x02
+#define PSU_I2C_SLAVE_LOW   0x00
+
+// PIC slave address = (chain << 1) | (0x04 << 4), behind master 0
+#define PIC_I2C_MASTER      0
+#define PIC_I2C_SLAVE_HIGH  0x04
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//==============================================================================
+// Transaction Builders
+//==============================================================================
+
+/**
+ * PSU register access
+ * Completion: status bits [31:30] == 0b10 (data ready)
+ */
+void fpga_i2c_op_psu(fpga_i2c_op_t *op, uint8_t reg, uint8_t data, bool read) {
+    memset(op, 0, sizeof(*op));
+
+    op->cmd = (PSU_I2C_MASTER << 26) |
+              (PSU_I2C_SLAVE_HIGH << 20) |
+              ((PSU_I2C_SLAVE_LOW & 0x0E) << 15) |
+              FPGA_I2C_REGADDR_VALID | ((uint32_t)reg << 8);
+    op->cmd |= read ? (FPGA_I2C_READ_OP | FPGA_I2C_READ_1BYTE) : data;
+    op->done_mask = FPGA_I2C_STATUS_MASK;
+    op->done_value = FPGA_I2C_DATA_READY;
+    op->prio = FPGA_I2C_PRIO_PSU;
+}
+
+/**
+ * PIC byte access (no register address phase)
+ *
+ * Based on factory test i2c_write-001ca624.c line 46:
+ * fpga_write(0xc, (slave_addr >> 4) << 0x14 | master << 0x1a |
+ *                 ((slave_addr << 0x1c) >> 0x1d) << 0x10 | data)
+ */
+void fpga_i2c_op_pic(fpga_i2c_op_t *op, int chain, uint8_t data, bool read) {
+    memset(op, 0, sizeof(*op));
+
+    uint8_t slave_addr = (uint8_t)((chain << 1) | (PIC_I2C_SLAVE_HIGH << 4));
+    op->cmd = (PIC_I2C_MASTER << 26) |
+              ((uint32_t)(slave_addr >> 4) << 20) |
+              ((uint32_t)(slave_addr & 0x0E) << 15);
+    op->cmd |= read ? (FPGA_I2C_READ_OP | FPGA_I2C_READ_1BYTE) : data;
+    op->done_mask = FPGA_I2C_STATUS_MASK;
+    op->done_value = FPGA_I2C_DATA_READY;
+    op->prio = FPGA_I2C_PRIO_PIC;
+}
+
+/**
+ * EEPROM byte read
+ *
+ * All chains share slave 0xA0; the 12-bit byte address selects the chain
+ * (chain N occupies 0xN00-0xNFF).
+ * Completion: bit 31 set (data ready)
+ */
+void fpga_i2c_op_eeprom(fpga_i2c_op_t *op, int chain, uint8_t addr) {
+    memset(op, 0, sizeof(*op));
+
+    uint16_t byte_addr = (uint16_t)((chain << 8) + addr);
+    op->cmd = FPGA_I2C_EEPROM_READ |
+              ((FPGA_I2C_EEPROM_SLAVE >> 4) << 20) |
+              (((byte_addr >> 8) & 0xF) << 16) |
+              ((byte_addr & 0xFF) << 8);
+    op->done_mask = FPGA_I2C_READY;
+    op->done_value = FPGA_I2C_READY;
+    op->prio = FPGA_I2C_PRIO_EEPROM;
+}
+
+//==============================================================================
+// Controller Access (worker thread only)
+//==============================================================================
+
+static int i2c_poll(volatile uint32_t *regs, uint32_t mask, uint32_t value,
+                    uint32_t *last) {
+    uint64_t deadline = now_ns() + (uint64_t)FPGA_I2C_TIMEOUT_MS * 1000000ULL;
+
+    for (;;) {
+        uint32_t val = regs[FPGA_I2C_REG];
+        if ((val & mask) == value) {
+            *last = val;
+            return 0;
+        }
+        if (now_ns() > deadline) {
+            return -1;
+        }
+        usleep(FPGA_I2C_POLL_US);
+    }
+}
+
+static int i2c_execute(volatile uint32_t *regs, fpga_i2c_op_t *op) {
+    uint32_t val;
+
+    if (i2c_poll(regs, FPGA_I2C_READY, FPGA_I2C_READY, &val) < 0) {
+        return -1;
+    }
+
+    regs[FPGA_I2C_REG] = op->cmd;
+    __sync_synchronize();
+
+    if (i2c_poll(regs, op->done_mask, op->done_value, &val) < 0) {
+        return -1;
+    }
+
+    op->data = (uint8_t)(val & 0xFF);
+    return 0;
+}
+
+//==============================================================================
+// Worker Thread
+//==============================================================================
+
+static fpga_i2c_op_t *queue_pop(fpga_i2c_t *bus) {
+    for (int p = 0; p < FPGA_I2C_NUM_PRIO; p++) {
+        if (bus->count[p] > 0) {
+            fpga_i2c_op_t *op = bus->queue[p][bus->head[p]];
+            bus->head[p] = (bus->head[p] + 1) % FPGA_I2C_QUEUE_DEPTH;
+            bus->count[p]--;
+            return op;
+        }
+    }
+    return NULL;
+}
+
+// Caller holds bus->lock
+static void record_op(fpga_i2c_t *bus, const fpga_i2c_op_t *op, uint64_t start,
+                      uint64_t end, int status) {
+    uint64_t wait = start - op->submit_ns;
+    fpga_i2c_stats_t *st = &bus->stats;
+    st->ops[op->prio]++;
+    st->wait_ns_total[op->prio] += wait;
+    if (wait > st->wait_ns_max[op->prio]) {
+        st->wait_ns_max[op->prio] = wait;
+    }
+    st->busy_ns += end - start;
+    if (status < 0) {
+        st->errors[op->prio]++;
+    }
+}
+
+static void *i2c_worker(void *arg) {
+    fpga_i2c_t *bus = arg;
+
+    pthread_mutex_lock(&bus->lock);
+    for (;;) {
+        fpga_i2c_op_t *op;
+        while ((op = queue_pop(bus)) == NULL && bus->running) {
+            pthread_cond_wait(&bus->work_cv, &bus->lock);
+        }
+        if (!op) {
+            break;
+        }
+
+        // A queue slot was freed; wake submitters blocked on a full queue
+        pthread_cond_broadcast(&bus->done_cv);
+
+        // The frame runs to its end or its first failure; later ops are
+        // failed without going on the wire. A batch that already failed
+        // skips its remaining frames the same way.
+        int status = (op->batch_failed && *op->batch_failed) ? -1 : 0;
+        for (size_t i = 0; i < op->frame_len; i++) {
+            fpga_i2c_op_t *cur = &op[i];
+            const bool run = status == 0;
+            pthread_mutex_unlock(&bus->lock);
+
+            uint64_t start = now_ns();
+            if (run) {
+                status = i2c_execute(bus->regs, cur);
+            }
+            uint64_t end = now_ns();
+
+            pthread_mutex_lock(&bus->lock);
+            if (run) {
+                record_op(bus, cur, start, end, status);
+            }
+            if (status < 0 && op->batch_failed) {
+                *op->batch_failed = true;
+            }
+            cur->status = status;
+            cur->done = true;
+            pthread_cond_broadcast(&bus->done_cv);
+        }
+    }
+    pthread_mutex_unlock(&bus->lock);
+
+    return NULL;
+}
+
+//==============================================================================
+// Public API
+//==============================================================================
+
+int fpga_i2c_init(fpga_i2c_t *bus, volatile uint32_t *regs) {
+    if (!bus || !regs) {
+        return -1;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->regs = regs;
+    bus->start_ns = now_ns();
+    bus->running = true;
+
+    pthread_mutex_init(&bus->lock, NULL);
+    pthread_cond_init(&bus->work_cv, NULL);
+    pthread_cond_init(&bus->done_cv, NULL);
+
+    if (pthread_create(&bus->thread, NULL, i2c_worker, bus) != 0) {
+        fprintf(stderr, "Error: Failed to start I2C scheduler thread\n");
+        bus->running = false;
+        pthread_cond_destroy(&bus->done_cv);
+        pthread_cond_destroy(&bus->work_cv);
+        pthread_mutex_destroy(&bus->lock);
+        bus->regs = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Stop the scheduler
+ * Ops already queued are executed before the worker exits.
+ */
+void fpga_i2c_cleanup(fpga_i2c_t *bus) {
+    if (!bus || !bus->regs) {
+        return;
+    }
+
+    pthread_mutex_lock(&bus->lock);
+    bus->running = false;
+    pthread_cond_signal(&bus->work_cv);
+    pthread_mutex_unlock(&bus->lock);
+
+    pthread_join(bus->thread, NULL);
+
+    pthread_cond_destroy(&bus->done_cv);
+    pthread_cond_destroy(&bus->work_cv);
+    pthread_mutex_destroy(&bus->lock);
+    bus->regs = NULL;
+}
+
+/**
+ * Queue ops[0..len-1] as one frame at ops[0]'s priority
+ * Blocks only while that priority queue is full.
+ */
+static int queue_frame(fpga_i2c_t *bus, fpga_i2c_op_t *ops, size_t len,
+                       bool *batch_failed) {
+    if (!bus || !bus->regs || !ops || len == 0 || ops[0].prio >= FPGA_I2C_NUM_PRIO) {
+        return -1;
+    }
+
+    int p = ops[0].prio;
+    for (size_t i = 0; i < len; i++) {
+        ops[i].done = false;
+        ops[i].status = -1;
+    }
+    ops[0].frame_len = len;
+    ops[0].batch_failed = batch_failed;
+
+    pthread_mutex_lock(&bus->lock);
+    while (bus->count[p] == FPGA_I2C_QUEUE_DEPTH && bus->running) {
+        pthread_cond_wait(&bus->done_cv, &bus->lock);
+    }
+    if (!bus->running) {
+        pthread_mutex_unlock(&bus->lock);
+        return -1;
+    }
+
+    const uint64_t submit_ns = now_ns();
+    for (size_t i = 0; i < len; i++) {
+        ops[i].submit_ns = submit_ns;
+    }
+    unsigned int tail = (bus->head[p] + bus->count[p]) % FPGA_I2C_QUEUE_DEPTH;
+    bus->queue[p][tail] = ops;
+    bus->count[p]++;
+    pthread_cond_signal(&bus->work_cv);
+    pthread_mutex_unlock(&bus->lock);
+
+    return 0;
+}
+
+/**
+ * Queue a transaction (blocks only while its priority queue is full)
+ */
+int fpga_i2c_submit(fpga_i2c_t *bus, fpga_i2c_op_t *op) {
+    return queue_frame(bus, op, 1, NULL);
+}
+
+/**
+ * Block until a submitted transaction completes
+ * Returns: op->status
+ */
+int fpga_i2c_wait(fpga_i2c_t *bus, fpga_i2c_op_t *op) {
+    if (!bus || !bus->regs || !op) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&bus->lock);
+    while (!op->done) {
+        pthread_cond_wait(&bus->done_cv, &bus->lock);
+    }
+    pthread_mutex_unlock(&bus->lock);
+
+    return op->status;
+}
+
+/**
+ * Check a submitted transaction without blocking
+ * Returns: true once op->status and op->data are valid
+ */
+bool fpga_i2c_done(fpga_i2c_t *bus, const fpga_i2c_op_t *op) {
+    if (!bus || !bus->regs || !op) {
+        return true;
+    }
+
+    pthread_mutex_lock(&bus->lock);
+    const bool done = op->done;
+    pthread_mutex_unlock(&bus->lock);
+
+    return done;
+}
+
+int fpga_i2c_xfer(fpga_i2c_t *bus, fpga_i2c_op_t *op) {
+    if (fpga_i2c_submit(bus, op) < 0) {
+        return -1;
+    }
+    return fpga_i2c_wait(bus, op);
+}
+
+/**
+ * Queue a batch of independent ops and wait for all of it
+ * The whole batch is queued up front so the worker streams it, but each op
+ * is scheduled on its own and higher priority traffic can cut in. Once an
+ * op fails, the ops after it are failed without going on the wire.
+ * Returns: 0 if every op succeeded, -1 otherwise
+ */
+int fpga_i2c_xfer_batch(fpga_i2c_t *bus, fpga_i2c_op_t *ops, size_t count) {
+    bool failed = false;
+    size_t submitted = 0;
+    int ret = 0;
+
+    for (; submitted < count; submitted++) {
+        if (queue_frame(bus, &ops[submitted], 1, &failed) < 0) {
+            ret = -1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < submitted; i++) {
+        if (fpga_i2c_wait(bus, &ops[i]) < 0) {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Run one multi-byte message as a single unit and wait for it
+ * No other op is put on the wire between the frame's ops. The frame stops
+ * at its first failed op; the rest are failed without being sent.
+ * Returns: 0 if every op succeeded, -1 otherwise
+ */
+int fpga_i2c_xfer_frame(fpga_i2c_t *bus, fpga_i2c_op_t *ops, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    if (queue_frame(bus, ops, count, NULL) < 0) {
+        return -1;
+    }
+
+    int ret = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (fpga_i2c_wait(bus, &ops[i]) < 0) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+void fpga_i2c_get_stats(fpga_i2c_t *bus, fpga_i2c_stats_t *stats) {
+    if (!bus || !bus->regs || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&bus->lock);
+    *stats = bus->stats;
+    stats->elapsed_ns = now_ns() - bus->start_ns;
+    pthread_mutex_unlock(&bus->lock);
+}
+
+void fpga_i2c_print_stats(fpga_i2c_t *bus) {
+    static const char *names[FPGA_I2C_NUM_PRIO] = { "PSU", "PIC", "EEPROM" };
+    fpga_i2c_stats_t st = {0};
+
+    fpga_i2c_get_stats(bus, &st);
+
+    double util = st.elapsed_ns ? (st.busy_ns * 100.0) / st.elapsed_ns : 0.0;
+    printf("I2C bus: %.1f%% utilization (%.1f ms busy / %.1f ms)\n",
+           util, st.busy_ns / 1e6, st.elapsed_ns / 1e6);
+
+    for (int p = 0; p < FPGA_I2C_NUM_PRIO; p++) {
+        if (st.ops[p] == 0) {
+            continue;
+        }
+        printf("  %-6s %6llu ops, %llu errors, queue wait avg %.1f us, max %.1f us\n",
+               names[p], (unsigned long long)st.ops[p],
+               (unsigned long long)st.errors[p],
+               st.wait_ns_total[p] / 1e3 / st.ops[p],
+               st.wait_ns_max[p] / 1e3);
+    }
+}
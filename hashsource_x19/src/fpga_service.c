@@ -0,0 +1,384 @@
+/*
+ * FPGA Ownership and Shared-Memory Service Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "../include/fpga_service.h"
+#include "../include/bm1398_asic.h"
+
+// Registers the owner drives itself (see bm1398_asic.c)
+#define REG_TW_WRITE                (0x040 / 4)     // Work FIFO
+#define BC_COMMAND_WORDS            3               // 12-byte UART command buffer
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+// Shared (not private) futexes: the word lives in a segment other processes map
+static void futex_wake(uint32_t *addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+static void futex_wait(uint32_t *addr, uint32_t val, uint32_t timeout_ms) {
+    const struct timespec ts = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_nsec = (long)(timeout_ms % 1000) * 1000000L,
+    };
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+//==============================================================================
+// Ownership
+//==============================================================================
+
+/**
+ * Claim the FPGA for this process
+ *
+ * The lock file holds "<pid> <program>" of the owner, so a tool that is
+ * refused can say who has the hardware.
+ */
+int fpga_service_claim(const char *who) {
+    const int fd = open(FPGA_SERVICE_LOCK, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", FPGA_SERVICE_LOCK, strerror(errno));
+        return -1;
+    }
+
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+        char owner[64];
+        const ssize_t n = pread(fd, owner, sizeof(owner) - 1, 0);
+        owner[n > 0 ? n : 0] = '\0';
+        owner[strcspn(owner, "\n")] = '\0';
+        fprintf(stderr, "Error: FPGA is in use by %s\n",
+                owner[0] ? owner : "another process");
+        fprintf(stderr, "Hint: Stop it first, or use fpgactl to go through it\n");
+        close(fd);
+        return -1;
+    }
+
+    char line[64];
+    const int len = snprintf(line, sizeof(line), "%d %s\n", (int)getpid(), who);
+    if (ftruncate(fd, 0) < 0 || pwrite(fd, line, len, 0) != len) {
+        fprintf(stderr, "Warning: Cannot record FPGA owner in %s\n", FPGA_SERVICE_LOCK);
+    }
+    return fd;
+}
+
+void fpga_service_release(int fd) {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+//==============================================================================
+// Segment
+//==============================================================================
+
+int fpga_service_open(fpga_service_t *svc, volatile uint32_t *regs,
+                      fpga_i2c_t *i2c, const char *owner) {
+    memset(svc, 0, sizeof(*svc));
+    svc->regs = regs;
+    svc->i2c = i2c;
+
+    const int fd = shm_open(FPGA_SERVICE_SHM, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create shared memory %s: %s\n",
+                FPGA_SERVICE_SHM, strerror(errno));
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(fpga_service_shm_t)) < 0) {
+        fprintf(stderr, "Error: Cannot size shared memory: %s\n", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, sizeof(fpga_service_shm_t), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    // Only the FPGA owner gets here, so a segment left by an earlier owner
+    // is reset; its clients see the owner pid change and give up
+    fpga_service_shm_t *shm = base;
+    __atomic_store_n(&shm->magic, 0, __ATOMIC_RELEASE);
+    memset(shm, 0, sizeof(*shm));
+    shm->version = FPGA_SERVICE_VERSION;
+    shm->owner_pid = (uint32_t)getpid();
+    snprintf(shm->owner, sizeof(shm->owner), "%s", owner);
+    __atomic_store_n(&shm->magic, FPGA_SERVICE_MAGIC, __ATOMIC_RELEASE);
+
+    svc->shm = shm;
+    return 0;
+}
+
+void fpga_service_close(fpga_service_t *svc) {
+    if (!svc->shm) {
+        return;
+    }
+
+    // Queued I2C ops point into svc; let the scheduler finish them
+    for (int s = 0; s < FPGA_SERVICE_CLIENTS; s++) {
+        if (svc->i2c_busy[s]) {
+            fpga_i2c_wait(svc->i2c, &svc->i2c_op[s]);
+        }
+    }
+
+    // Clients asleep on a reply notice the owner is gone when they wake
+    __atomic_store_n(&svc->shm->magic, 0, __ATOMIC_SEQ_CST);
+    for (int s = 0; s < FPGA_SERVICE_CLIENTS; s++) {
+        futex_wake(&svc->shm->slot[s].done);
+    }
+    munmap(svc->shm, sizeof(fpga_service_shm_t));
+    shm_unlink(FPGA_SERVICE_SHM);
+    svc->shm = NULL;
+}
+
+//==============================================================================
+// Commands
+//==============================================================================
+
+/**
+ * Check a client register access
+ * Returns: 0, or -errno
+ */
+static int check_reg(uint32_t addr, bool write) {
+    if ((addr & 3) || addr >= FPGA_REG_SIZE) {
+        return -EINVAL;
+    }
+
+    const uint32_t reg = addr / 4;
+    if (reg == REG_RETURN_NONCE) {
+        return -EACCES;                 // Reading pops the owner's nonce FIFO
+    }
+    if (write && (reg == REG_IIC_COMMAND || reg == REG_TW_WRITE ||
+                  (reg >= REG_BC_WRITE_COMMAND &&
+                   reg < REG_BC_COMMAND_BUFFER + BC_COMMAND_WORDS))) {
+        return -EACCES;                 // Owner-driven FIFOs and controllers
+    }
+    return 0;
+}
+
+static int submit_i2c(fpga_service_t *svc, int s, const fpga_cmd_t *cmd) {
+    const bool read = cmd->flags & FPGA_CMD_FLAG_READ;
+    if (!svc->i2c) {
+        return -ENODEV;
+    }
+    if (svc->read_only && !read && cmd->op != FPGA_CMD_EEPROM) {
+        return -EPERM;
+    }
+    if (cmd->op != FPGA_CMD_PSU && cmd->chain >= BOARD_MAX_CHAINS) {
+        return -EINVAL;
+    }
+    if (cmd->addr > 0xFF || cmd->value > 0xFF) {
+        return -EINVAL;
+    }
+
+    fpga_i2c_op_t *op = &svc->i2c_op[s];
+    switch (cmd->op) {
+    case FPGA_CMD_PSU:
+        fpga_i2c_op_psu(op, (uint8_t)cmd->addr, (uint8_t)cmd->value, read);
+        break;
+    case FPGA_CMD_PIC:
+        fpga_i2c_op_pic(op, cmd->chain, (uint8_t)cmd->value, read);
+        break;
+    default:
+        fpga_i2c_op_eeprom(op, cmd->chain, (uint8_t)cmd->addr);
+        break;
+    }
+    if (fpga_i2c_submit(svc->i2c, op) < 0) {
+        return -EIO;
+    }
+    svc->i2c_busy[s] = true;
+    return 0;
+}
+
+/**
+ * Run one command of slot s
+ * Returns: false while its I2C transaction is still queued
+ */
+static bool run_cmd(fpga_service_t *svc, int s, fpga_cmd_t *cmd) {
+    int status = FPGA_CMD_OK;
+    uint32_t result = 0;
+
+    if (svc->i2c_busy[s]) {
+        const fpga_i2c_op_t *op = &svc->i2c_op[s];
+        if (!fpga_i2c_done(svc->i2c, op)) {
+            return false;
+        }
+        svc->i2c_busy[s] = false;
+        status = op->status < 0 ? -EIO : FPGA_CMD_OK;
+        result = op->data;
+    } else {
+        switch (cmd->op) {
+        case FPGA_CMD_READ_REG:
+            status = check_reg(cmd->addr, false);
+            if (status == 0) {
+                result = svc->regs[cmd->addr / 4];
+            }
+            break;
+        case FPGA_CMD_WRITE_REG:
+        case FPGA_CMD_MODIFY_REG:
+            status = svc->read_only ? -EPERM : check_reg(cmd->addr, true);
+            if (status == 0) {
+                volatile uint32_t *reg = &svc->regs[cmd->addr / 4];
+                result = cmd->op == FPGA_CMD_WRITE_REG ? cmd->value :
+                         (*reg & ~cmd->mask) | (cmd->value & cmd->mask);
+                *reg = result;
+                __sync_synchronize();
+            }
+            break;
+        case FPGA_CMD_PSU:
+        case FPGA_CMD_PIC:
+        case FPGA_CMD_EEPROM:
+            status = submit_i2c(svc, s, cmd);
+            if (status == 0) {
+                return false;
+            }
+            break;
+        default:
+            status = -EINVAL;
+            break;
+        }
+    }
+
+    cmd->status = status;
+    cmd->result = result;
+    svc->commands++;
+    svc->rejected += status != FPGA_CMD_OK;
+    return true;
+}
+
+/**
+ * Answer what the clients have queued, at most FPGA_SERVICE_POLL_BUDGET
+ * commands per slot, so a register dump cannot hold up the nonce drain
+ */
+int fpga_service_poll(fpga_service_t *svc) {
+    if (!svc->shm) {
+        return 0;
+    }
+
+    int answered = 0;
+    for (int s = 0; s < FPGA_SERVICE_CLIENTS; s++) {
+        fpga_service_slot_t *slot = &svc->shm->slot[s];
+        const uint32_t head = __atomic_load_n(&slot->head, __ATOMIC_ACQUIRE);
+        uint32_t done = svc->done[s];
+
+        // A client never has more than a ring in flight; anything else is
+        // a corrupted slot, skip to its head
+        if (head - done > FPGA_SERVICE_RING) {
+            done = head;
+        }
+        for (int n = 0; done != head && n < FPGA_SERVICE_POLL_BUDGET; n++) {
+            if (!run_cmd(svc, s, &slot->cmd[done % FPGA_SERVICE_RING])) {
+                break;
+            }
+            done++;
+        }
+        if (done == svc->done[s]) {
+            continue;
+        }
+
+        answered += (int)(done - svc->done[s]);
+        svc->done[s] = done;
+        __atomic_store_n(&slot->done, done, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&slot->waiting, __ATOMIC_SEQ_CST)) {
+            futex_wake(&slot->done);
+        }
+    }
+    return answered;
+}
+
+/**
+ * Sleep on the doorbell
+ *
+ * `sleeping` is raised before the rings are checked and clients check it
+ * after publishing a command, so either the check here sees the command or
+ * the client rings. While an I2C command is queued the sleep is cut to the
+ * scheduler's poll scale.
+ */
+void fpga_service_wait(fpga_service_t *svc, uint32_t timeout_ms) {
+    if (!svc->shm) {
+        usleep(timeout_ms * 1000);
+        return;
+    }
+
+    fpga_service_shm_t *shm = svc->shm;
+    const uint32_t bell = __atomic_load_n(&shm->doorbell, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&shm->sleeping, 1, __ATOMIC_SEQ_CST);
+
+    bool pending = false;
+    for (int s = 0; s < FPGA_SERVICE_CLIENTS; s++) {
+        pending |= __atomic_load_n(&shm->slot[s].head, __ATOMIC_SEQ_CST) != svc->done[s];
+        if (svc->i2c_busy[s] && timeout_ms > 1) {
+            timeout_ms = 1;
+        }
+    }
+    if (!pending) {
+        futex_wait(&shm->doorbell, bell, timeout_ms);
+    }
+    __atomic_store_n(&shm->sleeping, 0, __ATOMIC_SEQ_CST);
+}
+
+//==============================================================================
+// Stats
+//==============================================================================
+
+bool fpga_service_stat_due(fpga_service_t *svc) {
+    return svc->shm && now_ms() - svc->last_stat_ms >= FPGA_SERVICE_STAT_MS;
+}
+
+/**
+ * Publish a snapshot into the next stat ring entry
+ *
+ * The entry's seq goes odd, the body is written, then seq goes even and
+ * stat_head moves on. Readers retry a copy whose seq was odd or changed.
+ */
+void fpga_service_publish(fpga_service_t *svc, fpga_stat_t *stat) {
+    if (!svc->shm) {
+        return;
+    }
+
+    svc->last_stat_ms = now_ms();
+    stat->time_ms = svc->last_stat_ms;
+    stat->commands = svc->commands;
+    stat->rejected = svc->rejected;
+    stat->i2c_ops = 0;
+    stat->i2c_errors = 0;
+    if (svc->i2c) {
+        fpga_i2c_stats_t st;
+        fpga_i2c_get_stats(svc->i2c, &st);
+        for (int p = 0; p < FPGA_I2C_NUM_PRIO; p++) {
+            stat->i2c_ops += st.ops[p];
+            stat->i2c_errors += st.errors[p];
+        }
+    }
+
+    fpga_service_shm_t *shm = svc->shm;
+    const uint32_t head = shm->stat_head;
+    fpga_stat_t *e = &shm->stat[head % FPGA_SERVICE_STAT_RING];
+    const uint32_t seq = e->seq + 1;
+
+    __atomic_store_n(&e->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    const size_t body = offsetof(fpga_stat_t, plugged);
+    memcpy((uint8_t *)e + body, (const uint8_t *)stat + body, sizeof(*e) - body);
+    __atomic_store_n(&e->seq, seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&shm->stat_head, head + 1, __ATOMIC_RELEASE);
+}
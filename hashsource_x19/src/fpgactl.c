@@ -0,0 +1,343 @@
+/*
+ * FPGA Service Command-Line Client
+ *
+ * Reads and writes FPGA registers, PSU and PIC bytes and board EEPROMs
+ * through whichever process owns the FPGA (hashsource_miner or fpgad), so
+ * it can run against a live miner without stopping it (fpga_client.h).
+ *
+ * Usage: fpgactl COMMAND [ARGS]   (fpgactl --help lists the commands)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include "../include/fpga_client.h"
+#include "../include/bm1398_asic.h"
+#include "../include/eeprom.h"
+
+#define DUMP_REGS               (FPGA_REG_SIZE / 4)
+#define BENCH_DEFAULT           10000
+#define WATCH_POLL_MS           200
+
+static volatile sig_atomic_t g_shutdown = 0;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_shutdown = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s COMMAND [ARGS]\n", prog);
+    printf("  status                   FPGA owner and its latest snapshot\n");
+    printf("  watch                    Print snapshots as they are published\n");
+    printf("  read OFFSET [COUNT]      Read registers (byte offsets)\n");
+    printf("  write OFFSET VALUE       Write a register\n");
+    printf("  modify OFFSET VALUE MASK Change the masked bits of a register\n");
+    printf("  dump                     Every nonzero register\n");
+    printf("  psu REG [VALUE]          Read or write a PSU register\n");
+    printf("  pic CHAIN [BYTE]         Read or send a PIC byte\n");
+    printf("  eeprom CHAIN             Read and decode a board EEPROM\n");
+    printf("  bench [N]                Command latency and pipelined throughput\n");
+    printf("Numbers may be given in hex (0x...).\n");
+}
+
+static uint32_t parse_num(const char *s) {
+    return (uint32_t)strtoul(s, NULL, 0);
+}
+
+static int report(const char *what, int status) {
+    if (status != FPGA_CMD_OK) {
+        fprintf(stderr, "Error: %s: %s\n", what, strerror(-status));
+        return -1;
+    }
+    return 0;
+}
+
+//==============================================================================
+// Stats
+//==============================================================================
+
+static void print_stat(const fpga_stat_t *st) {
+    printf("[%llu.%03llu] plugged 0x%X, hashing 0x%X, CRC errors %u, "
+           "%llu commands (%llu refused), I2C %llu ops (%llu errors)\n",
+           (unsigned long long)(st->time_ms / 1000), (unsigned long long)(st->time_ms % 1000),
+           st->plugged, st->hashing, st->crc_errors,
+           (unsigned long long)st->commands, (unsigned long long)st->rejected,
+           (unsigned long long)st->i2c_ops, (unsigned long long)st->i2c_errors);
+    if (st->hashing) {
+        printf("  Total:   %8.2f GH/s\n", st->ghs_total);
+    }
+    for (int chain = 0; chain < BOARD_MAX_CHAINS; chain++) {
+        if (!(st->hashing & (1u << chain))) {
+            continue;
+        }
+        printf("  Chain %d:", chain);
+        if (st->ghs_valid & (1u << chain)) {
+            printf(" %8.2f GH/s", st->ghs[chain]);
+        }
+        if (st->temp_valid & (1u << chain)) {
+            printf(" %.1f C", st->temp_c[chain]);
+        }
+        printf("\n");
+    }
+    if (st->hashing) {
+        printf("  Fans: %.0f %%, %d / %d / %d / %d RPM\n", st->fan_pct,
+               st->fan_rpm[0], st->fan_rpm[1], st->fan_rpm[2], st->fan_rpm[3]);
+    }
+}
+
+static int cmd_status(fpga_client_t *cl) {
+    printf("FPGA owner: %s (pid %u)\n", cl->shm->owner, cl->owner_pid);
+
+    fpga_stat_t st;
+    if (fpga_client_latest_stat(cl, &st)) {
+        print_stat(&st);
+    } else {
+        printf("No snapshot published yet\n");
+    }
+    return 0;
+}
+
+static int cmd_watch(fpga_client_t *cl) {
+    uint32_t cursor = __atomic_load_n(&cl->shm->stat_head, __ATOMIC_ACQUIRE);
+    cursor -= cursor > 0;
+
+    while (!g_shutdown) {
+        fpga_stat_t st;
+        while (fpga_client_next_stat(cl, &cursor, &st)) {
+            print_stat(&st);
+        }
+        fflush(stdout);
+        usleep(WATCH_POLL_MS * 1000);
+    }
+    return 0;
+}
+
+//==============================================================================
+// Registers
+//==============================================================================
+
+static int cmd_read(fpga_client_t *cl, uint32_t addr, int count) {
+    fpga_cmd_t *cmds = calloc(count, sizeof(*cmds));
+    if (!cmds) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        cmds[i].op = FPGA_CMD_READ_REG;
+        cmds[i].addr = addr + 4u * i;
+    }
+
+    int ret = fpga_client_call_batch(cl, cmds, count) == FPGA_CMD_OK ? 0 : -1;
+    for (int i = 0; i < count && ret == 0; i++) {
+        if (cmds[i].status == FPGA_CMD_OK) {
+            printf("0x%03X: 0x%08X\n", cmds[i].addr, cmds[i].result);
+        } else {
+            printf("0x%03X: %s\n", cmds[i].addr, strerror(-cmds[i].status));
+        }
+    }
+    free(cmds);
+    return ret;
+}
+
+static int cmd_modify(fpga_client_t *cl, uint32_t addr, uint32_t value, uint32_t mask,
+                      bool whole) {
+    fpga_cmd_t cmd = {
+        .op = whole ? FPGA_CMD_WRITE_REG : FPGA_CMD_MODIFY_REG,
+        .addr = addr, .value = value, .mask = mask,
+    };
+    if (report("write", fpga_client_call(cl, &cmd)) < 0) {
+        return -1;
+    }
+    printf("0x%03X <- 0x%08X\n", addr, cmd.result);
+    return 0;
+}
+
+/**
+ * Dump every nonzero register
+ * The nonce FIFO is skipped: reading it would take nonces from the owner.
+ */
+static int cmd_dump(fpga_client_t *cl) {
+    static fpga_cmd_t cmds[DUMP_REGS];
+    for (int i = 0; i < DUMP_REGS; i++) {
+        cmds[i] = (fpga_cmd_t){ .op = FPGA_CMD_READ_REG, .addr = 4u * i };
+    }
+
+    const uint64_t t0 = now_ns();
+    if (fpga_client_call_batch(cl, cmds, DUMP_REGS) != FPGA_CMD_OK) {
+        return -1;
+    }
+    const uint64_t t1 = now_ns();
+
+    int shown = 0;
+    for (int i = 0; i < DUMP_REGS; i++) {
+        if (cmds[i].status == FPGA_CMD_OK && cmds[i].result != 0) {
+            printf("0x%03X: 0x%08X\n", cmds[i].addr, cmds[i].result);
+            shown++;
+        }
+    }
+    printf("# %d of %d registers nonzero, read in %.2f ms\n", shown, DUMP_REGS,
+           (t1 - t0) / 1e6);
+    return 0;
+}
+
+//==============================================================================
+// I2C
+//==============================================================================
+
+static int cmd_i2c(fpga_client_t *cl, fpga_cmd_op_t op, int chain, uint32_t addr,
+                   const char *value) {
+    fpga_cmd_t cmd = {
+        .op = op,
+        .chain = (uint8_t)chain,
+        .addr = addr,
+        .value = value ? parse_num(value) : 0,
+        .flags = value ? 0 : FPGA_CMD_FLAG_READ,
+    };
+    if (report(op == FPGA_CMD_PSU ? "PSU" : "PIC", fpga_client_call(cl, &cmd)) < 0) {
+        return -1;
+    }
+    if (value) {
+        printf("Sent 0x%02X\n", cmd.value);
+    } else {
+        printf("0x%02X\n", cmd.result);
+    }
+    return 0;
+}
+
+static int cmd_eeprom(fpga_client_t *cl, int chain) {
+    fpga_cmd_t cmds[EEPROM_SIZE];
+    for (int i = 0; i < EEPROM_SIZE; i++) {
+        cmds[i] = (fpga_cmd_t){ .op = FPGA_CMD_EEPROM, .chain = (uint8_t)chain, .addr = i };
+    }
+    if (fpga_client_call_batch(cl, cmds, EEPROM_SIZE) != FPGA_CMD_OK) {
+        return -1;
+    }
+
+    uint8_t raw[EEPROM_SIZE];
+    for (int i = 0; i < EEPROM_SIZE; i++) {
+        if (report("EEPROM", cmds[i].status) < 0) {
+            return -1;
+        }
+        raw[i] = (uint8_t)cmds[i].result;
+    }
+
+    printf("[chain %d]\n", chain);
+    for (int i = 0; i < EEPROM_SIZE; i += 16) {
+        printf("0x%04X ", i);
+        for (int j = 0; j < 16; j++) {
+            printf("%02X%s", raw[i + j], j == 7 ? "   " : " ");
+        }
+        printf("\n");
+    }
+
+    eeprom_info_t info;
+    if (eeprom_parse(raw, &info) < 0) {
+        printf("Could not decode EEPROM\n");
+        return -1;
+    }
+    printf("Serial %s, chip %s %s bin %u, PCB 0x%04X, BOM 0x%04X, %u MHz\n",
+           info.board_serial_no, info.chip_marking, info.chip_die, info.chip_bin,
+           info.pcb_version, info.bom_version, info.default_freq);
+    return 0;
+}
+
+//==============================================================================
+// Benchmark
+//==============================================================================
+
+/**
+ * Round trips one at a time, then the same reads with the ring kept full
+ */
+static int cmd_bench(fpga_client_t *cl, int count) {
+    uint64_t t0 = now_ns();
+    for (int i = 0; i < count; i++) {
+        uint32_t value;
+        if (report("read", fpga_client_read_reg(cl, 0x000, &value)) < 0) {
+            return -1;
+        }
+    }
+    const double serial_ns = (double)(now_ns() - t0) / count;
+
+    fpga_cmd_t *cmds = calloc(count, sizeof(*cmds));
+    if (!cmds) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        cmds[i].op = FPGA_CMD_READ_REG;
+    }
+    t0 = now_ns();
+    const int ret = fpga_client_call_batch(cl, cmds, count);
+    const double batch_ns = (double)(now_ns() - t0) / count;
+    free(cmds);
+    if (ret != FPGA_CMD_OK) {
+        return -1;
+    }
+
+    printf("%d register reads through %s (pid %u)\n", count, cl->shm->owner, cl->owner_pid);
+    printf("  One at a time: %8.1f us per command\n", serial_ns / 1e3);
+    printf("  Pipelined:     %8.1f us per command (%d in flight)\n", batch_ns / 1e3,
+           FPGA_SERVICE_RING);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        usage(argv[0]);
+        return argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    const char *cmd = argv[1];
+    const int nargs = argc - 2;
+    char **args = &argv[2];
+
+    fpga_client_t cl;
+    if (fpga_client_open(&cl) < 0) {
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    int ret;
+    if (strcmp(cmd, "status") == 0) {
+        ret = cmd_status(&cl);
+    } else if (strcmp(cmd, "watch") == 0) {
+        ret = cmd_watch(&cl);
+    } else if (strcmp(cmd, "read") == 0 && nargs >= 1) {
+        const int count = nargs >= 2 ? atoi(args[1]) : 1;
+        ret = count > 0 ? cmd_read(&cl, parse_num(args[0]), count) : -1;
+    } else if (strcmp(cmd, "write") == 0 && nargs == 2) {
+        ret = cmd_modify(&cl, parse_num(args[0]), parse_num(args[1]), 0, true);
+    } else if (strcmp(cmd, "modify") == 0 && nargs == 3) {
+        ret = cmd_modify(&cl, parse_num(args[0]), parse_num(args[1]), parse_num(args[2]),
+                         false);
+    } else if (strcmp(cmd, "dump") == 0) {
+        ret = cmd_dump(&cl);
+    } else if (strcmp(cmd, "psu") == 0 && (nargs == 1 || nargs == 2)) {
+        ret = cmd_i2c(&cl, FPGA_CMD_PSU, 0, parse_num(args[0]), nargs == 2 ? args[1] : NULL);
+    } else if (strcmp(cmd, "pic") == 0 && (nargs == 1 || nargs == 2)) {
+        ret = cmd_i2c(&cl, FPGA_CMD_PIC, atoi(args[0]), 0, nargs == 2 ? args[1] : NULL);
+    } else if (strcmp(cmd, "eeprom") == 0 && nargs == 1) {
+        ret = cmd_eeprom(&cl, atoi(args[0]));
+    } else if (strcmp(cmd, "bench") == 0) {
+        const int count = nargs >= 1 ? atoi(args[0]) : BENCH_DEFAULT;
+        ret = count > 0 ? cmd_bench(&cl, count) : -1;
+    } else {
+        usage(argv[0]);
+        ret = -1;
+    }
+
+    fpga_client_close(&cl);
+    return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+/*
+ * FPGA Owner Daemon
+ *
+ * Owns the FPGA while hashsource_miner is not running, so diagnostics and
+ * tuning tools (fpgactl) reach the hardware through one process instead of
+ * each mapping it (fpga_service.h). The miner serves the same interface
+ * itself while it runs; the two exclude each other through the FPGA claim.
+ *
+ * The daemon maps the registers and runs the I2C scheduler, but leaves the
+ * FPGA configuration as it finds it. Between client commands it sleeps on
+ * the service doorbell, and it publishes a snapshot every
+ * FPGA_SERVICE_STAT_MS.
+ *
+ * Usage: fpgad [--read-only]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include "../include/bm1398_asic.h"
+#include "../include/fpga_i2c.h"
+#include "../include/fpga_service.h"
+
+#define IDLE_WAIT_MS            100     // Doorbell sleep between stat checks
+
+static volatile sig_atomic_t g_shutdown = 0;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_shutdown = 1;
+}
+
+int main(int argc, char *argv[]) {
+    bool read_only = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--read-only") == 0) {
+            read_only = true;
+        } else {
+            printf("Usage: %s [--read-only]\n", argv[0]);
+            printf("  --read-only  Refuse register writes and I2C writes from clients\n");
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ?
+                   EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    const int owner_fd = fpga_service_claim("fpgad");
+    if (owner_fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    const int fd = open("/dev/axi_fpga_dev", O_RDWR | O_SYNC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open /dev/axi_fpga_dev: %s\n", strerror(errno));
+        fprintf(stderr, "Hint: Ensure bitmain_axi.ko kernel module is loaded\n");
+        return EXIT_FAILURE;
+    }
+    volatile uint32_t *regs = mmap(NULL, FPGA_REG_SIZE, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (regs == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap failed: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    fpga_i2c_t i2c;
+    if (fpga_i2c_init(&i2c, regs) < 0) {
+        munmap((void *)regs, FPGA_REG_SIZE);
+        return EXIT_FAILURE;
+    }
+
+    fpga_service_t svc;
+    if (fpga_service_open(&svc, regs, &i2c, "fpgad") < 0) {
+        fpga_i2c_cleanup(&i2c);
+        munmap((void *)regs, FPGA_REG_SIZE);
+        return EXIT_FAILURE;
+    }
+    svc.read_only = read_only;
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    printf("fpgad: serving %s (pid %d)%s\n", FPGA_SERVICE_SHM, (int)getpid(),
+           read_only ? ", read-only" : "");
+
+    while (!g_shutdown) {
+        if (fpga_service_poll(&svc) == 0) {
+            fpga_service_wait(&svc, IDLE_WAIT_MS);
+        }
+
+        if (fpga_service_stat_due(&svc)) {
+            fpga_stat_t stat = {0};
+            stat.plugged = regs[REG_HASH_ON_PLUG];
+            stat.crc_errors = regs[REG_CRC_ERROR_CNT_ADDR];
+            fpga_service_publish(&svc, &stat);
+        }
+    }
+
+    printf("fpgad: shutting down\n");
+    fpga_service_close(&svc);
+    fpga_i2c_cleanup(&i2c);
+    munmap((void *)regs, FPGA_REG_SIZE);
+    fpga_service_release(owner_fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/*
+ * Per-Chip / Per-Chain Hashrate Estimator Implementation
+ *
+ * Estimates follow bmminer's rate windows ("GHS 5s", "GHS av" style).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../include/hashrate.h"
+
+// Window time constants (seconds)
+static const float WINDOW_TAU_S[HASHRATE_NUM_WINDOWS] = { 5.0f, 60.0f, 900.0f };
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+void hashrate_init(hashrate_t *hr, uint32_t difficulty, bool per_chain) {
+    memset(hr, 0, sizeof(*hr));
+    memset(hr->addr_to_chip, HASHRATE_NO_CHIP, sizeof(hr->addr_to_chip));
+    hr->difficulty = difficulty ? difficulty : 1;
+    hr->per_chain = per_chain;
+    hr->last_tick_ms = now_ms();
+}
+
+/**
+ * Build the address → chip table for a chain (work_timing_addr_table())
+ */
+void hashrate_set_chain(hashrate_t *hr, int chain, int num_chips, int interval) {
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+    if (num_chips > HASHRATE_MAX_CHIPS) {
+        num_chips = HASHRATE_MAX_CHIPS;
+    }
+
+    work_timing_addr_table(hr->addr_to_chip[chain], num_chips, interval, HASHRATE_NO_CHIP);
+    hr->num_chips[chain] = num_chips > 0 ? num_chips : 0;
+
+    // A new board starts with fresh estimates
+    memset(hr->chip[chain], 0, sizeof(hr->chip[chain]));
+    memset(&hr->chain[chain], 0, sizeof(hr->chain[chain]));
+}
+
+/**
+ * Share difficulty for a TICKET_MASK value: bits [7:0] hold difficulty - 1
+ * (TICKET_MASK_256_CORES = 0xFF → 256)
+ */
+uint32_t hashrate_difficulty_from_mask(uint32_t ticket_mask) {
+    return (ticket_mask & 0xFF) + 1;
+}
+
+//==============================================================================
+// Accounting
+//==============================================================================
+
+int hashrate_add_nonce(hashrate_t *hr, int chain, uint32_t nonce) {
+    hr->all.pending++;
+    if (!hr->per_chain) {
+        return -1;
+    }
+    if ((unsigned)chain >= MAX_CHAINS) {
+        hr->unattributed++;
+        return -1;
+    }
+
+    const uint8_t chip = hr->addr_to_chip[chain][nonce >> 24];
+    hr->chain[chain].pending++;
+    if (chip == HASHRATE_NO_CHIP) {
+        hr->unattributed++;
+        return -1;
+    }
+    hr->chip[chain][chip].pending++;
+    return chip;
+}
+
+static void counter_fold(hashrate_counter_t *c, const float alpha[], float dt) {
+    const float rate = c->pending / dt;
+    for (int w = 0; w < HASHRATE_NUM_WINDOWS; w++) {
+        c->ewma[w] += alpha[w] * (rate - c->ewma[w]);
+        c->weight[w] += alpha[w] * (1.0f - c->weight[w]);
+    }
+    c->total += c->pending;
+    c->pending = 0;
+}
+
+void hashrate_tick(hashrate_t *hr) {
+    const uint64_t now = now_ms();
+    const float dt = (now - hr->last_tick_ms) / 1000.0f;
+    if (dt <= 0.0f) {
+        return;
+    }
+    hr->last_tick_ms = now;
+
+    // Exact decay for the elapsed time, so irregular ticks stay consistent
+    float alpha[HASHRATE_NUM_WINDOWS];
+    for (int w = 0; w < HASHRATE_NUM_WINDOWS; w++) {
+        alpha[w] = 1.0f - expf(-dt / WINDOW_TAU_S[w]);
+    }
+
+    counter_fold(&hr->all, alpha, dt);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        counter_fold(&hr->chain[chain], alpha, dt);
+        for (int chip = 0; chip < hr->num_chips[chain]; chip++) {
+            counter_fold(&hr->chip[chain][chip], alpha, dt);
+        }
+    }
+}
+
+//==============================================================================
+// Query
+//==============================================================================
+
+/**
+ * Returns: 0 on success, -1 if the chain/chip is invalid, not attributed
+ * (per_chain off) or has no history
+ *
+ * Bounds use the normal approximation to the Poisson count: the window holds
+ * about rate * tau * weight nonces, so the relative error is 1.96 / sqrt(n).
+ * With no nonces at all only an upper bound (3 nonces, rule of three) is given.
+ */
+int hashrate_get(const hashrate_t *hr, int chain, int chip,
+                 hashrate_window_t window, hashrate_estimate_t *est) {
+    if ((unsigned)window >= HASHRATE_NUM_WINDOWS) {
+        return -1;
+    }
+
+    const hashrate_counter_t *c = &hr->all;
+    if (chain >= 0) {
+        if (!hr->per_chain || chain >= MAX_CHAINS || chip >= hr->num_chips[chain]) {
+            return -1;
+        }
+        c = chip < 0 ? &hr->chain[chain] : &hr->chip[chain][chip];
+    }
+    const float weight = c->weight[window];
+    memset(est, 0, sizeof(*est));
+    if (weight <= 0.0f) {
+        return -1;
+    }
+
+    const double ghs_per_nonce = (double)hr->difficulty * 4294967296.0 / 1e9;
+    const double span_s = WINDOW_TAU_S[window] * weight;
+    const double rate = c->ewma[window] / weight;
+    const double n = rate * span_s;
+
+    est->nonces = n;
+    est->ghs = rate * ghs_per_nonce;
+    if (n > 0.0) {
+        const double rel = HASHRATE_Z95 / sqrt(n);
+        est->low_ghs = rel < 1.0 ? est->ghs * (1.0 - rel) : 0.0;
+        est->high_ghs = est->ghs * (1.0 + rel);
+    } else {
+        est->high_ghs = 3.0 / span_s * ghs_per_nonce;
+    }
+    return 0;
+}
+
+void hashrate_print(const hashrate_t *hr) {
+    static const char *names[HASHRATE_NUM_WINDOWS] = { "5s", "1m", "15m" };
+
+    printf("  Total:");
+    for (int w = 0; w < HASHRATE_NUM_WINDOWS; w++) {
+        hashrate_estimate_t e;
+        if (hashrate_get(hr, -1, -1, w, &e) == 0) {
+            printf(" %s %.1f GH/s [%.1f-%.1f]", names[w], e.ghs, e.low_ghs, e.high_ghs);
+        }
+    }
+    printf(" (%llu nonces)\n", (unsigned long long)hr->all.total);
+    if (!hr->per_chain) {
+        return;
+    }
+
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (hr->num_chips[chain] == 0) {
+            continue;
+        }
+
+        printf("  Chain %d:", chain);
+        for (int w = 0; w < HASHRATE_NUM_WINDOWS; w++) {
+            hashrate_estimate_t e;
+            if (hashrate_get(hr, chain, -1, w, &e) == 0) {
+                printf(" %s %.1f GH/s [%.1f-%.1f]", names[w],
+                       e.ghs, e.low_ghs, e.high_ghs);
+            }
+        }
+        printf(" (%llu nonces)\n", (unsigned long long)hr->chain[chain].total);
+
+        // Chips far below the chain average over the long window
+        hashrate_estimate_t chain_est;
+        if (hashrate_get(hr, chain, -1, HASHRATE_WIN_15M, &chain_est) < 0 ||
+            chain_est.ghs <= 0.0) {
+            continue;
+        }
+        const double expected = chain_est.ghs / hr->num_chips[chain];
+        for (int chip = 0; chip < hr->num_chips[chain]; chip++) {
+            hashrate_estimate_t e;
+            if (hashrate_get(hr, chain, chip, HASHRATE_WIN_15M, &e) == 0 &&
+                e.high_ghs < expected * 0.5) {
+                printf("    Chip %3d low: %.2f GH/s (upper %.2f, expected %.2f)\n",
+                       chip, e.ghs, e.high_ghs, expected);
+            }
+        }
+    }
+    if (hr->unattributed) {
+        printf("  Unattributed nonces: %llu\n", (unsigned long long)hr->unattributed);
+    }
+}
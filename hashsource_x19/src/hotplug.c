@@ -0,0 +1,256 @@
+/*
+ * Hashboard Hot-Plug Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../include/hotplug.h"
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+void hotplug_init(hotplug_t *hp, bm1398_context_t *ctx) {
+    memset(hp, 0, sizeof(*hp));
+    hp->ctx = ctx;
+
+    const uint64_t now = now_ms();
+    const uint32_t present = bm1398_detect_chains(ctx);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        hotplug_chain_t *c = &hp->chain[chain];
+        if (ctx->chips_per_chain[chain] > 0) {
+            c->state = HOTPLUG_ACTIVE;
+        } else if (present & (1u << chain)) {
+            // Startup bring-up already failed once
+            c->state = HOTPLUG_FAILED;
+            c->attempts = 1;
+            c->plugged_ms = now;
+            c->deadline_ms = now + HOTPLUG_RETRY_MS;
+        }
+    }
+}
+
+const char *hotplug_state_name(hotplug_state_t state) {
+    switch (state) {
+    case HOTPLUG_ABSENT:    return "absent";
+    case HOTPLUG_DEBOUNCE:  return "debounce";
+    case HOTPLUG_POWERING:  return "powering";
+    case HOTPLUG_RAMPING:   return "ramping";
+    case HOTPLUG_ACTIVE:    return "active";
+    case HOTPLUG_FAILED:    return "failed";
+    }
+    return "unknown";
+}
+
+//==============================================================================
+// State Machine
+//==============================================================================
+
+/**
+ * Frequency the running chains hash at (the new board ramps to it)
+ */
+static uint32_t running_freq(const bm1398_context_t *ctx, int except) {
+    uint32_t fastest = 0;
+    for (int i = 0; i < MAX_CHAINS; i++) {
+        if (i != except && ctx->chips_per_chain[i] > 0 && ctx->freq_mhz[i] > fastest) {
+            fastest = ctx->freq_mhz[i];
+        }
+    }
+    return fastest ? fastest : ctx->profile->freq_mhz;
+}
+
+static void enter(hotplug_chain_t *c, int chain, hotplug_state_t state, uint64_t deadline) {
+    printf("Hot-plug: chain %d %s → %s\n", chain,
+           hotplug_state_name(c->state), hotplug_state_name(state));
+    c->state = state;
+    c->deadline_ms = deadline;
+}
+
+/**
+ * Bring-up failed: release the chain and schedule a retry
+ */
+static void fail(hotplug_t *hp, int chain, uint64_t now) {
+    hotplug_chain_t *c = &hp->chain[chain];
+    bm1398_detach_chain(hp->ctx, chain);
+    if (c->attempts >= HOTPLUG_MAX_ATTEMPTS) {
+        printf("Hot-plug: chain %d gave up after %d attempts (reseat the board to retry)\n",
+               chain, c->attempts);
+    }
+    enter(c, chain, HOTPLUG_FAILED, now + HOTPLUG_RETRY_MS);
+}
+
+/**
+ * One step of a chain whose board is present
+ * Returns: true if the chain became ACTIVE
+ */
+static bool step_present(hotplug_t *hp, int chain, uint64_t now) {
+    bm1398_context_t *ctx = hp->ctx;
+    hotplug_chain_t *c = &hp->chain[chain];
+
+    switch (c->state) {
+    case HOTPLUG_ABSENT:
+        c->plugged_ms = now;
+        c->attempts = 0;
+        c->insertions++;
+        enter(c, chain, HOTPLUG_DEBOUNCE, now + HOTPLUG_DEBOUNCE_MS);
+        break;
+
+    case HOTPLUG_FAILED:
+    case HOTPLUG_DEBOUNCE:
+        // A failed bring-up is retried like a fresh insertion
+        if (now < c->deadline_ms ||
+            (c->state == HOTPLUG_FAILED && c->attempts >= HOTPLUG_MAX_ATTEMPTS)) {
+            break;
+        }
+        c->attempts++;
+        bm1398_attach_chain(ctx, chain);
+        if (bm1398_enable_dc_dc(ctx, chain) < 0) {
+            printf("Note: Chain %d DC-DC enable failed (may already be enabled)\n", chain);
+        }
+        enter(c, chain, HOTPLUG_POWERING, now_ms() + HOTPLUG_POWER_SETTLE_MS);
+        break;
+
+    case HOTPLUG_POWERING:
+        if (now < c->deadline_ms) {
+            break;
+        }
+        // First recovery attempt replays the recorded bring-up, later ones
+        // (and new boards) run the full sequence
+        int ret = -1;
+        if (c->recovering && c->attempts == 1) {
+            ret = bm1398_replay_chain(ctx, chain, HOTPLUG_REPLAY_HOLD_PERCENT);
+        }
+        if (ret < 0) {
+            ret = bm1398_init_chain(ctx, chain);
+        }
+        if (ret < 0) {
+            fprintf(stderr, "Warning: Chain %d initialization failed\n", chain);
+            fail(hp, chain, now_ms());
+            break;
+        }
+        c->target_mhz = running_freq(ctx, chain);
+        c->ramp_mhz = HOTPLUG_RAMP_START_MHZ < c->target_mhz ?
+                      HOTPLUG_RAMP_START_MHZ : c->target_mhz;
+        if (bm1398_set_frequency(ctx, chain, c->ramp_mhz) < 0) {
+            fail(hp, chain, now_ms());
+            break;
+        }
+        enter(c, chain, HOTPLUG_RAMPING, now_ms() + HOTPLUG_RAMP_STEP_MS);
+        break;
+
+    case HOTPLUG_RAMPING:
+        if (now < c->deadline_ms) {
+            break;
+        }
+        if (c->ramp_mhz < c->target_mhz) {
+            c->ramp_mhz += HOTPLUG_RAMP_STEP_MHZ;
+            if (c->ramp_mhz > c->target_mhz) {
+                c->ramp_mhz = c->target_mhz;
+            }
+            if (bm1398_set_frequency(ctx, chain, c->ramp_mhz) < 0) {
+                fail(hp, chain, now_ms());
+                break;
+            }
+            c->deadline_ms = now_ms() + HOTPLUG_RAMP_STEP_MS;
+            break;
+        }
+        c->bringup_ms = (uint32_t)(now - c->plugged_ms);
+        c->recovering = false;
+        enter(c, chain, HOTPLUG_ACTIVE, 0);
+        printf("Hot-plug: chain %d up at %u MHz, %d chips (bring-up %.1f s)\n",
+               chain, ctx->freq_mhz[chain], ctx->chips_per_chain[chain],
+               c->bringup_ms / 1000.0);
+        return true;
+
+    case HOTPLUG_ACTIVE:
+        break;
+    }
+    return false;
+}
+
+int hotplug_poll(hotplug_t *hp, uint32_t *added, uint32_t *removed) {
+    *added = 0;
+    *removed = 0;
+
+    const uint64_t now = now_ms();
+    if (now < hp->next_poll_ms) {
+        return 0;
+    }
+    hp->next_poll_ms = now + HOTPLUG_POLL_MS;
+
+    const uint32_t present = bm1398_detect_chains(hp->ctx);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        hotplug_chain_t *c = &hp->chain[chain];
+
+        if (present & (1u << chain)) {
+            c->absent_since_ms = 0;
+            if (c->recover && c->state == HOTPLUG_ACTIVE) {
+                // Rails stay up: straight to reset + configure
+                c->recover = false;
+                c->recovering = true;
+                c->plugged_ms = now;
+                c->attempts = 1;
+                *removed |= 1u << chain;
+                enter(c, chain, HOTPLUG_POWERING, now);
+                continue;
+            }
+            if (step_present(hp, chain, now)) {
+                *added |= 1u << chain;
+            }
+            continue;
+        }
+
+        // Present bit clear: retire once it has stayed clear
+        if (c->state == HOTPLUG_ABSENT) {
+            continue;
+        }
+        if (c->absent_since_ms == 0) {
+            c->absent_since_ms = now;
+        }
+        if (now - c->absent_since_ms < HOTPLUG_DEBOUNCE_MS) {
+            continue;
+        }
+        if (c->state == HOTPLUG_ACTIVE || c->recovering) {
+            *removed |= 1u << chain;
+        }
+        bm1398_detach_chain(hp->ctx, chain);
+        c->removals++;
+        c->absent_since_ms = 0;
+        c->recover = false;
+        c->recovering = false;
+        enter(c, chain, HOTPLUG_ABSENT, 0);
+    }
+    return 0;
+}
+
+int hotplug_recover(hotplug_t *hp, int chain) {
+    if (chain < 0 || chain >= MAX_CHAINS || hp->chain[chain].state != HOTPLUG_ACTIVE) {
+        return -1;
+    }
+    hp->chain[chain].recover = true;
+    return 0;
+}
+
+//==============================================================================
+// Reporting
+//==============================================================================
+
+void hotplug_print(const hotplug_t *hp) {
+    printf("Hashboards:");
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const hotplug_chain_t *c = &hp->chain[chain];
+        printf(" %d:%s", chain, hotplug_state_name(c->state));
+        if (c->insertions || c->removals) {
+            printf(" (in %u, out %u)", c->insertions, c->removals);
+        }
+    }
+    printf("\n");
+}
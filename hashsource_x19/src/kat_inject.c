@@ -0,0 +1,411 @@
+/*
+ * Live Known-Answer Injection Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../include/kat_inject.h"
+
+#define KAT_NO_CHIP 0xFF
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000ULL;
+}
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+void kat_inject_init(kat_inject_t *kat, const pattern_bundle_t *bundle, int permille) {
+    memset(kat, 0, sizeof(*kat));
+    memset(kat->addr_to_chip, KAT_NO_CHIP, sizeof(kat->addr_to_chip));
+    kat->bundle = bundle;
+    if (permille < 0) {
+        permille = 0;
+    }
+    kat->permille = permille > KAT_MAX_PERMILLE ? KAT_MAX_PERMILLE : permille;
+
+    const uint64_t now = now_us();
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        kat->last_us[chain] = now;
+    }
+    kat->last_sweep_ms = now / 1000;
+}
+
+/**
+ * Address table and chip count for a chain (work_timing_addr_table())
+ */
+void kat_inject_set_chain(kat_inject_t *kat, int chain, int num_chips, int interval) {
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+    if (num_chips > KAT_MAX_CHIPS) {
+        num_chips = KAT_MAX_CHIPS;
+    }
+
+    work_timing_addr_table(kat->addr_to_chip[chain], num_chips, interval, KAT_NO_CHIP);
+    kat->num_chips[chain] = num_chips > 0 ? num_chips : 0;
+
+    // New or removed board: forget probes in flight and start over
+    kat->next_chip[chain] = 0;
+    memset(kat->next_core[chain], 0, sizeof(kat->next_core[chain]));
+    memset(kat->next_slot[chain], chain % PATTERN_SLOTS_PER_CORE, sizeof(kat->next_slot[chain]));
+    memset(kat->core[chain], 0, sizeof(kat->core[chain]));
+    memset(kat->chip[chain], 0, sizeof(kat->chip[chain]));
+    memset(&kat->stats[chain], 0, sizeof(kat->stats[chain]));
+    kat->credit[chain] = 0;
+}
+
+//==============================================================================
+// Probing
+//==============================================================================
+
+/**
+ * Next chip on the chain that has patterns in the bundle
+ * Returns: chip index, or -1 if none has
+ */
+static int next_probe_chip(kat_inject_t *kat, int chain) {
+    const int chips = kat->num_chips[chain];
+    for (int i = 0; i < chips; i++) {
+        const int chip = kat->next_chip[chain];
+        kat->next_chip[chain] = (chip + 1) % chips;
+        if (pattern_bundle_has_chip(kat->bundle, chip)) {
+            return chip;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Whether another chain has a probe for this nonce in flight
+ */
+static bool in_flight_elsewhere(const kat_inject_t *kat, int chain, int chip, int core,
+                                uint32_t nonce) {
+    for (int ch = 0; ch < MAX_CHAINS; ch++) {
+        if (ch == chain || chip >= kat->num_chips[ch]) {
+            continue;
+        }
+        const kat_core_t *kc = &kat->core[ch][chip][core];
+        if (kc->deadline_ms != 0 && kc->expect == nonce) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Build and send one probe packet for a chip
+ * Returns: 1 if sent, 0 if the chip has nothing to probe now, -1 on error
+ */
+static int send_probe(kat_inject_t *kat, bm1398_context_t *ctx, int chain, int chip,
+                      uint64_t now_ms) {
+    // Cores whose last probe is still in flight keep it until it settles
+    const kat_core_t *cores = kat->core[chain][chip];
+    const int slot = kat->next_slot[chain][chip];
+    int first_core = kat->next_core[chain][chip];
+    while (first_core < PATTERN_CORES && cores[first_core].deadline_ms != 0) {
+        first_core++;
+    }
+
+    // Consecutive cores of the current slot, while they share work_data and
+    // no other chain waits for the same nonce
+    const pattern_bundle_entry_t *e[KAT_MIDSTATE_SLOTS];
+    int count = 0;
+    while (count < KAT_MIDSTATE_SLOTS && first_core + count < PATTERN_CORES &&
+           cores[first_core + count].deadline_ms == 0) {
+        const pattern_bundle_entry_t *entry =
+            pattern_bundle_get(kat->bundle, chip, first_core + count, slot);
+        if (!entry || (count > 0 &&
+                       memcmp(entry->work_data_be, e[0]->work_data_be,
+                              sizeof(entry->work_data_be)) != 0)) {
+            break;
+        }
+        if (in_flight_elsewhere(kat, chain, chip, first_core + count, entry->nonce)) {
+            if (count == 0) {
+                return 0;   // Retry once the other chain's probe settles
+            }
+            break;
+        }
+        e[count++] = entry;
+    }
+    if (count == 0) {
+        // Rest of this pass is in flight: start the next one
+        kat->next_core[chain][chip] = 0;
+        kat->next_slot[chain][chip] = (slot + 1) % PATTERN_SLOTS_PER_CORE;
+        return 0;
+    }
+
+    // Unused midstate slots repeat the first pattern
+    const uint32_t *midstates[KAT_MIDSTATE_SLOTS];
+    for (int m = 0; m < KAT_MIDSTATE_SLOTS; m++) {
+        midstates[m] = e[m < count ? m : 0]->midstate_be;
+    }
+
+    // Arm before sending: the nonce may come back immediately
+    for (int m = 0; m < count; m++) {
+        kat_core_t *core = &kat->core[chain][chip][first_core + m];
+        core->expect = e[m]->nonce;
+        core->deadline_ms = now_ms + KAT_DEADLINE_MS;
+    }
+    if (bm1398_send_work_swapped(ctx, chain, KAT_WORK_ID, e[0]->work_data_be, midstates) < 0) {
+        for (int m = 0; m < count; m++) {
+            kat->core[chain][chip][first_core + m].deadline_ms = 0;
+        }
+        return -1;
+    }
+
+    if (first_core + count >= PATTERN_CORES) {
+        kat->next_core[chain][chip] = 0;
+        kat->next_slot[chain][chip] = (slot + 1) % PATTERN_SLOTS_PER_CORE;
+    } else {
+        kat->next_core[chain][chip] = (uint8_t)(first_core + count);
+    }
+    kat->stats[chain].packets++;
+    kat->stats[chain].probes += count;
+    return 1;
+}
+
+/**
+ * Count overdue probes as misses and flag cores that keep missing
+ */
+static void expire_probes(kat_inject_t *kat, uint64_t now_ms) {
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        for (int chip = 0; chip < kat->num_chips[chain]; chip++) {
+            for (int c = 0; c < PATTERN_CORES; c++) {
+                kat_core_t *core = &kat->core[chain][chip][c];
+                if (core->deadline_ms == 0 || now_ms < core->deadline_ms) {
+                    continue;
+                }
+                core->deadline_ms = 0;
+                core->misses++;
+                kat->stats[chain].misses++;
+                if (core->streak < UINT8_MAX) {
+                    core->streak++;
+                }
+                if (!core->flagged && core->streak >= KAT_FLAG_STREAK) {
+                    core->flagged = true;
+                    kat->stats[chain].flagged++;
+                    printf("KAT: chain %d chip %d core %d (big %d, small %d) flagged after %d misses\n",
+                           chain, chip, c, c / 16, c % 16, core->streak);
+                }
+
+                kat_chip_t *kc = &kat->chip[chain][chip];
+                if (kc->streak < UINT8_MAX) {
+                    kc->streak++;
+                }
+                if (!kc->stuck && kc->streak >= KAT_STUCK_STREAK) {
+                    kc->stuck = true;
+                    printf("KAT: chain %d chip %d stuck (%d probes missed in a row)\n",
+                           chain, chip, kc->streak);
+                }
+            }
+
+            kat_chip_t *kc = &kat->chip[chain][chip];
+            if (kc->verify_deadline_ms != 0 && now_ms >= kc->verify_deadline_ms) {
+                kc->verify_deadline_ms = 0;
+                printf("KAT: chain %d chip %d still silent after reset\n", chain, chip);
+            }
+        }
+    }
+}
+
+int kat_inject_poll(kat_inject_t *kat, bm1398_context_t *ctx) {
+    const uint64_t now = now_us();
+    const uint64_t now_ms = now / 1000;
+    const uint32_t sweep_us = ctx->timing.sweep_us;
+    int sent = 0;
+
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const uint64_t elapsed = now - kat->last_us[chain];
+        kat->last_us[chain] = now;
+        if (kat->num_chips[chain] == 0 || kat->permille == 0 || sweep_us == 0) {
+            continue;
+        }
+
+        // One probe packet displaces one sweep of live work
+        kat->credit[chain] += elapsed * kat->permille / sweep_us;
+        if (kat->credit[chain] > KAT_MAX_BURST * 1000ULL) {
+            kat->credit[chain] = KAT_MAX_BURST * 1000ULL;
+        }
+
+        while (kat->credit[chain] >= 1000 && bm1398_check_work_fifo_ready(ctx) > 0) {
+            const int chip = next_probe_chip(kat, chain);
+            const int rc = chip < 0 ? 0 : send_probe(kat, ctx, chain, chip, now_ms);
+            if (rc < 0) {
+                return -1;
+            }
+            if (rc == 0) {
+                kat->credit[chain] = 0;
+                break;
+            }
+            kat->credit[chain] -= 1000;
+            sent++;
+        }
+    }
+
+    if (now_ms - kat->last_sweep_ms >= KAT_SWEEP_INTERVAL_MS) {
+        kat->last_sweep_ms = now_ms;
+        expire_probes(kat, now_ms);
+    }
+    return sent;
+}
+
+/**
+ * The probe in flight that expects this nonce, on whichever chain sent it
+ * Returns: true with *chain / *chip / *core set, or false if none
+ */
+static bool find_probe(const kat_inject_t *kat, uint32_t nonce, int *chain, int *chip,
+                       int *core) {
+    const uint8_t core_byte = (nonce >> 16) & 0xFF;
+    const int c = (core_byte >> 4) * 16 + (core_byte & 0xF);
+    if (c >= PATTERN_CORES) {
+        return false;
+    }
+
+    for (int ch = 0; ch < MAX_CHAINS; ch++) {
+        const uint8_t chp = kat->addr_to_chip[ch][nonce >> 24];
+        if (chp == KAT_NO_CHIP) {
+            continue;
+        }
+        const kat_core_t *kc = &kat->core[ch][chp][c];
+        if (kc->deadline_ms != 0 && kc->expect == nonce) {
+            *chain = ch;
+            *chip = chp;
+            *core = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool kat_inject_nonce(kat_inject_t *kat, uint32_t nonce) {
+    int chain, chip, c;
+    if (!find_probe(kat, nonce, &chain, &chip, &c)) {
+        return false;
+    }
+
+    kat_core_t *core = &kat->core[chain][chip][c];
+
+    core->deadline_ms = 0;
+    core->hits++;
+    core->streak = 0;
+    kat->stats[chain].hits++;
+
+    kat_chip_t *kc = &kat->chip[chain][chip];
+    kc->streak = 0;
+    kc->stuck = false;
+    if (kc->verify_deadline_ms != 0) {
+        kc->verify_deadline_ms = 0;
+        kat->stats[chain].chips_recovered++;
+        printf("KAT: chain %d chip %d answering again %llu ms after reset\n", chain, chip,
+               (unsigned long long)(now_us() / 1000 - kc->verify_sent_ms));
+    }
+    if (core->flagged) {
+        core->flagged = false;
+        kat->stats[chain].flagged--;
+        printf("KAT: chain %d chip %d core %d recovered\n", chain, chip, c);
+    }
+    return true;
+}
+
+//==============================================================================
+// Stuck Chips
+//==============================================================================
+
+bool kat_inject_next_stuck(kat_inject_t *kat, int *chain, int *chip) {
+    const uint64_t now_ms = now_us() / 1000;
+    for (int ch = 0; ch < MAX_CHAINS; ch++) {
+        for (int c = 0; c < kat->num_chips[ch]; c++) {
+            kat_chip_t *kc = &kat->chip[ch][c];
+            if (!kc->stuck || kc->verify_deadline_ms != 0 ||
+                (kc->reported_ms != 0 && now_ms - kc->reported_ms < KAT_STUCK_RETRY_MS)) {
+                continue;
+            }
+            kc->reported_ms = now_ms;
+            *chain = ch;
+            *chip = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+int kat_inject_verify_chip(kat_inject_t *kat, bm1398_context_t *ctx, int chain, int chip) {
+    if (chain < 0 || chain >= MAX_CHAINS || chip < 0 || chip >= kat->num_chips[chain]) {
+        return -1;
+    }
+
+    // Probes sent before the reset are moot: drop them without a miss
+    for (int c = 0; c < PATTERN_CORES; c++) {
+        kat->core[chain][chip][c].deadline_ms = 0;
+    }
+
+    const uint64_t now_ms = now_us() / 1000;
+    if (send_probe(kat, ctx, chain, chip, now_ms) <= 0) {
+        return -1;
+    }
+    kat_chip_t *kc = &kat->chip[chain][chip];
+    kc->verify_sent_ms = now_ms;
+    kc->verify_deadline_ms = now_ms + KAT_DEADLINE_MS;
+    kat->stats[chain].chip_resets++;
+    return 0;
+}
+
+//==============================================================================
+// Reporting
+//==============================================================================
+
+bool kat_inject_core_flagged(const kat_inject_t *kat, int chain, int chip, int core) {
+    if (chain < 0 || chain >= MAX_CHAINS || chip < 0 || chip >= KAT_MAX_CHIPS ||
+        core < 0 || core >= PATTERN_CORES) {
+        return false;
+    }
+    return kat->core[chain][chip][core].flagged;
+}
+
+void kat_inject_print(const kat_inject_t *kat) {
+    printf("Known-answer probes (%.1f%% of chain time):\n", kat->permille / 10.0);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (kat->num_chips[chain] == 0) {
+            continue;
+        }
+        const kat_chain_stats_t *s = &kat->stats[chain];
+        const uint64_t settled = s->hits + s->misses;
+        printf("  Chain %d: %llu probes, %llu hit, %llu missed", chain,
+               (unsigned long long)s->probes, (unsigned long long)s->hits,
+               (unsigned long long)s->misses);
+        if (settled > 0) {
+            printf(" (%.2f%% return)", s->hits * 100.0 / settled);
+        }
+        printf(", %d core%s flagged", s->flagged, s->flagged == 1 ? "" : "s");
+        if (s->chip_resets > 0) {
+            printf(", %u chip reset%s (%u recovered)", s->chip_resets,
+                   s->chip_resets == 1 ? "" : "s", s->chips_recovered);
+        }
+        printf("\n");
+
+        // Name the flagged cores, chip by chip
+        int listed = 0;
+        for (int chip = 0; chip < kat->num_chips[chain] && listed < s->flagged; chip++) {
+            int on_chip = 0;
+            for (int c = 0; c < PATTERN_CORES; c++) {
+                if (!kat->core[chain][chip][c].flagged) {
+                    continue;
+                }
+                if (on_chip++ == 0) {
+                    printf("    Chip %3d cores: %d", chip, c);
+                } else {
+                    printf(", %d", c);
+                }
+                listed++;
+            }
+            if (on_chip > 0) {
+                printf("\n");
+            }
+        }
+    }
+}
@@ -1,3 +1,563 @@
-int main() {
-    return 0;
+/*
+ * HashSource X19 Miner
+ *
+ * Brings up every detected hashboard and runs the service loop: drain the
+ * nonce FIFO into the hashrate estimator, sample chip temperatures without
+ * blocking, run the closed-loop fan controller and recover failing chains.
+ * Pool connection and work generation are not wired in yet.
+ *
+ * Usage: hashsource_miner [--board NAME] [--kat-bundle PATH] [--kat-permille N]
+ *                         [--boot-trace PATH] [--diode-temps] [--chain-attribution]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include "../include/bm1398_asic.h"
+#include "../include/temp_monitor.h"
+#include "../include/fan_control.h"
+#include "../include/hashrate.h"
+#include "../include/kat_inject.h"
+#include "../include/core_yield.h"
+#include "../include/hotplug.h"
+#include "../include/chain_supervisor.h"
+#include "../include/boot_trace.h"
+#include "../include/startup.h"
+#include "../include/fpga_service.h"
+
+// Power sequencing (voltages come from the board profile)
+#define DC_DC_SETTLE_MS         1000    // After the PIC confirms
+#define FAN_SPINUP_MS           3000    // Full PWM until tach is checked
+#define FAN_SAMPLE_MS           100
+
+// Service loop timing
+#define LOOP_SLEEP_US           1000
+#define STATUS_INTERVAL_S       10
+#define FAN_UPDATE_MS           1000
+#define HASHRATE_TICK_MS        1000
+
+// Known-answer probes (pattern_pack output)
+#define KAT_BUNDLE_PATH         "/tmp/BM1398-pattern/" PATTERN_BUNDLE_DEFAULT_NAME
+
+static volatile int g_shutdown = 0;
+
+static void signal_handler(int sig) {
+    printf("\nReceived signal %d, shutting down...\n", sig);
+    g_shutdown = 1;
+}
+
+typedef struct {
+    bm1398_context_t *ctx;
+    fan_control_t *fans;
+    bool warm;                          // PSU already on: only set the voltage
+    bool dc_dc_sent[MAX_CHAINS];
+} bring_up_t;
+
+//==============================================================================
+// Startup Tasks (startup.h)
+//==============================================================================
+
+static startup_result_t psu_on_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    bring_up_t *b = arg;
+    (void)chain;
+    (void)step;
+    (void)wait_ms;
+
+    if (b->warm) {
+        if (bm1398_psu_adopt(b->ctx, b->ctx->profile->operating_mv) < 0) {
+            fprintf(stderr, "Warning: PSU not reachable, keeping its current voltage\n");
+        }
+        return STARTUP_DONE;
+    }
+    if (bm1398_psu_adopt(b->ctx, b->ctx->profile->power_on_mv) < 0 ||
+        bm1398_psu_enable(b->ctx) < 0) {
+        fprintf(stderr, "Error: Failed to power on PSU\n");
+        return STARTUP_FAILED;
+    }
+    return STARTUP_DONE;
+}
+
+static startup_result_t psu_settle_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    (void)arg;
+    (void)chain;
+    if (step == 0) {
+        *wait_ms = PSU_SETTLE_MS;
+        return STARTUP_NEXT;
+    }
+    return STARTUP_DONE;
+}
+
+/**
+ * PIC DC-DC enable, then let the board's power stabilize. A failure is
+ * only noted: the converter may already be on.
+ */
+static startup_result_t dc_dc_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    bring_up_t *b = arg;
+
+    switch (step) {
+    case 0:
+        b->dc_dc_sent[chain] = bm1398_dc_dc_request(b->ctx, chain) == 0;
+        if (!b->dc_dc_sent[chain]) {
+            printf("Note: Chain %d DC-DC enable failed (may already be enabled)\n", chain);
+        }
+        *wait_ms = b->dc_dc_sent[chain] ? PIC_DC_DC_WAIT_MS : 0;
+        return STARTUP_NEXT;
+    case 1:
+        if (b->dc_dc_sent[chain] && bm1398_dc_dc_confirm(b->ctx, chain) < 0) {
+            printf("Note: Chain %d DC-DC enable failed (may already be enabled)\n", chain);
+        }
+        *wait_ms = DC_DC_SETTLE_MS;
+        return STARTUP_NEXT;
+    default:
+        return STARTUP_DONE;
+    }
+}
+
+static startup_result_t eeprom_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    bring_up_t *b = arg;
+    (void)step;
+    (void)wait_ms;
+
+    // Board identity only; an unreadable EEPROM does not stop the chain
+    bm1398_load_eeprom(b->ctx, chain);
+    return STARTUP_DONE;
+}
+
+/**
+ * Sample the tachometers while the fans spin up from full PWM, then report
+ * which fans turn. Not fatal: the fan controller's stall check takes over.
+ */
+static startup_result_t fan_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    bring_up_t *b = arg;
+    (void)chain;
+
+    fan_control_sample_tach(b->fans);
+    if (step < FAN_SPINUP_MS / FAN_SAMPLE_MS) {
+        *wait_ms = FAN_SAMPLE_MS;
+        return STARTUP_NEXT;
+    }
+
+    int turning = 0;
+    printf("Fans:");
+    for (int i = 0; i < FAN_NUM; i++) {
+        printf(" %d", b->fans->rpm[i]);
+        turning += b->fans->rpm[i] >= FAN_STALL_RPM;
+    }
+    printf(" RPM (%d of %d turning)\n", turning, FAN_NUM);
+    if (turning == 0) {
+        fprintf(stderr, "Warning: No fan reports its speed\n");
+    }
+    return STARTUP_DONE;
+}
+
+static startup_result_t chain_init_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    bm1398_context_t *ctx = ((bring_up_t *)arg)->ctx;
+    (void)step;
+    (void)wait_ms;
+
+    if (bm1398_init_chain(ctx, chain) < 0) {
+        fprintf(stderr, "Warning: Chain %d initialization failed\n", chain);
+        bm1398_detach_chain(ctx, chain);
+        return STARTUP_FAILED;
+    }
+    return STARTUP_DONE;
+}
+
+static startup_result_t voltage_step(void *arg, int chain, int step, uint32_t *wait_ms) {
+    bm1398_context_t *ctx = ((bring_up_t *)arg)->ctx;
+    (void)chain;
+    (void)step;
+    (void)wait_ms;
+
+    if (bm1398_psu_set_voltage(ctx, ctx->profile->operating_mv) < 0) {
+        fprintf(stderr, "Warning: Failed to reduce voltage to %u mV\n",
+                ctx->profile->operating_mv);
+    }
+    return STARTUP_DONE;
+}
+
+/**
+ * Snapshot for fpgactl and other FPGA service clients
+ */
+static void publish_stats(fpga_service_t *svc, const bm1398_context_t *ctx,
+                          const hashrate_t *rates, const temp_monitor_t *temps,
+                          const fan_control_t *fans) {
+    fpga_stat_t stat = {0};
+    stat.plugged = ctx->fpga_regs[REG_HASH_ON_PLUG];
+    stat.crc_errors = ctx->fpga_regs[REG_CRC_ERROR_CNT_ADDR];
+    hashrate_estimate_t est;
+    if (hashrate_get(rates, -1, -1, HASHRATE_WIN_1M, &est) == 0) {
+        stat.ghs_total = (float)est.ghs;
+    }
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (ctx->chips_per_chain[chain] == 0) {
+            continue;
+        }
+        stat.hashing |= 1u << chain;
+
+        if (hashrate_get(rates, chain, -1, HASHRATE_WIN_1M, &est) == 0) {
+            stat.ghs_valid |= 1u << chain;
+            stat.ghs[chain] = (float)est.ghs;
+        }
+        float temp;
+        if (temp_monitor_chain_max(temps, chain, &temp) == 0) {
+            stat.temp_valid |= 1u << chain;
+            stat.temp_c[chain] = temp;
+        }
+    }
+    for (int i = 0; i < FAN_NUM; i++) {
+        stat.fan_rpm[i] = fans->rpm[i];
+    }
+    stat.fan_pct = fans->ch[FAN_CH_MAIN].output;
+    fpga_service_publish(svc, &stat);
+}
+
+/**
+ * Power up and initialize all detected chains
+ *
+ * On a warm start the chains a previous run left configured are adopted
+ * first. Everything else runs as a startup graph: PSU power-on, then the
+ * PIC DC-DC enables, the PSU rail settle, EEPROM reads and the fan spin-up
+ * check overlap, and each chain is initialized once its power is up.
+ * Returns: number of chains ready, or -1 on PSU failure
+ */
+static int bring_up_chains(bm1398_context_t *ctx, fan_control_t *fans) {
+    uint32_t adopted = 0;
+    if (ctx->warm_start) {
+        for (int chain = 0; chain < MAX_CHAINS; chain++) {
+            if (ctx->chips_per_chain[chain] > 0 && bm1398_adopt_chain(ctx, chain) == 0) {
+                adopted |= 1u << chain;
+            }
+        }
+        if (adopted == 0) {
+            printf("No chain kept its configuration, cold start\n");
+        }
+    }
+
+    bring_up_t b = { .ctx = ctx, .fans = fans, .warm = adopted != 0 };
+    startup_graph_t g;
+    startup_init(&g);
+
+    // Ready tasks run in this order: start the long waits first
+    int dc_dc[MAX_CHAINS], eeprom[MAX_CHAINS], init[MAX_CHAINS];
+    const int psu = startup_add(&g, b.warm ? "psu adopt" : "psu power on", BOOT_TRACE_NO_CHAIN,
+                                psu_on_step, &b, 0, 0);
+    const int settle = b.warm ? -1 :
+        startup_add(&g, "psu settle", BOOT_TRACE_NO_CHAIN, psu_settle_step, &b,
+                    STARTUP_BIT(psu), 0);
+    const int fan = startup_add(&g, "fan spin-up", BOOT_TRACE_NO_CHAIN, fan_step, &b, 0, 0);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const bool needed = ctx->chips_per_chain[chain] > 0 && !(adopted & (1u << chain));
+        dc_dc[chain] = needed ?
+            startup_add(&g, "dc-dc enable", chain, dc_dc_step, &b, STARTUP_BIT(psu), 0) : -1;
+    }
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        eeprom[chain] = ctx->chips_per_chain[chain] > 0 ?
+            startup_add(&g, "eeprom", chain, eeprom_step, &b, 0, 0) : -1;
+    }
+    uint32_t inits = 0;
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        init[chain] = dc_dc[chain] < 0 ? -1 :
+            startup_add(&g, "chain init", chain, chain_init_step, &b,
+                        STARTUP_BIT(psu) | STARTUP_BIT(settle),
+                        STARTUP_BIT(dc_dc[chain]) | STARTUP_BIT(eeprom[chain]) |
+                        STARTUP_BIT(fan));
+        inits |= STARTUP_BIT(init[chain]);
+    }
+    if (!b.warm) {
+        startup_add(&g, "psu voltage", BOOT_TRACE_NO_CHAIN, voltage_step, &b,
+                    STARTUP_BIT(settle), inits);
+    }
+
+    startup_run(&g);
+    startup_print(&g);
+    if (!startup_succeeded(&g, psu)) {
+        return -1;
+    }
+
+    int ready = 0;
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        ready += (adopted & (1u << chain)) || startup_succeeded(&g, init[chain]);
+    }
+    return ready;
+}
+
+int main(int argc, char *argv[]) {
+    const char *kat_bundle = KAT_BUNDLE_PATH;
+    int kat_permille = KAT_DEFAULT_PERMILLE;
+    const char *trace_path = NULL;
+    bool diode_temps = false;
+    bool chain_attribution = false;
+    const board_profile_t *profile = board_profile_find(NULL);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--board") == 0 && i + 1 < argc &&
+            (profile = board_profile_find(argv[i + 1])) != NULL) {
+            i++;
+        } else if (strcmp(argv[i], "--kat-bundle") == 0 && i + 1 < argc) {
+            kat_bundle = argv[++i];
+        } else if (strcmp(argv[i], "--kat-permille") == 0 && i + 1 < argc) {
+            kat_permille = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--boot-trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--diode-temps") == 0) {
+            diode_temps = true;
+        } else if (strcmp(argv[i], "--chain-attribution") == 0) {
+            chain_attribution = true;
+        } else {
+            printf("Usage: %s [--board NAME] [--kat-bundle PATH] [--kat-permille N]"
+                   " [--boot-trace PATH] [--diode-temps] [--chain-attribution]\n", argv[0]);
+            printf("  --board NAME       Hashboard model (default: %s)\n", BOARD_PROFILE_DEFAULT);
+            printf("  --kat-bundle PATH  Known-answer patterns (default: %s)\n", KAT_BUNDLE_PATH);
+            printf("  --kat-permille N   Chain time spent on probes, 0-%d (default: %d)\n",
+                   KAT_MAX_PERMILLE, KAT_DEFAULT_PERMILLE);
+            printf("  --boot-trace PATH  Write the startup timeline as Chrome trace JSON\n");
+            printf("  --diode-temps      Use on-die diode readings for fan control (unverified scaling)\n");
+            printf("  --chain-attribution  Per-chain hashrate, core yield and nonce stall checks by\n"
+                   "                       the FIFO chain number (unverified)\n");
+            printf("Boards:\n");
+            board_profile_list();
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ?
+                   EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    boot_trace_start();
+    bm1398_context_t ctx;
+    int trace = boot_trace_begin("driver init", BOOT_TRACE_NO_CHAIN);
+    if (bm1398_init_ex(&ctx, BM1398_INIT_WARM | BM1398_INIT_NO_EEPROM, profile) < 0) {
+        fprintf(stderr, "Error: Failed to initialize BM1398 driver\n");
+        return EXIT_FAILURE;
+    }
+    boot_trace_end(trace);
+
+    // Fans start at full speed and only slow down once temperatures arrive
+    fan_control_t fans;
+    fan_control_init(&fans, ctx.fpga_regs);
+
+    trace = boot_trace_begin("chain bring-up", BOOT_TRACE_NO_CHAIN);
+    const int ready = bring_up_chains(&ctx, &fans);
+    boot_trace_end(trace);
+    boot_trace_stop();
+    boot_trace_print();
+    if (trace_path && boot_trace_write_json(trace_path) == 0) {
+        printf("Startup timeline written to %s\n", trace_path);
+    }
+    if (ready < 0) {
+        bm1398_cleanup(&ctx);
+        return EXIT_FAILURE;
+    }
+    if (ready == 0) {
+        printf("No chains ready, waiting for a hashboard\n\n");
+    } else {
+        printf("%d chain(s) ready\n\n", ready);
+    }
+
+    temp_monitor_t temps;
+    temp_monitor_init(&temps, &ctx, diode_temps);
+    if (!diode_temps) {
+        printf("On-die temperatures off (--diode-temps to enable), fans held at 100%%\n");
+    }
+
+    // Static: per-chip counters for every chain are too large for the stack
+    static hashrate_t rates;
+    hashrate_init(&rates, hashrate_difficulty_from_mask(TICKET_MASK_256_CORES),
+                  chain_attribution);
+    if (!chain_attribution) {
+        printf("Per-chain hashrate, yield and stall checks off (--chain-attribution to enable)\n");
+    }
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const int chips = ctx.chips_per_chain[chain];
+        hashrate_set_chain(&rates, chain, chips, work_timing_interval(chips));
+    }
+
+    // Per-chip/per-core nonce shares for the dead-core and weak-chip tests.
+    // Shares are per chain, so they need --chain-attribution too.
+    static core_yield_t yield;
+    core_yield_init(&yield);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        const int chips = ctx.chips_per_chain[chain];
+        core_yield_set_chain(&yield, chain, chips, work_timing_interval(chips));
+    }
+
+    // Probes are optional: without a bundle the miner runs unmonitored
+    static pattern_bundle_t kat_patterns;
+    static kat_inject_t kat;
+    const bool kat_enabled = kat_permille > 0 &&
+                             pattern_bundle_open(&kat_patterns, kat_bundle) == 0;
+    if (kat_enabled) {
+        kat_inject_init(&kat, &kat_patterns, kat_permille);
+        for (int chain = 0; chain < MAX_CHAINS; chain++) {
+            const int chips = ctx.chips_per_chain[chain];
+            kat_inject_set_chain(&kat, chain, chips, work_timing_interval(chips));
+        }
+        printf("Known-answer probes: %.1f%% of chain time from %s\n\n",
+               kat.permille / 10.0, kat_bundle);
+    } else {
+        printf("Known-answer probes disabled\n\n");
+    }
+
+    // Boards inserted or removed from here on
+    static hotplug_t boards;
+    hotplug_init(&boards, &ctx);
+
+    // Per-chain fault detection and recovery
+    static chain_supervisor_t supervisor;
+    chain_supervisor_init(&supervisor, &ctx, &temps, chain_attribution);
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (ctx.chips_per_chain[chain] > 0) {
+            chain_supervisor_chain_up(&supervisor, chain);
+        }
+    }
+
+    // Other tools reach the FPGA through this process while it runs
+    static fpga_service_t service;
+    if (fpga_service_open(&service, ctx.fpga_regs, &ctx.i2c, "hashsource_miner") < 0) {
+        fprintf(stderr, "Warning: FPGA service unavailable, fpgactl cannot attach\n");
+    }
+
+    nonce_response_t nonces[100];
+    time_t last_status = time(NULL);
+    struct timespec last_fan, last_rate;
+    clock_gettime(CLOCK_MONOTONIC, &last_fan);
+    last_rate = last_fan;
+
+    while (!g_shutdown) {
+        // Drain first: register responses for the sampler arrive here too
+        int read = bm1398_read_nonces(&ctx, nonces, 100);
+        for (int i = 0; i < read; i++) {
+            // Probe answers are real hashing work: they count toward hashrate
+            // but must not be submitted as shares
+            if (kat_enabled) {
+                kat_inject_nonce(&kat, nonces[i].nonce);
+            }
+            hashrate_add_nonce(&rates, nonces[i].chain_id, nonces[i].nonce);
+            if (chain_attribution) {
+                core_yield_add(&yield, nonces[i].chain_id, nonces[i].nonce);
+            }
+            chain_supervisor_nonce(&supervisor, nonces[i].chain_id);
+        }
+        if (kat_enabled && kat_inject_poll(&kat, &ctx) < 0) {
+            fprintf(stderr, "Warning: Failed to send known-answer probe\n");
+        }
+
+        temp_monitor_poll(&temps);
+        fan_control_sample_tach(&fans);
+
+        // Client commands run here, between the miner's own register accesses
+        fpga_service_poll(&service);
+        if (fpga_service_stat_due(&service)) {
+            publish_stats(&service, &ctx, &rates, &temps, &fans);
+        }
+
+        // Chains that joined or left: rebuild their tables (0 chips while away)
+        uint32_t added, removed;
+        hotplug_poll(&boards, &added, &removed);
+        for (int chain = 0; chain < MAX_CHAINS; chain++) {
+            if (!((added | removed) & (1u << chain))) {
+                continue;
+            }
+            const int chips = (added & (1u << chain)) ? ctx.chips_per_chain[chain] : 0;
+            const int interval = work_timing_interval(chips);
+            hashrate_set_chain(&rates, chain, chips, interval);
+            core_yield_set_chain(&yield, chain, chips, interval);
+            if (kat_enabled) {
+                kat_inject_set_chain(&kat, chain, chips, interval);
+            }
+            temp_monitor_set_chain(&temps, chain, chips);
+
+            if (added & (1u << chain)) {
+                chain_supervisor_chain_up(&supervisor, chain);
+            } else if (boards.chain[chain].state == HOTPLUG_ABSENT) {
+                chain_supervisor_chain_gone(&supervisor, chain);
+            }
+        }
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        if ((ts.tv_sec - last_rate.tv_sec) * 1000 +
+            (ts.tv_nsec - last_rate.tv_nsec) / 1000000 >= HASHRATE_TICK_MS) {
+            last_rate = ts;
+            hashrate_tick(&rates);
+
+            const uint32_t faulty = chain_supervisor_tick(&supervisor);
+            for (int chain = 0; chain < MAX_CHAINS; chain++) {
+                if (faulty & (1u << chain)) {
+                    hotplug_recover(&boards, chain);
+                }
+            }
+
+            // Chips that stopped answering probes: reset them alone
+            int stuck_chain, stuck_chip;
+            while (kat_enabled && kat_inject_next_stuck(&kat, &stuck_chain, &stuck_chip)) {
+                const int interval = work_timing_interval(ctx.chips_per_chain[stuck_chain]);
+                if (bm1398_reset_chip(&ctx, stuck_chain, (uint8_t)(stuck_chip * interval)) == 0 &&
+                    kat_inject_verify_chip(&kat, &ctx, stuck_chain, stuck_chip) < 0) {
+                    fprintf(stderr, "Warning: Failed to verify chain %d chip %d\n",
+                            stuck_chain, stuck_chip);
+                }
+            }
+
+            core_yield_tick(&yield);
+            core_yield_event_t ev;
+            while (core_yield_next_event(&yield, &ev)) {
+                printf("Yield: chain %d chip %d", ev.chain, ev.chip);
+                if (ev.core != CORE_YIELD_NO_CORE) {
+                    printf(" core %d", ev.core);
+                }
+                printf(": %s (%u nonces, expected %.1f, statistic %.1f)\n",
+                       core_yield_event_name(ev.type), ev.observed, ev.expected,
+                       ev.statistic);
+            }
+        }
+
+        if ((ts.tv_sec - last_fan.tv_sec) * 1000 +
+            (ts.tv_nsec - last_fan.tv_nsec) / 1000000 >= FAN_UPDATE_MS) {
+            last_fan = ts;
+
+            // Control on the hottest fresh sensor across all chains
+            float hottest = 0.0f;
+            bool valid = false;
+            for (int chain = 0; chain < MAX_CHAINS; chain++) {
+                float t;
+                if (temp_monitor_chain_max(&temps, chain, &t) == 0 &&
+                    (!valid || t > hottest)) {
+                    hottest = t;
+                    valid = true;
+                }
+            }
+            fan_control_update(&fans, hottest, valid);
+        }
+
+        const time_t now = time(NULL);
+        if (now - last_status >= STATUS_INTERVAL_S) {
+            last_status = now;
+            printf("Hashrate:\n");
+            hashrate_print(&rates);
+            temp_monitor_print(&temps);
+            fan_control_print(&fans);
+            hotplug_print(&boards);
+            chain_supervisor_print(&supervisor);
+            if (chain_attribution) {
+                core_yield_print(&yield);
+            }
+            if (kat_enabled) {
+                kat_inject_print(&kat);
+            }
+        }
+
+        usleep(LOOP_SLEEP_US);
+    }
+
+    fpga_service_close(&service);
+    temp_monitor_cleanup(&temps);
+    pattern_bundle_close(&kat_patterns);
+    bm1398_cleanup(&ctx);
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,222 @@
+/*
+ * Compact Pattern Bundle Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/pattern_bundle.h"
+#include "../include/crc32.h"
+
+_Static_assert(sizeof(pattern_bundle_entry_t) == 48, "bundle entry must be 48 bytes");
+_Static_assert(sizeof(pattern_bundle_header_t) == 64, "bundle header must be 64 bytes");
+
+static size_t entry_index(const pattern_bundle_header_t *h, int chip, int core, int slot) {
+    return ((size_t)chip * h->cores + core) * h->slots + slot;
+}
+
+//==============================================================================
+// Runtime Access
+//==============================================================================
+
+/**
+ * Map and validate a bundle
+ * Returns: 0 on success, -1 on error
+ */
+int pattern_bundle_open(pattern_bundle_t *b, const char *path) {
+    memset(b, 0, sizeof(*b));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open pattern bundle %s: %s\n",
+                path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(pattern_bundle_header_t)) {
+        fprintf(stderr, "Error: Pattern bundle %s is truncated\n", path);
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    const pattern_bundle_header_t *h = base;
+    const char *why = NULL;
+    if (memcmp(h->magic, PATTERN_BUNDLE_MAGIC, 4) != 0) {
+        why = "bad magic";
+    } else if (h->version != PATTERN_BUNDLE_VERSION) {
+        why = "unsupported version";
+    } else if (h->header_crc != crc32_calc(base, offsetof(pattern_bundle_header_t, header_crc))) {
+        why = "header checksum mismatch";
+    } else if (h->header_size < sizeof(*h) || h->header_size % 16 != 0 ||
+               h->entry_size != sizeof(pattern_bundle_entry_t) ||
+               h->num_chips > PATTERN_MAX_CHIPS ||
+               h->cores != PATTERN_CORES || h->slots != PATTERN_SLOTS_PER_CORE) {
+        why = "unexpected geometry";
+    } else if (size != h->header_size +
+               (size_t)h->num_chips * h->cores * h->slots * h->entry_size) {
+        why = "size does not match header";
+    } else if (h->payload_crc != crc32_calc((const uint8_t *)base + h->header_size,
+                                            size - h->header_size)) {
+        why = "payload checksum mismatch";
+    }
+
+    if (why) {
+        fprintf(stderr, "Error: Pattern bundle %s: %s\n", path, why);
+        munmap(base, size);
+        return -1;
+    }
+
+    b->base = base;
+    b->size = size;
+    b->hdr = h;
+    b->entries = (const pattern_bundle_entry_t *)((const uint8_t *)base + h->header_size);
+    return 0;
+}
+
+void pattern_bundle_close(pattern_bundle_t *b) {
+    if (b->base) {
+        munmap((void *)b->base, b->size);
+    }
+    memset(b, 0, sizeof(*b));
+}
+
+bool pattern_bundle_has_chip(const pattern_bundle_t *b, int chip) {
+    if (!b->hdr || chip < 0 || chip >= b->hdr->num_chips) {
+        return false;
+    }
+    return (b->hdr->chip_present[chip / 32] >> (chip % 32)) & 1;
+}
+
+const pattern_bundle_entry_t *pattern_bundle_get(const pattern_bundle_t *b,
+                                                 int chip, int core, int slot) {
+    if (!pattern_bundle_has_chip(b, chip) ||
+        core < 0 || core >= b->hdr->cores || slot < 0 || slot >= b->hdr->slots) {
+        return NULL;
+    }
+    return &b->entries[entry_index(b->hdr, chip, core, slot)];
+}
+
+//==============================================================================
+// Conversion
+//==============================================================================
+
+// Index of an entry in a bundle with the standard geometry
+static size_t entry_slot(int chip, int core, int slot) {
+    return ((size_t)chip * PATTERN_CORES + core) * PATTERN_SLOTS_PER_CORE + slot;
+}
+
+// Same word order bm1398_send_work() produces after its in-place swap
+static void swap_words(uint32_t *dst, const uint8_t *src, int num_words) {
+    for (int i = 0; i < num_words; i++) {
+        uint32_t w;
+        memcpy(&w, src + i * 4, 4);
+        dst[i] = __builtin_bswap32(w);
+    }
+}
+
+/**
+ * Write prepared entries[num_chips][cores][slots] as a bundle, atomically
+ * Returns: 0 on success, -1 on error
+ */
+int pattern_bundle_write_entries(const char *path, const pattern_bundle_entry_t *entries,
+                                 int num_chips, const uint32_t *chip_present) {
+    if (num_chips <= 0 || num_chips > PATTERN_MAX_CHIPS) {
+        return -1;
+    }
+
+    const size_t payload = (size_t)num_chips * PATTERNS_PER_CHIP * sizeof(pattern_bundle_entry_t);
+    pattern_bundle_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, PATTERN_BUNDLE_MAGIC, 4);
+    hdr.version = PATTERN_BUNDLE_VERSION;
+    hdr.header_size = sizeof(hdr);
+    hdr.num_chips = num_chips;
+    hdr.cores = PATTERN_CORES;
+    hdr.slots = PATTERN_SLOTS_PER_CORE;
+    hdr.entry_size = sizeof(pattern_bundle_entry_t);
+    memcpy(hdr.chip_present, chip_present, sizeof(hdr.chip_present));
+    hdr.payload_crc = crc32_calc((const uint8_t *)entries, payload);
+    hdr.header_crc = crc32_calc((const uint8_t *)&hdr,
+                                offsetof(pattern_bundle_header_t, header_crc));
+
+    char tmp_path[320];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    const int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", tmp_path, strerror(errno));
+        return -1;
+    }
+    const bool ok = write(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr) &&
+                    write(fd, entries, payload) == (ssize_t)payload;
+    fsync(fd);
+    close(fd);
+
+    if (!ok || rename(tmp_path, path) < 0) {
+        fprintf(stderr, "Error: Failed to write pattern bundle %s\n", path);
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Build a bundle from the pattern files and write it atomically
+ */
+int pattern_bundle_write(const char *path, pattern_set_t *ps, int num_chips) {
+    if (num_chips <= 0 || num_chips > PATTERN_MAX_CHIPS) {
+        return -1;
+    }
+
+    const size_t payload = (size_t)num_chips * PATTERNS_PER_CHIP * sizeof(pattern_bundle_entry_t);
+    pattern_bundle_entry_t *entries = calloc(1, payload);
+    if (!entries) {
+        fprintf(stderr, "Error: Failed to allocate %zu byte bundle\n", payload);
+        return -1;
+    }
+
+    uint32_t chip_present[PATTERN_MAX_CHIPS / 32] = {0};
+    int packed = 0;
+    for (int chip = 0; chip < num_chips; chip++) {
+        if (pattern_set_map(ps, chip) < 0) {
+            continue;   // Already reported; chip stays absent
+        }
+        for (int core = 0; core < PATTERN_CORES; core++) {
+            for (int slot = 0; slot < PATTERN_SLOTS_PER_CORE; slot++) {
+                const test_pattern_t *p = pattern_get(ps, chip, core, slot);
+                pattern_bundle_entry_t *e = &entries[entry_slot(chip, core, slot)];
+                swap_words(e->work_data_be, p->work_data, 3);
+                swap_words(e->midstate_be, p->midstate, 8);
+                e->nonce = p->nonce;
+            }
+        }
+        chip_present[chip / 32] |= 1u << (chip % 32);
+        packed++;
+    }
+
+    if (packed == 0) {
+        fprintf(stderr, "Error: No pattern files found in %s\n", ps->dir);
+        free(entries);
+        return -1;
+    }
+
+    const int rc = pattern_bundle_write_entries(path, entries, num_chips, chip_present);
+    free(entries);
+    return rc < 0 ? -1 : packed;
+}
@@ -0,0 +1,124 @@
+/*
+ * Pattern File Access Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/pattern_file.h"
+
+//==============================================================================
+// Setup
+//==============================================================================
+
+/**
+ * Initialize a pattern set; no files are opened until used
+ */
+void pattern_set_init(pattern_set_t *ps, const char *dir) {
+    memset(ps, 0, sizeof(*ps));
+    snprintf(ps->dir, sizeof(ps->dir), "%s", dir ? dir : PATTERN_DEFAULT_DIR);
+
+    // Factory test reads entries back to back: core-major, 8 slots per core
+    for (int core = 0; core < PATTERN_CORES; core++) {
+        for (int slot = 0; slot < PATTERN_SLOTS_PER_CORE; slot++) {
+            ps->index[core][slot] =
+                (uint32_t)(core * PATTERN_SLOTS_PER_CORE + slot) * PATTERN_ENTRY_SIZE;
+        }
+    }
+    ps->min_size = (size_t)PATTERNS_PER_CHIP * PATTERN_ENTRY_SIZE;
+}
+
+void pattern_set_close(pattern_set_t *ps) {
+    for (int chip = 0; chip < PATTERN_MAX_CHIPS; chip++) {
+        pattern_file_t *f = &ps->files[chip];
+        if (f->base) {
+            munmap((void *)f->base, f->size);
+        }
+        f->base = NULL;
+        f->size = 0;
+        f->failed = 0;
+    }
+}
+
+/**
+ * Map btc-asic-NNN.bin read-only and check its size
+ * Returns: 0 on success, -1 on error (reported once)
+ */
+int pattern_set_map(pattern_set_t *ps, int chip) {
+    if (chip < 0 || chip >= PATTERN_MAX_CHIPS) {
+        return -1;
+    }
+
+    pattern_file_t *f = &ps->files[chip];
+    if (f->base) {
+        return 0;
+    }
+    if (f->failed) {
+        return -1;
+    }
+    f->failed = 1;
+
+    char filename[320];
+    snprintf(filename, sizeof(filename), "%s/btc-asic-%03d.bin", ps->dir, chip);
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open pattern file %s: %s\n",
+                filename, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "Error: Cannot stat %s: %s\n", filename, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    const size_t size = (size_t)st.st_size;
+    if (size < ps->min_size) {
+        fprintf(stderr, "Error: Pattern file %s too small (%zu < %zu bytes)\n",
+                filename, size, ps->min_size);
+        close(fd);
+        return -1;
+    }
+    if (size != PATTERN_FILE_SIZE) {
+        printf("Note: %s is %zu bytes (stock files are %d)\n",
+               filename, size, PATTERN_FILE_SIZE);
+    }
+
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map %s: %s\n", filename, strerror(errno));
+        return -1;
+    }
+
+    // Only the leading entries are used, in order
+    madvise(base, ps->min_size, MADV_SEQUENTIAL);
+
+    f->base = base;
+    f->size = size;
+    f->failed = 0;
+    return 0;
+}
+
+//==============================================================================
+// Access
+//==============================================================================
+
+const test_pattern_t *pattern_get(pattern_set_t *ps, int chip, int core, int slot) {
+    if (core < 0 || core >= PATTERN_CORES ||
+        slot < 0 || slot >= PATTERN_SLOTS_PER_CORE) {
+        return NULL;
+    }
+    if (pattern_set_map(ps, chip) < 0) {
+        return NULL;
+    }
+    return (const test_pattern_t *)(ps->files[chip].base + ps->index[core][slot]);
+}
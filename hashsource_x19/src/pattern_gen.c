@@ -0,0 +1,552 @@
+/*
+ * Pattern Generator (host tool)
+ *
+ * Searches for test patterns with known nonces so we are not limited to
+ * Bitmain's btc-asic-NNN.bin files. For every chip and core it finds
+ * PATTERN_SLOTS_PER_CORE works whose double SHA-256 meets the chosen
+ * difficulty at a nonce inside that core's range:
+ *
+ *   nonce[31:24]  chip address (chip * interval .. + interval - 1)
+ *   nonce[23:16]  core byte (big core << 4 | small core)
+ *   nonce[15:0]   free
+ *
+ * so each pattern costs about difficulty * 2^32 hashes. The default is the
+ * difficulty of the ticket mask the driver programs (TICKET_MASK_256_CORES,
+ * 256); the chips report nothing easier. All patterns of a
+ * chip share work_data and differ in midstate, which lets pattern_test
+ * pack four per packet.
+ *
+ * Byte order follows the TW FIFO path: the ASIC receives work_data as
+ * header words 18, 17, 16 and the midstate as state words 7..0, each
+ * word most significant byte first; the nonce read back from the FIFO is
+ * header word 19 (see docs/PATTERN_TEST.md). --check verifies existing
+ * files or bundles under the same assumption.
+ *
+ * Usage: pattern_gen [options] output
+ *        pattern_gen --check path
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "../include/sha256.h"
+#include "../include/pattern_file.h"
+#include "../include/pattern_bundle.h"
+#include "../include/work_timing.h"
+#include "../include/hashrate.h"
+
+// Configuration
+#define GEN_CHAIN_CHIPS     114         // S19 Pro chain (sets the address interval)
+#define GEN_MAX_THREADS     256
+#define GEN_NONCE_RUN       (1u << 16)  // Free nonce bits per chip address
+#define GEN_BENCH_NONCES    (1u << 15)
+#define GEN_PROGRESS_SEC    2
+#define GEN_NTIME           1600000000u
+#define GEN_NBITS           0x1d00ffffu // Difficulty 1 (not checked by the ASIC)
+
+typedef struct {
+    int num_chips;              // Chips to generate, from 0
+    int interval;               // Chip address interval on the chain
+    double difficulty;
+    uint64_t limit;             // sha256d_scan_fn limit for difficulty
+    uint64_t seed;
+    sha256d_scan_fn scan;
+    pattern_bundle_entry_t *entries;    // [chips][cores][slots]
+
+    // Shared between workers (__atomic builtins)
+    int next_target;            // chip * PATTERN_CORES + core
+    int patterns_done;
+    uint64_t hashes;
+} gen_t;
+
+//==============================================================================
+// Work Construction
+//==============================================================================
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t mix(uint64_t seed, uint64_t a, uint64_t b, uint64_t c) {
+    uint64_t x = seed ^ (a * 0x100000001B3ULL) ^ (b << 20) ^ (c << 40);
+    return splitmix64(&x);
+}
+
+// Header words 16-18 shared by every pattern of a chip
+static void chip_tail(const gen_t *g, int chip, uint32_t tail[3]) {
+    tail[0] = (uint32_t)mix(g->seed, chip, 0xFFFF, 0);     // Merkle root tail
+    tail[1] = __builtin_bswap32(GEN_NTIME);                 // Header stores LE
+    tail[2] = __builtin_bswap32(GEN_NBITS);
+}
+
+// Header bytes 0-63 for try k of (chip, core): version, prev hash, merkle head
+static void make_midstate(const gen_t *g, int chip, int core, uint64_t k,
+                          uint32_t midstate[8]) {
+    uint8_t header[64];
+    uint64_t x = mix(g->seed, chip, core, k);
+
+    for (int i = 0; i < 64; i += 8) {
+        const uint64_t r = splitmix64(&x);
+        memcpy(&header[i], &r, 8);
+    }
+    header[0] = 0x00;   // Version 0x20000000, little-endian
+    header[1] = 0x00;
+    header[2] = 0x00;
+    header[3] = 0x20;
+    sha256_midstate(header, midstate);
+}
+
+static size_t entry_slot(int chip, int core, int slot) {
+    return ((size_t)chip * PATTERN_CORES + core) * PATTERN_SLOTS_PER_CORE + slot;
+}
+
+// Bundle entries hold the FIFO words: work_data = header words 18, 17, 16,
+// midstate = state words 7..0, nonce = header word 19
+static void job_to_entry(const sha256d_job_t *job, uint32_t nonce, pattern_bundle_entry_t *e) {
+    for (int i = 0; i < 3; i++) {
+        e->work_data_be[i] = job->tail[2 - i];
+    }
+    for (int i = 0; i < 8; i++) {
+        e->midstate_be[i] = job->midstate[7 - i];
+    }
+    e->nonce = nonce;
+}
+
+static void entry_to_job(const pattern_bundle_entry_t *e, sha256d_job_t *job) {
+    for (int i = 0; i < 3; i++) {
+        job->tail[i] = e->work_data_be[2 - i];
+    }
+    for (int i = 0; i < 8; i++) {
+        job->midstate[i] = e->midstate_be[7 - i];
+    }
+}
+
+//==============================================================================
+// Search
+//==============================================================================
+
+/**
+ * Find every slot of one chip core, one pattern per midstate
+ */
+static void gen_target(gen_t *g, int chip, int core) {
+    const uint32_t core_byte = ((uint32_t)(core / 16) << 4) | (core % 16);
+    sha256d_job_t job;
+    chip_tail(g, chip, job.tail);
+
+    int slot = 0;
+    for (uint64_t k = 0; slot < PATTERN_SLOTS_PER_CORE; k++) {
+        make_midstate(g, chip, core, k, job.midstate);
+
+        for (int t = 0; t < g->interval; t++) {
+            const uint32_t first = ((uint32_t)(chip * g->interval + t) << 24) | (core_byte << 16);
+            uint32_t nonce;
+            const int found = g->scan(&job, first, GEN_NONCE_RUN, g->limit, &nonce, 1);
+            __atomic_add_fetch(&g->hashes, GEN_NONCE_RUN, __ATOMIC_RELAXED);
+            if (found) {
+                job_to_entry(&job, nonce, &g->entries[entry_slot(chip, core, slot++)]);
+                __atomic_add_fetch(&g->patterns_done, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+    }
+}
+
+static void *gen_worker(void *arg) {
+    gen_t *g = arg;
+    const int targets = g->num_chips * PATTERN_CORES;
+
+    for (;;) {
+        const int target = __atomic_fetch_add(&g->next_target, 1, __ATOMIC_RELAXED);
+        if (target >= targets) {
+            break;
+        }
+        gen_target(g, target / PATTERN_CORES, target % PATTERN_CORES);
+    }
+    return NULL;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Pick the fastest scan implementation on this CPU (or the named one)
+ */
+static sha256d_scan_fn select_impl(const char *name) {
+    const sha256d_impl_t *impls;
+    const int count = sha256d_impls(&impls);
+    sha256d_job_t job;
+    memset(&job, 0, sizeof(job));
+
+    int best = -1;
+    double best_rate = 0;
+    for (int i = 0; i < count; i++) {
+        if (name) {
+            if (strcmp(name, impls[i].name) == 0) {
+                best = i;
+                break;
+            }
+            continue;
+        }
+        uint32_t hit;
+        const double t0 = now_sec();
+        impls[i].scan(&job, 0, GEN_BENCH_NONCES, 0, &hit, 1);
+        const double rate = GEN_BENCH_NONCES / (now_sec() - t0);
+        printf("  %-7s %7.2f MH/s per thread\n", impls[i].name, rate / 1e6);
+        if (rate > best_rate) {
+            best_rate = rate;
+            best = i;
+        }
+    }
+
+    if (best < 0) {
+        fprintf(stderr, "Error: SHA-256 implementation '%s' not available; have:", name);
+        for (int i = 0; i < count; i++) {
+            fprintf(stderr, " %s", impls[i].name);
+        }
+        fprintf(stderr, "\n");
+        return NULL;
+    }
+    printf("Using %s\n", impls[best].name);
+    return impls[best].scan;
+}
+
+//==============================================================================
+// Output
+//==============================================================================
+
+static void put_be32(uint8_t *p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+/**
+ * Write btc-asic-NNN.bin files in the factory layout
+ */
+static int write_bitmain(const gen_t *g, const char *dir) {
+    static pattern_set_t ps;    // For the entry offset index only
+    pattern_set_init(&ps, dir);
+
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+
+    uint8_t *file = malloc(PATTERN_FILE_SIZE);
+    if (!file) {
+        return -1;
+    }
+
+    for (int chip = 0; chip < g->num_chips; chip++) {
+        memset(file, 0, PATTERN_FILE_SIZE);
+        for (int core = 0; core < PATTERN_CORES; core++) {
+            for (int slot = 0; slot < PATTERN_SLOTS_PER_CORE; slot++) {
+                const pattern_bundle_entry_t *e = &g->entries[entry_slot(chip, core, slot)];
+                test_pattern_t *p = (test_pattern_t *)(file + ps.index[core][slot]);
+                for (int i = 0; i < 3; i++) {
+                    put_be32(&p->work_data[i * 4], e->work_data_be[i]);
+                }
+                for (int i = 0; i < 8; i++) {
+                    put_be32(&p->midstate[i * 4], e->midstate_be[i]);
+                }
+                p->nonce = e->nonce;    // Little-endian, as on the controller
+            }
+        }
+
+        char path[320], tmp_path[330];
+        snprintf(path, sizeof(path), "%s/btc-asic-%03d.bin", dir, chip);
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+        FILE *fp = fopen(tmp_path, "wb");
+        const bool ok = fp && fwrite(file, 1, PATTERN_FILE_SIZE, fp) == PATTERN_FILE_SIZE;
+        if (fp && fclose(fp) != 0) {
+            fp = NULL;
+        }
+        if (!ok || !fp || rename(tmp_path, path) < 0) {
+            fprintf(stderr, "Error: Failed to write %s\n", path);
+            unlink(tmp_path);
+            free(file);
+            return -1;
+        }
+    }
+
+    free(file);
+    printf("Wrote %d pattern files to %s\n", g->num_chips, dir);
+    return 0;
+}
+
+static int write_bundle(const gen_t *g, const char *path) {
+    uint32_t chip_present[PATTERN_MAX_CHIPS / 32] = {0};
+    for (int chip = 0; chip < g->num_chips; chip++) {
+        chip_present[chip / 32] |= 1u << (chip % 32);
+    }
+    if (pattern_bundle_write_entries(path, g->entries, g->num_chips, chip_present) < 0) {
+        return -1;
+    }
+    printf("Wrote bundle %s (%d chips)\n", path, g->num_chips);
+    return 0;
+}
+
+//==============================================================================
+// Verification
+//==============================================================================
+
+/**
+ * Re-hash every entry of existing patterns and check the nonce lands on the
+ * right chip and core
+ * Returns: 0 if all entries verify, 1 if some fail, -1 on error
+ */
+static int check_patterns(const char *path, int chain_chips, double difficulty) {
+    const int interval = work_timing_interval(chain_chips);
+    const uint64_t limit = sha256d_limit(difficulty);
+    struct stat st;
+    if (stat(path, &st) < 0) {
+        fprintf(stderr, "Error: Cannot stat %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    static pattern_set_t ps;
+    pattern_bundle_t bundle;
+    const bool is_bundle = !S_ISDIR(st.st_mode);
+    if (is_bundle) {
+        if (pattern_bundle_open(&bundle, path) < 0) {
+            return -1;
+        }
+    } else {
+        pattern_set_init(&ps, path);
+    }
+
+    int checked = 0, hash_ok = 0, placed_ok = 0;
+    for (int chip = 0; chip < PATTERN_MAX_CHIPS; chip++) {
+        if (is_bundle) {
+            if (!pattern_bundle_has_chip(&bundle, chip)) {
+                continue;
+            }
+        } else {
+            char file[320];
+            snprintf(file, sizeof(file), "%s/btc-asic-%03d.bin", path, chip);
+            if (access(file, F_OK) < 0 || pattern_set_map(&ps, chip) < 0) {
+                continue;
+            }
+        }
+        for (int core = 0; core < PATTERN_CORES; core++) {
+            for (int slot = 0; slot < PATTERN_SLOTS_PER_CORE; slot++) {
+                pattern_bundle_entry_t e;
+                if (is_bundle) {
+                    e = *pattern_bundle_get(&bundle, chip, core, slot);
+                } else {
+                    const test_pattern_t *p = pattern_get(&ps, chip, core, slot);
+                    for (int i = 0; i < 3; i++) {
+                        uint32_t w;
+                        memcpy(&w, &p->work_data[i * 4], 4);
+                        e.work_data_be[i] = __builtin_bswap32(w);
+                    }
+                    for (int i = 0; i < 8; i++) {
+                        uint32_t w;
+                        memcpy(&w, &p->midstate[i * 4], 4);
+                        e.midstate_be[i] = __builtin_bswap32(w);
+                    }
+                    e.nonce = p->nonce;
+                }
+
+                sha256d_job_t job;
+                entry_to_job(&e, &job);
+                const uint32_t core_byte = ((uint32_t)(core / 16) << 4) | (core % 16);
+                checked++;
+                hash_ok += sha256d_top64(&job, e.nonce) <= limit;
+                placed_ok += (int)(e.nonce >> 24) / interval == chip &&
+                             ((e.nonce >> 16) & 0xFF) == core_byte;
+            }
+        }
+    }
+
+    if (is_bundle) {
+        pattern_bundle_close(&bundle);
+    } else {
+        pattern_set_close(&ps);
+    }
+
+    if (checked == 0) {
+        fprintf(stderr, "Error: No patterns found in %s\n", path);
+        return -1;
+    }
+    printf("Entries checked: %d\n", checked);
+    printf("Meet difficulty %g: %d (%.1f%%)\n", difficulty, hash_ok, hash_ok * 100.0 / checked);
+    printf("Nonce on expected chip/core: %d (%.1f%%)\n", placed_ok, placed_ok * 100.0 / checked);
+    return hash_ok == checked && placed_ok == checked ? 0 : 1;
+}
+
+//==============================================================================
+// Main
+//==============================================================================
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options] output\n", prog);
+    printf("       %s --check path\n\n", prog);
+    printf("Options:\n");
+    printf("  --chips N        Chips to generate (default: chain size)\n");
+    printf("  --chain-chips N  Chips on the chain, sets the address interval (default: %d)\n",
+           GEN_CHAIN_CHIPS);
+    printf("  --difficulty D   Share difficulty (default: %u, the ticket mask; the ASIC\n"
+           "                   reports nothing below it)\n",
+           hashrate_difficulty_from_mask(TICKET_MASK_256_CORES));
+    printf("  --threads N      Worker threads (default: online CPUs)\n");
+    printf("  --seed N         Work seed (default: 1)\n");
+    printf("  --impl NAME      SHA-256 implementation (default: fastest)\n");
+    printf("  --bundle         Write a pattern bundle instead of btc-asic-NNN.bin files\n");
+    printf("  --check PATH     Verify a pattern directory or bundle\n\n");
+    printf("output is a directory for btc-asic-NNN.bin files, or the bundle path.\n");
+}
+
+int main(int argc, char *argv[]) {
+    int chain_chips = GEN_CHAIN_CHIPS;
+    int num_chips = 0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const double ticket_difficulty = hashrate_difficulty_from_mask(TICKET_MASK_256_CORES);
+    double difficulty = ticket_difficulty;
+    uint64_t seed = 1;
+    const char *impl = NULL;
+    const char *check_path = NULL;
+    const char *output = NULL;
+    bool bundle = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--chips") == 0 && i + 1 < argc) {
+            num_chips = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--chain-chips") == 0 && i + 1 < argc) {
+            chain_chips = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--difficulty") == 0 && i + 1 < argc) {
+            difficulty = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--impl") == 0 && i + 1 < argc) {
+            impl = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            check_path = argv[++i];
+        } else if (strcmp(argv[i], "--bundle") == 0) {
+            bundle = true;
+        } else if (argv[i][0] != '-' && !output) {
+            output = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ?
+                   EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (num_chips == 0) {
+        num_chips = chain_chips;
+    }
+    if (chain_chips <= 0 || chain_chips > 256 || num_chips <= 0 ||
+        num_chips > chain_chips || num_chips > PATTERN_MAX_CHIPS) {
+        fprintf(stderr, "Error: Need 1 <= --chips <= --chain-chips, at most %d chips\n",
+                PATTERN_MAX_CHIPS);
+        return EXIT_FAILURE;
+    }
+    if (!(difficulty > 0)) {
+        fprintf(stderr, "Error: --difficulty must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    if (check_path) {
+        const int rc = check_patterns(check_path, chain_chips, difficulty);
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!output) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > GEN_MAX_THREADS) {
+        threads = GEN_MAX_THREADS;
+    }
+    if (difficulty < ticket_difficulty) {
+        printf("Warning: difficulty %g is below the ticket mask (%g); the ASIC will not "
+               "return these nonces\n", difficulty, ticket_difficulty);
+    }
+
+    static gen_t gen;
+    gen.num_chips = num_chips;
+    gen.interval = work_timing_interval(chain_chips);
+    gen.difficulty = difficulty;
+    gen.limit = sha256d_limit(difficulty);
+    gen.seed = seed;
+
+    printf("SHA-256 implementations:\n");
+    gen.scan = select_impl(impl);
+    if (!gen.scan) {
+        return EXIT_FAILURE;
+    }
+
+    const int total = num_chips * PATTERNS_PER_CHIP;
+    gen.entries = calloc(total, sizeof(pattern_bundle_entry_t));
+    if (!gen.entries) {
+        fprintf(stderr, "Error: Failed to allocate %d patterns\n", total);
+        return EXIT_FAILURE;
+    }
+
+    // Expected hashes per pattern: 2^64 / (limit + 1)
+    const double per_pattern = 18446744073709551616.0 / ((double)gen.limit + 1.0);
+    printf("\nGenerating %d chips x %d cores x %d patterns = %d\n",
+           num_chips, PATTERN_CORES, PATTERN_SLOTS_PER_CORE, total);
+    printf("Difficulty %g (~%.3g hashes per pattern), interval %d, %d threads\n\n",
+           difficulty, per_pattern, gen.interval, threads);
+
+    pthread_t workers[GEN_MAX_THREADS];
+    int started = 0;
+    for (; started < threads; started++) {
+        if (pthread_create(&workers[started], NULL, gen_worker, &gen) != 0) {
+            fprintf(stderr, "Warning: Started only %d threads\n", started);
+            break;
+        }
+    }
+    if (started == 0) {
+        free(gen.entries);
+        return EXIT_FAILURE;
+    }
+
+    const double t0 = now_sec();
+    double last = t0;
+    int done;
+    while ((done = __atomic_load_n(&gen.patterns_done, __ATOMIC_RELAXED)) < total) {
+        usleep(100000);
+        const double now = now_sec();
+        if (now - last < GEN_PROGRESS_SEC) {
+            continue;
+        }
+        last = now;
+        const double rate = __atomic_load_n(&gen.hashes, __ATOMIC_RELAXED) / (now - t0);
+        const double eta = rate > 0 ? (total - done) * per_pattern / rate : 0;
+        printf("  %6d/%d patterns (%5.1f%%), %.1f MH/s, ETA %.0f s\n",
+               done, total, done * 100.0 / total, rate / 1e6, eta);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    const double secs = now_sec() - t0;
+    printf("Done: %d patterns, %.3g hashes in %.1f s (%.1f MH/s)\n\n",
+           total, (double)gen.hashes, secs, secs > 0 ? gen.hashes / secs / 1e6 : 0.0);
+
+    const int rc = bundle ? write_bundle(&gen, output) : write_bitmain(&gen, output);
+    free(gen.entries);
+    return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
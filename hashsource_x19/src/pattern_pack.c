@@ -0,0 +1,74 @@
+/*
+ * Pattern Bundle Packer
+ *
+ * Converts Bitmain btc-asic-NNN.bin pattern files into one compact,
+ * pre-swapped bundle for pattern_test --bundle (see pattern_bundle.h).
+ *
+ * Usage: pattern_pack [--chips N] [pattern_dir] [output]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/pattern_file.h"
+#include "../include/pattern_bundle.h"
+
+int main(int argc, char *argv[]) {
+    const char *pattern_dir = PATTERN_DEFAULT_DIR;
+    const char *output = NULL;
+    int num_chips = PATTERN_MAX_CHIPS;
+    int positional = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--chips") == 0 && i + 1 < argc) {
+            num_chips = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && positional == 0) {
+            pattern_dir = argv[i];
+            positional++;
+        } else if (argv[i][0] != '-' && positional == 1) {
+            output = argv[i];
+            positional++;
+        } else {
+            printf("Usage: %s [--chips N] [pattern_dir] [output]\n\n", argv[0]);
+            printf("  --chips N      Chip files to pack (default: %d)\n", PATTERN_MAX_CHIPS);
+            printf("  pattern_dir    Directory with btc-asic-NNN.bin (default: %s)\n",
+                   PATTERN_DEFAULT_DIR);
+            printf("  output         Bundle path (default: pattern_dir/%s)\n",
+                   PATTERN_BUNDLE_DEFAULT_NAME);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ?
+                   EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (num_chips <= 0 || num_chips > PATTERN_MAX_CHIPS) {
+        fprintf(stderr, "Error: --chips must be 1..%d\n", PATTERN_MAX_CHIPS);
+        return EXIT_FAILURE;
+    }
+
+    char default_output[320];
+    if (!output) {
+        snprintf(default_output, sizeof(default_output), "%s/%s",
+                 pattern_dir, PATTERN_BUNDLE_DEFAULT_NAME);
+        output = default_output;
+    }
+
+    static pattern_set_t ps;
+    pattern_set_init(&ps, pattern_dir);
+
+    printf("Packing %d chip pattern files from %s...\n", num_chips, pattern_dir);
+    const int packed = pattern_bundle_write(output, &ps, num_chips);
+    pattern_set_close(&ps);
+    if (packed < 0) {
+        return EXIT_FAILURE;
+    }
+
+    // Read it back through the runtime path to verify checksums
+    pattern_bundle_t bundle;
+    if (pattern_bundle_open(&bundle, output) < 0) {
+        return EXIT_FAILURE;
+    }
+    printf("Wrote %s: %d/%d chips, %zu bytes\n", output, packed, num_chips, bundle.size);
+    pattern_bundle_close(&bundle);
+
+    return packed == num_chips ? EXIT_SUCCESS : EXIT_FAILURE;
+}
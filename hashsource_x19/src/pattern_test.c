@@ -5,165 +5,947 @@
  * can find correct solutions without needing pool connection.
  *
  * Based on Bitmain factory test fixture pattern test methodology.
+ *
+ * Modes:
+ *   default  First TEST_PATTERNS patterns of chip TEST_ASIC_ID
+ *   --full   Every pattern (80 cores × 8) of every chip on the chain,
+ *            streamed at the FIFO's acceptance rate while nonces are
+ *            drained, scored per chip and per core against the >95%
+ *            nonce return criterion
+ *   --bundle Read patterns from a pattern_pack bundle instead of the
+ *            btc-asic-NNN.bin files (pre-swapped, no per-packet copies)
+ *   --all-chains
+ *            Power up once, bring up every detected chain and interleave
+ *            their packets through the shared TW FIFO; nonces are routed
+ *            by the FIFO chain number (bits 3:0, not yet verified on
+ *            hardware) into one result matrix per chain. A single-chain
+ *            run checks every FIFO word against its one matrix.
+ *   --shmoo  Walk a PSU voltage × PLL frequency grid, sending a short burst
+ *            (one pattern per core by default) to every chip at each point;
+ *            writes a per-chip return map and suggested frequency bins
+ *
+ * Patterns of a chip that share work_data are packed up to four per packet,
+ * one per midstate slot. Nonces are matched to patterns by value only: the
+ * FIFO word has no verified slot or work_id field.
+ * --single-midstate restores the factory layout (one pattern in all slots).
+ *
+ * Monitoring ends as soon as every expected nonce is back, or once the
+ * missing ones are overdue by several times the slowest turnaround seen
+ * (see completion.h). The fixed waits below are only upper bounds.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
 #include "../include/bm1398_asic.h"
+#include "../include/pattern_file.h"
+#include "../include/pattern_bundle.h"
+#include "../include/completion.h"
 
 // Configuration
 #define TEST_CHAIN 0
-#define CORES_PER_ASIC 80    // BM1398: 80 cores (16 small cores × 5 big cores)
-#define PATTERNS_PER_CORE 8  // Standard pattern test uses 8 patterns per core
+#define CORES_PER_ASIC PATTERN_CORES            // BM1398: 80 cores (16 small × 5 big)
+#define PATTERNS_PER_CORE PATTERN_SLOTS_PER_CORE // Standard pattern test uses 8 per core
+#define PATTERNS_PER_ASIC PATTERNS_PER_CHIP
 #define TEST_ASIC_ID 0       // Test first ASIC only
 #define TEST_PATTERNS 80     // Test all patterns for first core
 #define NONCE_TIMEOUT_SEC 60 // Longer timeout for first test
-// Each core occupies 7,238 bytes (0x1C46) in the pattern file
-// This includes a large header section plus 8 pattern slots
-#define PATTERN_ENTRY_SIZE 0x74    // 116 bytes per pattern entry
-#define PATTERNS_PER_CORE_ROW 8    // 8 pattern slots per core
-
-// Pattern file structure (116 bytes = 0x74)
-// CRITICAL: Verified from Binary Ninja decompilation of single_board_test @ 0x1C890
-// Function parse_bin_file_to_pattern_ex reads EXACTLY 0x74 bytes per pattern
-typedef struct __attribute__((packed)) {
-    uint8_t  header[15];     // Offset 0x00-0x0E: Header/metadata
-    uint8_t  work_data[12];  // Offset 0x0F-0x1A: Last 12 bytes of block header
-    uint8_t  midstate[32];   // Offset 0x1B-0x3A: SHA256 midstate
-    uint8_t  reserved[29];   // Offset 0x3B-0x57: Padding/reserved
-    uint32_t nonce;          // Offset 0x58-0x5B: Expected nonce (little-endian)
-    uint8_t  trailer[24];    // Offset 0x5C-0x73: Additional data
-} test_pattern_t;  // Total: 116 bytes (0x74)
-
-// Work entry with pattern and tracking
+#define FULL_TAIL_SEC 10     // Full mode: drain time after the last packet
+#define MIN_NONCE_TIMEOUT_MS 2000   // Floor for the adaptive per-core timeout
+#define MAX_PATTERN_CHIPS PATTERN_MAX_CHIPS
+#define PASS_THRESHOLD_PCT 95.0     // PATTERN_TEST.md: ">95% nonce return"
+#define NO_CHIP 0xFF
+#define MIDSTATE_SLOTS 4
+#define PACK_WINDOW 32       // Open packets searched for matching work_data
+
+// Shmoo sweep
+#define SHMOO_MAX_POINTS 24         // Per axis
+#define SHMOO_MIN_MV 12000
+#define SHMOO_MAX_MV 15000
+#define SHMOO_DEFAULT_MV "13200:12000:200"
+#define SHMOO_DEFAULT_MHZ "450:650:25"
+#define SHMOO_SETTLE_SEC 2          // After each PSU step
+#define SHMOO_POINT_SEC 5           // Upper bound per grid point
+#define SHMOO_QUIET_MS 200          // No nonces for this long = previous point done
+#define SHMOO_PASS_PERMILLE 950     // Same >95% criterion as the board test
+#define SHMOO_GUARD_STEPS 1         // Bin this many steps below the last pass
+#define SHMOO_RESTORE_MV 12600
+#define SHMOO_RESTORE_MHZ 525
+#define SHMOO_UNTESTED 0xFFFF
+
+// Test plan and results
+// sent/passed are chip × core × pattern bitmaps: one byte per (chip, core),
+// bit n = pattern n. A full board is 2 × 128 × 80 bytes.
 typedef struct {
-    test_pattern_t pattern;
-    uint16_t work_id;
-    uint8_t  nonce_returned;
-} pattern_work_t;
+    bool active;
+    int chain;
+    int first_chip;
+    int num_chips;
+    int patterns_per_chip;          // Entries sent per chip (core-major order)
+    int first_slot;                 // Slot window of each core in the plan:
+    int slots_per_core;             //   first_slot onwards, wrapping at 8
+    bool verbose;                   // Print every nonce
+    bool pack;                      // Distinct patterns per midstate slot
+    uint8_t addr_to_chip[256];      // Nonce top byte → chip index
+    uint8_t sent[MAX_PATTERN_CHIPS][CORES_PER_ASIC];
+    uint8_t passed[MAX_PATTERN_CHIPS][CORES_PER_ASIC];
+    int packets_sent;
+    int total_nonces;
+    int valid_nonces;
+    int mismatches;
+    int unexpected;
+    completion_t done;              // One group per (chip slot, core)
+} pt_results_t;
+
+// One work packet: up to four patterns of one chip sharing work_data
+typedef struct {
+    uint16_t idx[MIDSTATE_SLOTS];   // core * PATTERNS_PER_CORE + pattern
+    uint8_t count;
+} pt_packet_t;
+
+// Send position on one chain: packets of the current chip
+typedef struct {
+    int chip_slot;                  // Next chip to plan
+    int chip;                       // Chip the packets belong to
+    int num_packets;
+    int next;
+    pt_packet_t packets[PATTERNS_PER_ASIC];
+} pt_cursor_t;
+
+static int g_stray_nonces = 0;      // Nonces from chains not under test
+static int g_only_chain = -1;       // Single-chain run: gets every nonce
+
+// Pattern source: factory files or a packed bundle
+typedef struct {
+    pattern_set_t files;
+    pattern_bundle_t bundle;
+    bool use_bundle;
+} pattern_source_t;
+
+static int source_open(pattern_source_t *src, const char *pattern_dir,
+                       const char *bundle_path, int first_chip, int num_chips) {
+    memset(src, 0, sizeof(*src));
+    pattern_set_init(&src->files, pattern_dir);
+
+    if (bundle_path) {
+        if (pattern_bundle_open(&src->bundle, bundle_path) < 0) {
+            return -1;
+        }
+        src->use_bundle = true;
+    }
+
+    for (int chip = first_chip; chip < first_chip + num_chips; chip++) {
+        if (src->use_bundle && !pattern_bundle_has_chip(&src->bundle, chip)) {
+            fprintf(stderr, "Error: Bundle %s has no patterns for chip %d\n",
+                    bundle_path, chip);
+            return -1;
+        }
+        if (!src->use_bundle && pattern_set_map(&src->files, chip) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void source_close(pattern_source_t *src) {
+    pattern_set_close(&src->files);
+    pattern_bundle_close(&src->bundle);
+}
+
+static uint32_t source_nonce(pattern_source_t *src, int chip, int core, int slot) {
+    if (src->use_bundle) {
+        return pattern_bundle_get(&src->bundle, chip, core, slot)->nonce;
+    }
+    return pattern_get(&src->files, chip, core, slot)->nonce;
+}
+
+// 12 bytes; only compared for equality, so byte order doesn't matter
+static const void *source_work_data(pattern_source_t *src, int chip, int idx) {
+    if (src->use_bundle) {
+        return pattern_bundle_get(&src->bundle, chip, idx / PATTERNS_PER_CORE,
+                                  idx % PATTERNS_PER_CORE)->work_data_be;
+    }
+    return pattern_get(&src->files, chip, idx / PATTERNS_PER_CORE,
+                       idx % PATTERNS_PER_CORE)->work_data;
+}
 
 /**
- * Load pattern file for one ASIC
+ * Send one packet; slots beyond pkt->count repeat the first pattern
  */
-int load_asic_patterns(const char *pattern_dir, int asic_id,
-                      pattern_work_t *works, int max_works) {
-    char filename[256];
-    snprintf(filename, sizeof(filename), "%s/btc-asic-%03d.bin",
-             pattern_dir, asic_id);
-
-    printf("Loading pattern file: %s\n", filename);
+static int source_send(bm1398_context_t *ctx, int chain, pattern_source_t *src,
+                       int chip, const pt_packet_t *pkt, uint32_t work_id) {
+    if (src->use_bundle) {
+        // Words are stored in FPGA order: straight from the mapping
+        const pattern_bundle_entry_t *e[MIDSTATE_SLOTS];
+        const uint32_t *midstates[MIDSTATE_SLOTS];
+        for (int m = 0; m < MIDSTATE_SLOTS; m++) {
+            const int idx = pkt->idx[m < pkt->count ? m : 0];
+            e[m] = pattern_bundle_get(&src->bundle, chip, idx / PATTERNS_PER_CORE,
+                                      idx % PATTERNS_PER_CORE);
+            midstates[m] = e[m]->midstate_be;
+        }
+        return bm1398_send_work_swapped(ctx, chain, work_id, e[0]->work_data_be, midstates);
+    }
 
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
-        fprintf(stderr, "Error: Cannot open pattern file %s\n", filename);
-        return -1;
+    const test_pattern_t *p[MIDSTATE_SLOTS];
+    uint8_t midstates[MIDSTATE_SLOTS][32];
+    for (int m = 0; m < MIDSTATE_SLOTS; m++) {
+        const int idx = pkt->idx[m < pkt->count ? m : 0];
+        p[m] = pattern_get(&src->files, chip, idx / PATTERNS_PER_CORE,
+                           idx % PATTERNS_PER_CORE);
+        if (!p[m]) {
+            return -1;
+        }
+        memcpy(midstates[m], p[m]->midstate, 32);
     }
+    return bm1398_send_work(ctx, chain, work_id, p[0]->work_data, midstates);
+}
 
-    // Pattern file structure (verified from btc-asic-000.bin hex analysis):
-    // Total file: 579,072 bytes for 80 cores
-    // Each core row: 7,238 bytes (0x1C46)
-    //   - Large header section (varies, ~6,342 bytes)
-    //   - 8 pattern entries × 116 bytes (0x74) each = 928 bytes
-    //
-    // We read patterns sequentially, skipping unused slots
-
-    int loaded = 0;
-    for (int core = 0; core < CORES_PER_ASIC && loaded < max_works; core++) {
-        // Each core row is 7,238 bytes, but we only read the pattern entries
-        // The factory test skips through the file reading 0x74 bytes at a time
-        for (int pat = 0; pat < PATTERNS_PER_CORE_ROW && loaded < max_works; pat++) {
-            // Read exactly 116 bytes (0x74) as factory test does
-            size_t read_bytes = fread(&works[loaded].pattern, 1, PATTERN_ENTRY_SIZE, fp);
-            if (read_bytes != PATTERN_ENTRY_SIZE) {
-                fprintf(stderr, "Error: Short read at core %d pattern %d (got %zu, expected %d)\n",
-                       core, pat, read_bytes, PATTERN_ENTRY_SIZE);
-                fclose(fp);
-                return -1;
+/**
+ * Group a chip's patterns into packets
+ *
+ * All four midstates of a packet are hashed with the same work_data, so
+ * only patterns with identical work_data can share one. Each pattern joins
+ * the most recent open packet (within PACK_WINDOW) that matches, otherwise
+ * starts a new one. Only slots_per_core slots of each core are used,
+ * starting at first_slot, up to num_patterns in total.
+ * Returns: number of packets
+ */
+static int plan_packets(pattern_source_t *src, int chip, int num_patterns,
+                        int first_slot, int slots_per_core, bool pack,
+                        pt_packet_t *packets) {
+    int num_packets = 0;
+    int planned = 0;
+
+    for (int i = 0; i < PATTERNS_PER_ASIC && planned < num_patterns; i++) {
+        pt_packet_t *target = NULL;
+        const int slot = i % PATTERNS_PER_CORE;
+        if ((slot - first_slot + PATTERNS_PER_CORE) % PATTERNS_PER_CORE >= slots_per_core) {
+            continue;
+        }
+        planned++;
+
+        if (pack) {
+            const void *wd = source_work_data(src, chip, i);
+            const int oldest = num_packets > PACK_WINDOW ? num_packets - PACK_WINDOW : 0;
+            for (int j = num_packets - 1; j >= oldest; j--) {
+                if (packets[j].count < MIDSTATE_SLOTS &&
+                    memcmp(source_work_data(src, chip, packets[j].idx[0]), wd, 12) == 0) {
+                    target = &packets[j];
+                    break;
+                }
             }
+        }
 
-            works[loaded].work_id = pat;
-            works[loaded].nonce_returned = 0;
-            loaded++;
+        if (!target) {
+            target = &packets[num_packets++];
+            target->count = 0;
+        }
+        target->idx[target->count++] = (uint16_t)i;
+    }
+    return num_packets;
+}
 
-            // Stop if we've loaded enough patterns
-            if (loaded >= max_works) break;
+/**
+ * Extract ASIC index and core ID from nonce
+ * Based on Bitmain get_asic_index_by_nonce() and get_coreid_by_nonce()
+ */
+void parse_nonce_info(uint32_t nonce, const uint8_t *addr_to_chip,
+                     int *asic_id, int *core_id) {
+    // ASIC index from upper bits (table lookup, no division per nonce)
+    const uint8_t chip = addr_to_chip[nonce >> 24];
+    *asic_id = chip == NO_CHIP ? -1 : chip;
+
+    // Core ID encoding (from factory test analysis)
+    // Upper nibble = big core (0-4), lower nibble = small core (0-15)
+    uint8_t core_byte = (nonce >> 16) & 0xFF;
+    int big_core = (core_byte >> 4) & 0xF;
+    int small_core = core_byte & 0xF;
+    *core_id = big_core * 16 + small_core;
+}
+
+/**
+ * Validate one returned nonce against the pattern it answers
+ *
+ * Chip and core come from the nonce itself; the pattern is whichever one
+ * sent to that core expects this nonce.
+ */
+static void check_nonce(pt_results_t *res, pattern_source_t *src,
+                        const nonce_response_t *n) {
+    int asic_id, core_id;
+    parse_nonce_info(n->nonce, res->addr_to_chip, &asic_id, &core_id);
+    const int chip_slot = asic_id - res->first_chip;
+
+    res->total_nonces++;
+    if (res->verbose) {
+        printf("Nonce #%d: 0x%08x (asic=%d, core=%d)\n",
+               res->total_nonces, n->nonce, asic_id, core_id);
+    }
+
+    if (asic_id < 0 || chip_slot < 0 || chip_slot >= res->num_chips ||
+        core_id >= CORES_PER_ASIC || res->sent[asic_id][core_id] == 0) {
+        res->unexpected++;
+        return;
+    }
+
+    int pattern_id = -1;
+    for (int p = 0; p < PATTERNS_PER_CORE; p++) {
+        if ((res->sent[asic_id][core_id] & (1 << p)) &&
+            source_nonce(src, asic_id, core_id, p) == n->nonce) {
+            pattern_id = p;
+            break;
         }
+    }
 
-        // Skip remaining pattern slots in this core row if we didn't read all 8
-        // Factory test reads all 8 slots even if only using fewer patterns
-        int remaining = PATTERNS_PER_CORE_ROW - PATTERNS_PER_CORE;
-        if (remaining > 0 && loaded < max_works) {
-            if (fseek(fp, remaining * PATTERN_ENTRY_SIZE, SEEK_CUR) != 0) {
-                fprintf(stderr, "Error: Seek failed after core %d\n", core);
-                fclose(fp);
-                return -1;
+    if (pattern_id < 0) {
+        if (res->verbose) {
+            printf("  ✗ MISMATCH! No pattern sent to core %d expects it\n", core_id);
+        }
+        res->mismatches++;
+        return;
+    }
+
+    if (res->verbose) {
+        printf("  ✓ VALID! Matches pattern %d\n", pattern_id);
+    }
+    if (!(res->passed[asic_id][core_id] & (1 << pattern_id))) {
+        completion_received(&res->done, chip_slot * CORES_PER_ASIC + core_id);
+    }
+    res->passed[asic_id][core_id] |= 1 << pattern_id;
+    res->valid_nonces++;
+}
+
+/**
+ * Drain the shared nonce FIFO, routing each nonce to its chain's results
+ *
+ * Routing by chain number relies on the unverified FIFO chain bits, so it
+ * is only done with --all-chains; a single-chain run takes every word.
+ */
+static void drain_nonces(bm1398_context_t *ctx, pt_results_t results[MAX_CHAINS],
+                         pattern_source_t *src) {
+    nonce_response_t nonces[100];
+    int read;
+    while ((read = bm1398_read_nonces(ctx, nonces, 100)) > 0) {
+        for (int i = 0; i < read; i++) {
+            const int chain = g_only_chain >= 0 ? g_only_chain : nonces[i].chain_id;
+            if (chain < MAX_CHAINS && results[chain].active) {
+                check_nonce(&results[chain], src, &nonces[i]);
+            } else {
+                g_stray_nonces++;
             }
         }
     }
+}
 
-    fclose(fp);
-    printf("Loaded %d test patterns\n\n", loaded);
-    return loaded;
+/**
+ * Advance a chain's cursor to its next packet
+ * Returns: packet to send, or NULL when the chain is done
+ */
+static const pt_packet_t *cursor_next(pt_cursor_t *cur, const pt_results_t *res,
+                                      pattern_source_t *src) {
+    while (cur->next >= cur->num_packets) {
+        if (cur->chip_slot >= res->num_chips) {
+            return NULL;
+        }
+        cur->chip = res->first_chip + cur->chip_slot++;
+        cur->num_packets = plan_packets(src, cur->chip, res->patterns_per_chip,
+                                        res->first_slot, res->slots_per_core,
+                                        res->pack, cur->packets);
+        cur->next = 0;
+    }
+    return &cur->packets[cur->next++];
 }
 
 /**
- * Send pattern test work to chain
+ * Stream pattern work to every active chain
+ *
+ * Packets go out back to back while the FPGA reports buffer space; while it
+ * is full the nonce FIFO is drained, so nothing is lost during a long send.
+ * Chains take turns one packet at a time so all boards hash concurrently.
  */
-int send_pattern_work(bm1398_context_t *ctx, int chain,
-                     pattern_work_t *works, int num_works) {
+int send_pattern_work(bm1398_context_t *ctx, pt_results_t results[MAX_CHAINS],
+                     pattern_source_t *src) {
+    static pt_cursor_t cursors[MAX_CHAINS];
+    int num_works = 0;
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        memset(&cursors[c], 0, sizeof(cursors[c]));
+        if (results[c].active) {
+            num_works += results[c].num_chips * results[c].patterns_per_chip;
+        }
+    }
+    const int progress_step = num_works >= 1000 ? num_works / 10 : 10;
+
     printf("====================================\n");
     printf("Sending %d Test Patterns\n", num_works);
     printf("====================================\n\n");
 
-    for (int i = 0; i < num_works; i++) {
-        // Check FIFO space
-        while (bm1398_check_work_fifo_ready(ctx) < 1) {
-            usleep(1000);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    int sent = 0;
+    int packets = 0;
+    bool pending = true;
+    while (pending) {
+        pending = false;
+
+        for (int chain = 0; chain < MAX_CHAINS; chain++) {
+            pt_results_t *res = &results[chain];
+            if (!res->active) {
+                continue;
+            }
+            const pt_packet_t *pkt = cursor_next(&cursors[chain], res, src);
+            if (!pkt) {
+                continue;
+            }
+            pending = true;
+            const int chip = cursors[chain].chip;
+
+            // Factory test polls buffer space every 10 us
+            while (bm1398_check_work_fifo_ready(ctx) < 1) {
+                drain_nonces(ctx, results, src);
+                usleep(10);
+            }
+
+            // Mark before sending: the nonce may come back immediately
+            for (int m = 0; m < MIDSTATE_SLOTS; m++) {
+                const int idx = pkt->idx[m < pkt->count ? m : 0];
+                const int core = idx / PATTERNS_PER_CORE;
+                const int pat = idx % PATTERNS_PER_CORE;
+                res->sent[chip][core] |= 1 << pat;
+            }
+            for (int m = 0; m < pkt->count; m++) {
+                const int core = pkt->idx[m] / PATTERNS_PER_CORE;
+                completion_sent(&res->done, (chip - res->first_chip) * CORES_PER_ASIC + core, 1);
+            }
+
+            // Sequence number only; patterns are matched by nonce value
+            if (source_send(ctx, chain, src, chip, pkt, res->packets_sent & 0x1F) < 0) {
+                fprintf(stderr, "Error: Failed to send packet to chip %d on chain %d\n",
+                        chip, chain);
+                return -1;
+            }
+            res->packets_sent++;
+            packets++;
+
+            const int before = sent;
+            sent += pkt->count;
+            if (sent / progress_step != before / progress_step) {
+                printf("  Sent %d/%d patterns\n", sent, num_works);
+            }
+        }
+    }
+    drain_nonces(ctx, results, src);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    const double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf("All %d patterns sent in %d packets, %.1f s (%.0f packets/s)\n\n",
+           num_works, packets, secs, secs > 0 ? packets / secs : 0.0);
+    return 0;
+}
+
+/**
+ * Returns: true once every active chain has all its nonces or gave up
+ */
+static bool all_complete(const pt_results_t results[MAX_CHAINS]) {
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        if (results[c].active && completion_check(&results[c].done) == COMPLETION_PENDING) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Patterns sent to and returned by one chip
+ */
+static void chip_counts(const pt_results_t *res, int chip, int *sent, int *passed) {
+    *sent = 0;
+    *passed = 0;
+    for (int core = 0; core < CORES_PER_ASIC; core++) {
+        *sent += __builtin_popcount(res->sent[chip][core]);
+        *passed += __builtin_popcount(res->passed[chip][core]);
+    }
+}
+
+/**
+ * Print per-chip and per-core pass rates
+ * Returns: true if every tested chip met PASS_THRESHOLD_PCT
+ */
+static bool print_results(const pt_results_t *res) {
+    int core_sent[CORES_PER_ASIC] = {0};
+    int core_passed[CORES_PER_ASIC] = {0};
+    int chips_failed = 0;
+
+    printf("Per-chip nonce return:\n");
+    for (int slot = 0; slot < res->num_chips; slot++) {
+        const int chip = res->first_chip + slot;
+        int sent, passed;
+
+        chip_counts(res, chip, &sent, &passed);
+        for (int core = 0; core < CORES_PER_ASIC; core++) {
+            core_sent[core] += __builtin_popcount(res->sent[chip][core]);
+            core_passed[core] += __builtin_popcount(res->passed[chip][core]);
+        }
+        if (sent == 0) {
+            continue;
         }
 
-        // Build midstates array (use same midstate for all 4 slots)
-        uint8_t midstates[4][32];
-        for (int m = 0; m < 4; m++) {
-            memcpy(midstates[m], works[i].pattern.midstate, 32);
+        const double pct = passed * 100.0 / sent;
+        const bool ok = pct > PASS_THRESHOLD_PCT;
+        if (!ok) {
+            chips_failed++;
+        }
+        printf("  Chip %3d: %3d/%3d (%5.1f%%) %s",
+               chip, passed, sent, pct, ok ? "PASS" : "FAIL");
+        uint32_t first_ms, last_ms;
+        if (completion_span(&res->done, slot * CORES_PER_ASIC, CORES_PER_ASIC,
+                            &first_ms, &last_ms) == 0) {
+            printf("  first %u ms, last %u ms", first_ms, last_ms);
         }
+        printf("\n");
+    }
 
-        // Send work packet
-        if (bm1398_send_work(ctx, chain, works[i].work_id,
-                            works[i].pattern.work_data, midstates) < 0) {
-            fprintf(stderr, "Error: Failed to send pattern %d\n", i);
+    printf("\nPer-core nonce return (cores below %.0f%%):\n", PASS_THRESHOLD_PCT);
+    int cores_failed = 0;
+    for (int core = 0; core < CORES_PER_ASIC; core++) {
+        if (core_sent[core] == 0) {
+            continue;
+        }
+        const double pct = core_passed[core] * 100.0 / core_sent[core];
+        if (pct <= PASS_THRESHOLD_PCT) {
+            printf("  Core %2d (big %d, small %2d): %d/%d (%.1f%%)\n",
+                   core, core / 16, core % 16, core_passed[core],
+                   core_sent[core], pct);
+            cores_failed++;
+        }
+    }
+    if (cores_failed == 0) {
+        printf("  (none)\n");
+    }
+
+    printf("\nChips passing: %d/%d\n", res->num_chips - chips_failed, res->num_chips);
+    return chips_failed == 0;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options] [chain] [pattern_dir]\n\n", prog);
+    printf("Options:\n");
+    printf("  -f, --full       Test every pattern of every chip on the chain\n");
+    printf("  -a, --all-chains Test every detected chain in one run\n");
+    printf("  --chips N        Chips to test in full mode (default: detected)\n");
+    printf("  --bundle PATH    Use a pattern_pack bundle instead of btc-asic-NNN.bin\n");
+    printf("  --single-midstate  One pattern per packet, repeated in all 4 slots\n");
+    printf("  --shmoo          Sweep voltage × frequency and bin every chip\n");
+    printf("  --shmoo-mv R     Voltages, start:end:step in mV (default: %s)\n", SHMOO_DEFAULT_MV);
+    printf("  --shmoo-mhz R    Frequencies, start:end:step in MHz (default: %s)\n", SHMOO_DEFAULT_MHZ);
+    printf("  --burst N        Shmoo patterns per core per point, 1-%d (default: 1)\n",
+           PATTERNS_PER_CORE);
+    printf("  --shmoo-out P    Write P.csv and P_bins.csv (default: shmoo)\n\n");
+    printf("Without --full only the first %d patterns of chip %d are sent.\n",
+           TEST_PATTERNS, TEST_ASIC_ID);
+}
+
+/**
+ * Print totals and per-chip/per-core rates for one chain
+ * Returns: true if the chain passed
+ */
+static bool report_chain(const pt_results_t *res, bool full) {
+    const int patterns_sent = res->num_chips * res->patterns_per_chip;
+
+    printf("\n");
+    printf("====================================\n");
+    printf("Test Results: Chain %d\n", res->chain);
+    printf("====================================\n");
+    printf("Patterns sent: %d (%d packets)\n", patterns_sent, res->packets_sent);
+    printf("Total nonces received: %d\n", res->total_nonces);
+    printf("Valid nonces: %d\n", res->valid_nonces);
+    printf("Mismatched nonces: %d\n", res->mismatches);
+    printf("Unexpected nonces: %d\n", res->unexpected);
+    if (patterns_sent > 0) {
+        printf("Success rate: %.1f%%\n",
+               (res->valid_nonces * 100.0) / patterns_sent);
+    }
+    switch (completion_check(&res->done)) {
+    case COMPLETION_ALL_RECEIVED:
+        printf("Completion: all expected nonces received\n");
+        break;
+    case COMPLETION_TIMED_OUT:
+        printf("Completion: %u missing after %u ms timeout (worst latency %u ms)\n",
+               res->done.expected_total - res->done.received_total,
+               completion_timeout_ms(&res->done), res->done.max_latency_ms);
+        break;
+    default:
+        printf("Completion: stopped at time limit (%u/%u received)\n",
+               res->done.received_total, res->done.expected_total);
+        break;
+    }
+    printf("\n");
+
+    const bool board_ok = print_results(res);
+    if (full) {
+        printf("Board: %s\n", board_ok ? "PASS" : "FAIL");
+        return board_ok;
+    }
+    return res->valid_nonces > 0;
+}
+
+// Sweep grid; frequencies are ascending and already PLL-quantized
+typedef struct {
+    uint32_t mv[SHMOO_MAX_POINTS];
+    uint32_t mhz[SHMOO_MAX_POINTS];
+    int num_mv;
+    int num_mhz;
+    const char *out_prefix;
+} pt_shmoo_t;
+
+// Return per chip and grid point in permille, SHMOO_UNTESTED if skipped
+static uint16_t g_shmoo_map[MAX_CHAINS][MAX_PATTERN_CHIPS][SHMOO_MAX_POINTS][SHMOO_MAX_POINTS];
+
+/**
+ * Parse "start:end:step" (either direction) or a single value
+ * Returns: number of values, or -1 if malformed or too many
+ */
+static int parse_range(const char *arg, uint32_t values[SHMOO_MAX_POINTS]) {
+    unsigned int start, end, step;
+    const int fields = sscanf(arg, "%u:%u:%u", &start, &end, &step);
+    if (fields == 1) {
+        values[0] = start;
+        return 1;
+    }
+    if (fields != 3 || step == 0) {
+        return -1;
+    }
+
+    const long dir = start <= end ? 1 : -1;
+    int count = 0;
+    for (long v = start; dir > 0 ? v <= (long)end : v >= (long)end; v += dir * step) {
+        if (count == SHMOO_MAX_POINTS) {
             return -1;
         }
+        values[count++] = (uint32_t)v;
+    }
+    return count;
+}
 
-        if ((i + 1) % 10 == 0) {
-            printf("  Sent %d/%d patterns\n", i + 1, num_works);
+/**
+ * Build the sweep grid from the --shmoo-mv / --shmoo-mhz arguments
+ * Returns: 0 on success, -1 with a message on bad input
+ */
+static int shmoo_setup(pt_shmoo_t *sh, const char *mv_arg, const char *mhz_arg) {
+    sh->num_mv = parse_range(mv_arg, sh->mv);
+    if (sh->num_mv < 0) {
+        fprintf(stderr, "Error: Bad voltage range '%s' (start:end:step, at most %d points)\n",
+                mv_arg, SHMOO_MAX_POINTS);
+        return -1;
+    }
+    for (int i = 0; i < sh->num_mv; i++) {
+        if (sh->mv[i] < SHMOO_MIN_MV || sh->mv[i] > SHMOO_MAX_MV) {
+            fprintf(stderr, "Error: Voltage %u mV outside %d-%d mV\n",
+                    sh->mv[i], SHMOO_MIN_MV, SHMOO_MAX_MV);
+            return -1;
         }
+    }
 
-        usleep(5000);  // 5ms delay between work packets
+    uint32_t requested[SHMOO_MAX_POINTS];
+    const int num_requested = parse_range(mhz_arg, requested);
+    if (num_requested < 0) {
+        fprintf(stderr, "Error: Bad frequency range '%s' (start:end:step, at most %d points)\n",
+                mhz_arg, SHMOO_MAX_POINTS);
+        return -1;
     }
 
-    printf("All %d patterns sent successfully!\n\n", num_works);
+    // Snap to what the PLL can generate, then sort and drop duplicates
+    sh->num_mhz = 0;
+    for (int i = 0; i < num_requested; i++) {
+        uint32_t actual;
+        if (bm1398_pll_value(requested[i], &actual) == 0) {
+            fprintf(stderr, "Error: Frequency %u MHz outside PLL range (%u-%u MHz)\n",
+                    requested[i], FREQUENCY_MIN_MHZ, FREQUENCY_MAX_MHZ);
+            return -1;
+        }
+        int pos = sh->num_mhz;
+        while (pos > 0 && sh->mhz[pos - 1] > actual) {
+            pos--;
+        }
+        if (pos > 0 && sh->mhz[pos - 1] == actual) {
+            continue;
+        }
+        memmove(&sh->mhz[pos + 1], &sh->mhz[pos], (sh->num_mhz - pos) * sizeof(uint32_t));
+        sh->mhz[pos] = actual;
+        sh->num_mhz++;
+    }
     return 0;
 }
 
 /**
- * Extract ASIC index and core ID from nonce
- * Based on Bitmain get_asic_index_by_nonce() and get_coreid_by_nonce()
+ * Drain until the nonce FIFO has been silent for SHMOO_QUIET_MS, so late
+ * nonces of one grid point are not credited to the next
  */
-void parse_nonce_info(uint32_t nonce, int address_interval,
-                     int *asic_id, int *core_id) {
-    // ASIC index from upper bits
-    *asic_id = (nonce >> 24) / address_interval;
+static void drain_quiet(bm1398_context_t *ctx, pt_results_t results[MAX_CHAINS],
+                        pattern_source_t *src) {
+    int last = -1;
+    for (int i = 0; i < SHMOO_POINT_SEC * 1000 / SHMOO_QUIET_MS; i++) {
+        drain_nonces(ctx, results, src);
+        int seen = g_stray_nonces;
+        for (int c = 0; c < MAX_CHAINS; c++) {
+            seen += results[c].total_nonces;
+        }
+        if (seen == last) {
+            break;
+        }
+        last = seen;
+        usleep(SHMOO_QUIET_MS * 1000);
+    }
+}
 
-    // Core ID encoding (from factory test analysis)
-    // Upper nibble = big core (0-4), lower nibble = small core (0-15)
-    uint8_t core_byte = (nonce >> 16) & 0xFF;
-    int big_core = (core_byte >> 4) & 0xF;
-    int small_core = core_byte & 0xF;
-    *core_id = big_core * 16 + small_core;
+/**
+ * Clear per-run counters, keeping the test plan and address table
+ * Returns: 0 on success, -1 if the completion tracker can't be allocated
+ */
+static int reset_results(pt_results_t *res) {
+    memset(res->sent, 0, sizeof(res->sent));
+    memset(res->passed, 0, sizeof(res->passed));
+    res->packets_sent = 0;
+    res->total_nonces = 0;
+    res->valid_nonces = 0;
+    res->mismatches = 0;
+    res->unexpected = 0;
+    completion_free(&res->done);
+    return completion_init(&res->done, res->num_chips * CORES_PER_ASIC, MIN_NONCE_TIMEOUT_MS);
+}
+
+/**
+ * Send one burst to every active chain and collect its nonces
+ *
+ * Each point uses the next slot window of every core, so a straggler from
+ * an earlier point no longer matches a pattern that was sent and counts as
+ * a mismatch rather than a pass.
+ */
+static int run_point(bm1398_context_t *ctx, pt_results_t results[MAX_CHAINS],
+                     pattern_source_t *src, int point) {
+    drain_quiet(ctx, results, src);
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        pt_results_t *res = &results[c];
+        if (!res->active) {
+            continue;
+        }
+        res->first_slot = (point * res->slots_per_core) % PATTERNS_PER_CORE;
+        if (reset_results(res) < 0) {
+            return -1;
+        }
+    }
+
+    if (send_pattern_work(ctx, results, src) < 0) {
+        return -1;
+    }
+
+    const time_t start_time = time(NULL);
+    while (time(NULL) - start_time < SHMOO_POINT_SEC) {
+        drain_nonces(ctx, results, src);
+        if (all_complete(results)) {
+            break;
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+/**
+ * Bin every chip at every voltage and print a per-chain summary
+ *
+ * A chip's bin is the highest frequency reached from the bottom of the grid
+ * without a failing point, lowered by SHMOO_GUARD_STEPS grid steps.
+ */
+static int write_bins(const pt_results_t results[MAX_CHAINS], const pt_shmoo_t *sh) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s_bins.csv", sh->out_prefix);
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot create %s\n", path);
+        return -1;
+    }
+    fprintf(out, "chain,chip,voltage_mv,max_pass_mhz,bin_mhz\n");
+
+    printf("====================================\n");
+    printf("Shmoo Bins (guard %d step%s)\n", SHMOO_GUARD_STEPS, SHMOO_GUARD_STEPS == 1 ? "" : "s");
+    printf("====================================\n");
+
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        const pt_results_t *res = &results[c];
+        if (!res->active) {
+            continue;
+        }
+        printf("Chain %d:\n", c);
+
+        for (int v = 0; v < sh->num_mv; v++) {
+            int binned = 0;
+            int weakest = -1;
+            uint32_t weakest_mhz = 0;
+            uint64_t sum_mhz = 0;
+
+            for (int slot = 0; slot < res->num_chips; slot++) {
+                const int chip = res->first_chip + slot;
+                int top = -1;
+                for (int f = 0; f < sh->num_mhz; f++) {
+                    const uint16_t permille = g_shmoo_map[c][chip][v][f];
+                    if (permille == SHMOO_UNTESTED || permille <= SHMOO_PASS_PERMILLE) {
+                        break;
+                    }
+                    top = f;
+                }
+
+                const int bin = top - SHMOO_GUARD_STEPS;
+                const uint32_t bin_mhz = bin >= 0 ? sh->mhz[bin] : 0;
+                fprintf(out, "%d,%d,%u,%u,%u\n", c, chip, sh->mv[v],
+                        top >= 0 ? sh->mhz[top] : 0, bin_mhz);
+                if (bin < 0) {
+                    continue;
+                }
+                binned++;
+                sum_mhz += bin_mhz;
+                if (weakest < 0 || bin_mhz < weakest_mhz) {
+                    weakest = chip;
+                    weakest_mhz = bin_mhz;
+                }
+            }
+
+            printf("  %5u mV: %3d/%d chips binned", sh->mv[v], binned, res->num_chips);
+            if (binned > 0) {
+                printf(", mean %.0f MHz, min %u MHz (chip %d)",
+                       (double)sum_mhz / binned, weakest_mhz, weakest);
+            }
+            printf("\n");
+        }
+    }
+    printf("\n");
+
+    fclose(out);
+    printf("Per-chip bins written to %s\n", path);
+    return 0;
+}
+
+/**
+ * Set every active chain to one frequency and wait for the PLLs to relock
+ * Returns: 0 on success, -1 on error
+ */
+static int set_all_frequency(bm1398_context_t *ctx, const pt_results_t results[MAX_CHAINS],
+                             uint32_t mhz) {
+    int rc = 0;
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        if (results[c].active && bm1398_set_frequency(ctx, c, mhz) < 0) {
+            rc = -1;
+        }
+    }
+    usleep(100000);  // PLL relock
+    return rc;
+}
+
+/**
+ * Sweep the voltage × frequency grid on every active chain
+ *
+ * The PSU feeds all boards, so chains share each grid point: one PSU step,
+ * then every frequency from low to high. Before each PSU step the chains
+ * drop back to the lowest frequency, so a lower voltage never meets the
+ * previous step's highest frequency. Once no chip passes at a frequency
+ * the higher ones are skipped for that voltage.
+ * Returns: 0 on success, -1 on error
+ */
+static int run_shmoo(bm1398_context_t *ctx, pt_results_t results[MAX_CHAINS],
+                     pattern_source_t *src, const pt_shmoo_t *sh) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s.csv", sh->out_prefix);
+    FILE *csv = fopen(path, "w");
+    if (!csv) {
+        fprintf(stderr, "Error: Cannot create %s\n", path);
+        return -1;
+    }
+    fprintf(csv, "chain,chip,voltage_mv,freq_mhz,sent,passed,return_pct\n");
+    memset(g_shmoo_map, 0xFF, sizeof(g_shmoo_map));
+
+    int rc = 0;
+    int point = 0;
+    for (int v = 0; v < sh->num_mv && rc == 0; v++) {
+        printf("====================================\n");
+        printf("Shmoo: %u mV\n", sh->mv[v]);
+        printf("====================================\n");
+        if (set_all_frequency(ctx, results, sh->mhz[0]) < 0) {
+            rc = -1;
+            break;
+        }
+        if (bm1398_psu_set_voltage(ctx, sh->mv[v]) < 0) {
+            fprintf(stderr, "Error: Failed to set %u mV\n", sh->mv[v]);
+            rc = -1;
+            break;
+        }
+        sleep(SHMOO_SETTLE_SEC);
+
+        for (int f = 0; f < sh->num_mhz; f++) {
+            if (f > 0 && set_all_frequency(ctx, results, sh->mhz[f]) < 0) {
+                rc = -1;
+                break;
+            }
+            if (run_point(ctx, results, src, point++) < 0) {
+                rc = -1;
+                break;
+            }
+
+            int chips = 0;
+            int passing = 0;
+            for (int c = 0; c < MAX_CHAINS; c++) {
+                const pt_results_t *res = &results[c];
+                if (!res->active) {
+                    continue;
+                }
+                for (int slot = 0; slot < res->num_chips; slot++) {
+                    const int chip = res->first_chip + slot;
+                    int sent, passed;
+                    chip_counts(res, chip, &sent, &passed);
+                    if (sent == 0) {
+                        continue;
+                    }
+                    const int permille = passed * 1000 / sent;
+                    g_shmoo_map[c][chip][v][f] = (uint16_t)permille;
+                    fprintf(csv, "%d,%d,%u,%u,%d,%d,%.1f\n", c, chip, sh->mv[v],
+                            sh->mhz[f], sent, passed, passed * 100.0 / sent);
+                    chips++;
+                    if (permille > SHMOO_PASS_PERMILLE) {
+                        passing++;
+                    }
+                }
+            }
+            fflush(csv);
+            printf("  %u mV, %u MHz: %d/%d chips passing\n\n",
+                   sh->mv[v], sh->mhz[f], passing, chips);
+
+            if (passing == 0 && f + 1 < sh->num_mhz) {
+                printf("  No chip passes; skipping higher frequencies at %u mV\n\n", sh->mv[v]);
+                break;
+            }
+        }
+    }
+    fclose(csv);
+    printf("Shmoo map written to %s\n\n", path);
+
+    if (rc == 0) {
+        rc = write_bins(results, sh);
+    }
+
+    // Leave the boards at the normal operating point, voltage first at the
+    // lowest sweep frequency
+    printf("Restoring %d MHz, %.1fV\n", SHMOO_RESTORE_MHZ, SHMOO_RESTORE_MV / 1000.0);
+    set_all_frequency(ctx, results, sh->mhz[0]);
+    if (bm1398_psu_set_voltage(ctx, SHMOO_RESTORE_MV) == 0) {
+        sleep(SHMOO_SETTLE_SEC);
+        set_all_frequency(ctx, results, SHMOO_RESTORE_MHZ);
+    } else {
+        fprintf(stderr, "Warning: Failed to restore %.1fV, chains left at %u MHz\n",
+                SHMOO_RESTORE_MV / 1000.0, sh->mhz[0]);
+    }
+    return rc;
 }
 
 /**
@@ -172,47 +954,147 @@ void parse_nonce_info(uint32_t nonce, int address_interval,
 int main(int argc, char *argv[]) {
     const char *pattern_dir = "/tmp/BM1398-pattern";
     int chain = TEST_CHAIN;
+    bool full = false;
+    bool all_chains = false;
+    int full_chips = 0;
+    const char *bundle_path = NULL;
+    bool pack = true;
+    bool shmoo = false;
+    const char *shmoo_mv = SHMOO_DEFAULT_MV;
+    const char *shmoo_mhz = SHMOO_DEFAULT_MHZ;
+    const char *shmoo_out = "shmoo";
+    int burst = 1;
+    int positional = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--full") == 0 || strcmp(argv[i], "-f") == 0) {
+            full = true;
+        } else if (strcmp(argv[i], "--all-chains") == 0 || strcmp(argv[i], "-a") == 0) {
+            all_chains = true;
+        } else if (strcmp(argv[i], "--chips") == 0 && i + 1 < argc) {
+            full_chips = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bundle") == 0 && i + 1 < argc) {
+            bundle_path = argv[++i];
+        } else if (strcmp(argv[i], "--single-midstate") == 0) {
+            pack = false;
+        } else if (strcmp(argv[i], "--shmoo") == 0) {
+            shmoo = true;
+        } else if (strcmp(argv[i], "--shmoo-mv") == 0 && i + 1 < argc) {
+            shmoo_mv = argv[++i];
+        } else if (strcmp(argv[i], "--shmoo-mhz") == 0 && i + 1 < argc) {
+            shmoo_mhz = argv[++i];
+        } else if (strcmp(argv[i], "--shmoo-out") == 0 && i + 1 < argc) {
+            shmoo_out = argv[++i];
+        } else if (strcmp(argv[i], "--burst") == 0 && i + 1 < argc) {
+            burst = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && positional == 0) {
+            chain = atoi(argv[i]);
+            positional++;
+        } else if (argv[i][0] != '-' && positional == 1) {
+            pattern_dir = argv[i];
+            positional++;
+        } else {
+            print_usage(argv[0]);
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (chain < 0 || chain >= MAX_CHAINS) {
+        fprintf(stderr, "Error: Invalid chain %d\n", chain);
+        return 1;
+    }
 
-    if (argc > 1) {
-        chain = atoi(argv[1]);
+    if (burst < 1 || burst > PATTERNS_PER_CORE) {
+        fprintf(stderr, "Error: --burst must be 1-%d\n", PATTERNS_PER_CORE);
+        return 1;
     }
-    if (argc > 2) {
-        pattern_dir = argv[2];
+    static pt_shmoo_t sweep;
+    if (shmoo) {
+        sweep.out_prefix = shmoo_out;
+        if (shmoo_setup(&sweep, shmoo_mv, shmoo_mhz) < 0) {
+            return 1;
+        }
+    }
+
+    // Test plan shared by every chain under test; a shmoo covers every chip
+    const bool whole_chain = full || shmoo;
+    const int first_chip = whole_chain ? 0 : TEST_ASIC_ID;
+    const int profile_chips = board_profile_find(NULL)->chips_per_chain;
+    const int num_chips = whole_chain ? (full_chips > 0 ? full_chips : profile_chips) : 1;
+    const int patterns_per_chip = shmoo ? CORES_PER_ASIC * burst :
+                                  full ? PATTERNS_PER_ASIC : TEST_PATTERNS;
+    if (num_chips > MAX_PATTERN_CHIPS) {
+        fprintf(stderr, "Error: At most %d chips have pattern files\n", MAX_PATTERN_CHIPS);
+        return 1;
     }
 
     printf("\n");
     printf("====================================\n");
     printf("BM1398 Pattern Test\n");
     printf("====================================\n");
-    printf("Chain: %d\n", chain);
-    printf("ASIC: %d\n", TEST_ASIC_ID);
-    printf("Test patterns: %d\n", TEST_PATTERNS);
-    printf("Pattern dir: %s\n", pattern_dir);
-    printf("\n");
-
-    // Allocate pattern storage
-    pattern_work_t *works = calloc(CORES_PER_ASIC * PATTERNS_PER_CORE,
-                                   sizeof(pattern_work_t));
-    if (!works) {
-        fprintf(stderr, "Error: Failed to allocate pattern storage\n");
-        return 1;
+    if (all_chains) {
+        printf("Chains: all detected (nonces routed by FIFO chain bits, unverified)\n");
+    } else {
+        printf("Chain: %d\n", chain);
     }
+    if (shmoo) {
+        printf("Mode: shmoo (%d chips × %d cores × %d pattern%s per point)\n",
+               num_chips, CORES_PER_ASIC, burst, burst == 1 ? "" : "s");
+        printf("Grid: %d voltages (%u-%u mV) × %d frequencies (%u-%u MHz)\n",
+               sweep.num_mv, sweep.mv[0], sweep.mv[sweep.num_mv - 1],
+               sweep.num_mhz, sweep.mhz[0], sweep.mhz[sweep.num_mhz - 1]);
+    } else if (full) {
+        printf("Mode: full board (%d chips × %d cores × %d patterns)\n",
+               num_chips, CORES_PER_ASIC, PATTERNS_PER_CORE);
+    } else {
+        printf("ASIC: %d\n", TEST_ASIC_ID);
+        printf("Test patterns: %d\n", TEST_PATTERNS);
+    }
+    printf("Pattern %s: %s\n", bundle_path ? "bundle" : "dir",
+           bundle_path ? bundle_path : pattern_dir);
+    printf("\n");
 
-    // Load patterns
-    int num_loaded = load_asic_patterns(pattern_dir, TEST_ASIC_ID,
-                                       works, CORES_PER_ASIC * PATTERNS_PER_CORE);
-    if (num_loaded < TEST_PATTERNS) {
-        fprintf(stderr, "Error: Failed to load enough patterns (%d < %d)\n",
-               num_loaded, TEST_PATTERNS);
-        free(works);
+    // Map and validate patterns up front; pages fault in as they are sent
+    static pattern_source_t patterns;
+    if (source_open(&patterns, pattern_dir, bundle_path, first_chip, num_chips) < 0) {
+        source_close(&patterns);
         return 1;
     }
+    printf("Mapped patterns for %d chip(s) (%d patterns each)\n\n",
+           num_chips, PATTERNS_PER_ASIC);
 
     // Initialize driver
     bm1398_context_t ctx;
     if (bm1398_init(&ctx) < 0) {
         fprintf(stderr, "Error: Failed to initialize driver\n");
-        free(works);
+        source_close(&patterns);
+        return 1;
+    }
+
+    // Results are large (bitmaps for a full board); keep them off the stack
+    static pt_results_t results[MAX_CHAINS];
+    memset(results, 0, sizeof(results));
+    g_only_chain = all_chains ? -1 : chain;
+    int num_active = 0;
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        if (all_chains ? ctx.chips_per_chain[c] == 0 : c != chain) {
+            continue;
+        }
+        pt_results_t *res = &results[c];
+        res->active = true;
+        res->chain = c;
+        res->first_chip = first_chip;
+        res->num_chips = num_chips;
+        res->patterns_per_chip = patterns_per_chip;
+        res->slots_per_core = shmoo ? burst : PATTERNS_PER_CORE;
+        res->verbose = !full && !shmoo;
+        res->pack = pack;
+        num_active++;
+    }
+    if (num_active == 0) {
+        fprintf(stderr, "Error: No chains detected\n");
+        bm1398_cleanup(&ctx);
+        source_close(&patterns);
         return 1;
     }
 
@@ -224,26 +1106,43 @@ int main(int argc, char *argv[]) {
     if (bm1398_psu_power_on(&ctx, 15000) < 0) {
         fprintf(stderr, "Error: Failed to power on PSU\n");
         bm1398_cleanup(&ctx);
-        free(works);
+        source_close(&patterns);
         return 1;
     }
     printf("PSU powered on\n\n");
 
-    // Enable hashboard DC-DC converter BEFORE chain initialization
-    printf("====================================\n");
-    printf("Enabling Hashboard DC-DC Converter\n");
-    printf("====================================\n");
-    if (bm1398_enable_dc_dc(&ctx, chain) < 0) {
-        printf("Note: DC-DC enable failed (may already be enabled from previous run)\n");
-        printf("Continuing with test...\n");
-    }
-    sleep(1);  // Allow power to stabilize
-    printf("\n");
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        pt_results_t *res = &results[c];
+        if (!res->active) {
+            continue;
+        }
+
+        // Enable hashboard DC-DC converter BEFORE chain initialization
+        printf("====================================\n");
+        printf("Enabling Hashboard DC-DC Converter (chain %d)\n", c);
+        printf("====================================\n");
+        if (bm1398_enable_dc_dc(&ctx, c) < 0) {
+            printf("Note: DC-DC enable failed (may already be enabled from previous run)\n");
+            printf("Continuing with test...\n");
+        }
+        sleep(1);  // Allow power to stabilize
+        printf("\n");
 
-    // Initialize chain AFTER power is stable
-    printf("Initializing chain %d...\n\n", chain);
-    if (bm1398_init_chain(&ctx, chain) < 0) {
-        fprintf(stderr, "Warning: Chain initialization failed\n");
+        // Initialize chain AFTER power is stable
+        printf("Initializing chain %d...\n\n", c);
+        if (bm1398_init_chain(&ctx, c) < 0) {
+            fprintf(stderr, "Warning: Chain %d initialization failed\n", c);
+        }
+
+        // Nonce attribution follows the addresses actually assigned
+        const int chain_chips = ctx.chips_per_chain[c] > 0 ?
+                                ctx.chips_per_chain[c] : ctx.profile->chips_per_chain;
+        work_timing_addr_table(res->addr_to_chip, chain_chips,
+                               work_timing_interval(chain_chips), NO_CHIP);
+        if (res->first_chip + res->num_chips > chain_chips) {
+            printf("Note: Testing %d chips but chain %d reports %d\n",
+                   res->first_chip + res->num_chips, c, chain_chips);
+        }
     }
 
     // Reduce voltage to operational level (CRITICAL: must match bmminer!)
@@ -273,79 +1172,73 @@ int main(int argc, char *argv[]) {
     usleep(100000);  // 100ms settle time
     printf("\n");
 
-    // Send test patterns
-    if (send_pattern_work(&ctx, chain, works, TEST_PATTERNS) < 0) {
+    if (shmoo) {
+        const int rc = run_shmoo(&ctx, results, &patterns, &sweep);
+        for (int c = 0; c < MAX_CHAINS; c++) {
+            completion_free(&results[c].done);
+        }
         bm1398_cleanup(&ctx);
-        free(works);
+        source_close(&patterns);
+        return rc < 0 ? 1 : 0;
+    }
+
+    // Completion tracking starts with the first packet
+    bool tracker_ok = true;
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        if (results[c].active &&
+            completion_init(&results[c].done, num_chips * CORES_PER_ASIC,
+                            MIN_NONCE_TIMEOUT_MS) < 0) {
+            tracker_ok = false;
+        }
+    }
+
+    // Send test patterns (nonces are validated while sending)
+    if (!tracker_ok || send_pattern_work(&ctx, results, &patterns) < 0) {
+        for (int c = 0; c < MAX_CHAINS; c++) {
+            completion_free(&results[c].done);
+        }
+        bm1398_cleanup(&ctx);
+        source_close(&patterns);
         return 1;
     }
 
-    // Monitor for nonces
+    // Monitor for remaining nonces until complete or overdue
+    const int wait_sec = full ? FULL_TAIL_SEC : NONCE_TIMEOUT_SEC;
     printf("====================================\n");
-    printf("Monitoring for Nonces (%d seconds)\n", NONCE_TIMEOUT_SEC);
+    printf("Monitoring for Nonces (up to %d seconds)\n", wait_sec);
     printf("====================================\n\n");
 
     time_t start_time = time(NULL);
-    int total_nonces = 0;
-    int valid_nonces = 0;
-    nonce_response_t nonces[100];
-
-    while (time(NULL) - start_time < NONCE_TIMEOUT_SEC) {
-        int count = bm1398_get_nonce_count(&ctx);
-
-        if (count > 0) {
-            int read = bm1398_read_nonces(&ctx, nonces, 100);
-
-            for (int i = 0; i < read; i++) {
-                total_nonces++;
-
-                // Parse nonce info
-                int asic_id, core_id;
-                parse_nonce_info(nonces[i].nonce, CHIP_ADDRESS_INTERVAL,
-                               &asic_id, &core_id);
-                int pattern_id = nonces[i].work_id;
-
-                printf("Nonce #%d: 0x%08x (asic=%d, core=%d, pattern=%d)\n",
-                       total_nonces, nonces[i].nonce, asic_id, core_id, pattern_id);
-
-                // Validate against expected
-                if (asic_id == TEST_ASIC_ID && core_id < CORES_PER_ASIC &&
-                    pattern_id < PATTERNS_PER_CORE) {
-                    int idx = core_id * PATTERNS_PER_CORE + pattern_id;
-                    if (idx < num_loaded) {
-                        uint32_t expected = works[idx].pattern.nonce;
-                        if (nonces[i].nonce == expected) {
-                            printf("  ✓ VALID! Matches expected nonce\n");
-                            works[idx].nonce_returned++;
-                            valid_nonces++;
-                        } else {
-                            printf("  ✗ MISMATCH! Expected 0x%08x\n", expected);
-                        }
-                    }
-                }
-            }
+    while (time(NULL) - start_time < wait_sec) {
+        drain_nonces(&ctx, results, &patterns);
+        if (all_complete(results)) {
+            break;
         }
-
-        usleep(100000);  // 100ms polling interval
+        usleep(full ? 1000 : 100000);
     }
+    printf("Monitoring finished after %ld s\n", (long)(time(NULL) - start_time));
 
     // Results
-    printf("\n");
-    printf("====================================\n");
-    printf("Test Results\n");
-    printf("====================================\n");
-    printf("Patterns sent: %d\n", TEST_PATTERNS);
-    printf("Total nonces received: %d\n", total_nonces);
-    printf("Valid nonces: %d\n", valid_nonces);
-    if (TEST_PATTERNS > 0) {
-        printf("Success rate: %.1f%%\n",
-               (valid_nonces * 100.0) / TEST_PATTERNS);
+    bool all_ok = true;
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        if (results[c].active && !report_chain(&results[c], full)) {
+            all_ok = false;
+        }
+    }
+    if (g_stray_nonces) {
+        printf("\nNonces from chains not under test: %d\n", g_stray_nonces);
+    }
+    if (num_active > 1) {
+        printf("\nMachine: %s\n", all_ok ? "PASS" : "FAIL");
     }
     printf("\n");
 
     // Cleanup
+    for (int c = 0; c < MAX_CHAINS; c++) {
+        completion_free(&results[c].done);
+    }
     bm1398_cleanup(&ctx);
-    free(works);
+    source_close(&patterns);
 
-    return (valid_nonces > 0) ? 0 : 1;
+    return all_ok ? 0 : 1;
 }
@@ -15,6 +15,8 @@
 #include <string.h>
 #include <errno.h>
 #include <signal.h>
+#include "../include/fpga_i2c.h"
+#include "../include/fpga_service.h"
 
 // Device paths
 #define AXI_DEVICE          "/dev/axi_fpga_dev"
@@ -22,19 +24,6 @@
 
 // FPGA configuration
 #define AXI_SIZE            0x1200
-#define REG_I2C_CTRL        0x0C
-
-// I2C control bits
-#define I2C_READY           (1U << 31)
-#define I2C_DATA_READY      (0x2U << 30)
-#define I2C_READ_OP         (1U << 25)
-#define I2C_READ_1BYTE      (1U << 19)
-#define I2C_REGADDR_VALID   (1U << 24)
-
-// PSU I2C addressing
-#define PSU_I2C_MASTER      1
-#define PSU_I2C_SLAVE_HIGH  0x02
-#define PSU_I2C_SLAVE_LOW   0x00
 
 // PSU protocol
 #define PSU_REG_LEGACY      0x00
@@ -58,7 +47,6 @@
 #define RAMP_STEP_SECS      3
 
 // Timeouts
-#define I2C_TIMEOUT_MS      1000
 #define PSU_SEND_DELAY_MS   400
 #define PSU_READ_DELAY_MS   100
 #define PSU_RETRIES         3
@@ -66,6 +54,8 @@
 // Hardware state
 static volatile uint32_t *g_fpga_regs = NULL;
 static int g_fpga_fd = -1;
+static int g_owner_fd = -1;
+static fpga_i2c_t g_i2c;
 static uint8_t g_psu_reg = PSU_REG_V2;
 static uint8_t g_psu_version = 0;
 static volatile sig_atomic_t g_shutdown = 0;
@@ -124,62 +114,34 @@ static int gpio_setup(int gpio, int value) {
 // FPGA I2C Operations
 //==============================================================================
 
-static inline uint32_t i2c_build_cmd(uint8_t reg, uint8_t data, bool read) {
-    uint32_t cmd = (PSU_I2C_MASTER << 26) |
-                   (PSU_I2C_SLAVE_HIGH << 20) |
-                   ((PSU_I2C_SLAVE_LOW & 0x0E) << 15) |
-                   I2C_REGADDR_VALID | (reg << 8);
-
-    if (read) {
-        cmd |= I2C_READ_OP | I2C_READ_1BYTE;
-    } else {
-        cmd |= data;
-    }
-
-    return cmd;
-}
+static int i2c_write_bytes(uint8_t reg, const uint8_t *data, size_t len) {
+    fpga_i2c_op_t ops[8];
 
-static int i2c_wait_ready(void) {
-    for (int i = 0; i < I2C_TIMEOUT_MS / 5; i++) {
-        if (g_fpga_regs[REG_I2C_CTRL] & I2C_READY)
-            return 0;
-        usleep(5000);
-    }
-    fprintf(stderr, "I2C timeout waiting for ready\n");
-    return -1;
-}
+    if (len > sizeof(ops) / sizeof(ops[0])) return -1;
+    for (size_t i = 0; i < len; i++)
+        fpga_i2c_op_psu(&ops[i], reg, data[i], false);
 
-static int i2c_wait_data(uint8_t *data) {
-    for (int i = 0; i < I2C_TIMEOUT_MS / 5; i++) {
-        uint32_t val = g_fpga_regs[REG_I2C_CTRL];
-        if ((val >> 30) == 2) {
-            *data = (uint8_t)(val & 0xFF);
-            return 0;
-        }
-        usleep(5000);
+    if (fpga_i2c_xfer_frame(&g_i2c, ops, len) < 0) {
+        fprintf(stderr, "I2C timeout writing PSU register 0x%02X\n", reg);
+        return -1;
     }
-    fprintf(stderr, "I2C timeout waiting for data\n");
-    return -1;
-}
-
-static int i2c_write_byte(uint8_t reg, uint8_t data) {
-    uint8_t dummy;
-
-    if (i2c_wait_ready() < 0) return -1;
-
-    g_fpga_regs[REG_I2C_CTRL] = i2c_build_cmd(reg, data, false);
-    __sync_synchronize();
-
-    return i2c_wait_data(&dummy);
+    return 0;
 }
 
-static int i2c_read_byte(uint8_t reg, uint8_t *data) {
-    if (i2c_wait_ready() < 0) return -1;
+static int i2c_read_bytes(uint8_t reg, uint8_t *data, size_t len) {
+    fpga_i2c_op_t ops[8];
 
-    g_fpga_regs[REG_I2C_CTRL] = i2c_build_cmd(reg, 0, true);
-    __sync_synchronize();
+    if (len > sizeof(ops) / sizeof(ops[0])) return -1;
+    for (size_t i = 0; i < len; i++)
+        fpga_i2c_op_psu(&ops[i], reg, 0, true);
 
-    return i2c_wait_data(data);
+    if (fpga_i2c_xfer_frame(&g_i2c, ops, len) < 0) {
+        fprintf(stderr, "I2C timeout reading PSU register 0x%02X\n", reg);
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++)
+        data[i] = ops[i].data;
+    return 0;
 }
 
 //==============================================================================
@@ -196,18 +158,12 @@ static uint16_t calc_checksum(const uint8_t *data, size_t start, size_t end) {
 static int psu_transact(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len) {
     for (int retry = 0; retry < PSU_RETRIES; retry++) {
         // Send command
-        bool tx_ok = true;
-        for (size_t i = 0; i < tx_len && tx_ok; i++)
-            tx_ok = (i2c_write_byte(g_psu_reg, tx[i]) == 0);
-        if (!tx_ok) continue;
+        if (i2c_write_bytes(g_psu_reg, tx, tx_len) < 0) continue;
 
         usleep(PSU_SEND_DELAY_MS * 1000);
 
         // Read response
-        bool rx_ok = true;
-        for (size_t i = 0; i < rx_len && rx_ok; i++)
-            rx_ok = (i2c_read_byte(g_psu_reg, &rx[i]) == 0);
-        if (!rx_ok) continue;
+        if (i2c_read_bytes(g_psu_reg, rx, rx_len) < 0) continue;
 
         usleep(PSU_READ_DELAY_MS * 1000);
 
@@ -226,9 +182,9 @@ static int psu_detect_protocol(void) {
 
     // Try V2 first
     g_psu_reg = PSU_REG_V2;
-    if (i2c_write_byte(g_psu_reg, test_val) == 0) {
+    if (i2c_write_bytes(g_psu_reg, &test_val, 1) == 0) {
         usleep(10000);
-        if (i2c_read_byte(g_psu_reg, &read_val) == 0 && read_val == test_val) {
+        if (i2c_read_bytes(g_psu_reg, &read_val, 1) == 0 && read_val == test_val) {
             printf("  V2 protocol (register 0x11)\n");
             return 0;
         }
@@ -288,9 +244,15 @@ static int psu_set_voltage(uint32_t mv) {
 //==============================================================================
 
 static int fpga_init(void) {
+    g_owner_fd = fpga_service_claim("psu_test");
+    if (g_owner_fd < 0)
+        return -1;
+
     g_fpga_fd = open(AXI_DEVICE, O_RDWR | O_SYNC);
     if (g_fpga_fd < 0) {
         fprintf(stderr, "Failed to open %s: %s\n", AXI_DEVICE, strerror(errno));
+        fpga_service_release(g_owner_fd);
+        g_owner_fd = -1;
         return -1;
     }
 
@@ -299,6 +261,18 @@ static int fpga_init(void) {
         fprintf(stderr, "Failed to mmap FPGA: %s\n", strerror(errno));
         close(g_fpga_fd);
         g_fpga_fd = -1;
+        fpga_service_release(g_owner_fd);
+        g_owner_fd = -1;
+        return -1;
+    }
+
+    if (fpga_i2c_init(&g_i2c, g_fpga_regs) < 0) {
+        munmap((void*)g_fpga_regs, AXI_SIZE);
+        g_fpga_regs = NULL;
+        close(g_fpga_fd);
+        g_fpga_fd = -1;
+        fpga_service_release(g_owner_fd);
+        g_owner_fd = -1;
         return -1;
     }
 
@@ -306,10 +280,12 @@ static int fpga_init(void) {
 }
 
 static void fpga_cleanup(void) {
+    fpga_i2c_cleanup(&g_i2c);
     if (g_fpga_regs != NULL && g_fpga_regs != MAP_FAILED)
         munmap((void*)g_fpga_regs, AXI_SIZE);
     if (g_fpga_fd >= 0)
         close(g_fpga_fd);
+    fpga_service_release(g_owner_fd);
 }
 
 //==============================================================================
@@ -416,7 +392,8 @@ int main(void) {
     gpio_setup(PSU_ENABLE_GPIO, 1);
     printf("PSU disabled\n\n");
 
-    printf("Test complete!\n");
+    fpga_i2c_print_stats(&g_i2c);
+    printf("\nTest complete!\n");
     ret = 0;
 
 cleanup:
@@ -0,0 +1,286 @@
+/*
+ * SHA-256 / Bitcoin Header Hashing Implementation
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "../include/sha256.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define SHA256_X86 1
+#endif
+
+static const uint32_t sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// Bitcoin compares hashes as little-endian numbers: the most significant
+// 64 bits are digest words 7 and 6, byte-reversed
+static inline uint64_t top64(uint32_t h7, uint32_t h6) {
+    return ((uint64_t)__builtin_bswap32(h7) << 32) | __builtin_bswap32(h6);
+}
+
+//==============================================================================
+// Portable Reference
+//==============================================================================
+
+static inline uint32_t ror32(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void sha256_init_state(uint32_t state[8]) {
+    memcpy(state, sha256_iv, sizeof(sha256_iv));
+}
+
+void sha256_compress(uint32_t state[8], const uint32_t block[16]) {
+    uint32_t w[64];
+    memcpy(w, block, 16 * sizeof(uint32_t));
+    for (int i = 16; i < 64; i++) {
+        const uint32_t s0 = ror32(w[i - 15], 7) ^ ror32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = ror32(w[i - 2], 17) ^ ror32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        const uint32_t t1 = h + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) +
+                            ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        const uint32_t t2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22)) +
+                            ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void sha256_midstate(const uint8_t header[64], uint32_t state[8]) {
+    uint32_t block[16];
+    for (int i = 0; i < 16; i++) {
+        block[i] = ((uint32_t)header[i * 4] << 24) | ((uint32_t)header[i * 4 + 1] << 16) |
+                   ((uint32_t)header[i * 4 + 2] << 8) | header[i * 4 + 3];
+    }
+    sha256_init_state(state);
+    sha256_compress(state, block);
+}
+
+// Second block and outer hash share one fixed layout for every nonce
+static void sha256d_blocks(uint32_t inner[16], uint32_t outer[16],
+                           const sha256d_job_t *job, uint32_t nonce) {
+    memset(inner, 0, 16 * sizeof(uint32_t));
+    inner[0] = job->tail[0];
+    inner[1] = job->tail[1];
+    inner[2] = job->tail[2];
+    inner[3] = nonce;
+    inner[4] = 0x80000000;
+    inner[15] = 80 * 8;
+
+    memset(outer, 0, 16 * sizeof(uint32_t));
+    outer[8] = 0x80000000;
+    outer[15] = 32 * 8;
+}
+
+uint64_t sha256d_top64(const sha256d_job_t *job, uint32_t nonce) {
+    uint32_t inner[16], outer[16], s[8];
+    sha256d_blocks(inner, outer, job, nonce);
+
+    memcpy(s, job->midstate, sizeof(s));
+    sha256_compress(s, inner);
+    memcpy(outer, s, sizeof(s));
+    sha256_init_state(s);
+    sha256_compress(s, outer);
+    return top64(s[7], s[6]);
+}
+
+uint64_t sha256d_limit(double difficulty) {
+    // Difficulty 1 = top 32 bits zero, i.e. top64 < 2^32
+    const double limit = 4294967296.0 / difficulty;
+    if (limit >= 18446744073709551615.0) {
+        return UINT64_MAX;
+    }
+    return limit < 1.0 ? 0 : (uint64_t)limit - 1;
+}
+
+static int scan_scalar(const sha256d_job_t *job, uint32_t first, uint32_t count,
+                       uint64_t limit, uint32_t *hits, int max_hits) {
+    int found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (sha256d_top64(job, first + i) <= limit) {
+            hits[found++] = first + i;
+            if (found >= max_hits) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+//==============================================================================
+// Vector Implementations
+//==============================================================================
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define LANES 4
+#define LANES_FN(name) name##_x4
+#include "sha256_lanes.h"
+#undef LANES_FN
+#undef LANES
+#define SHA256_HAVE_X4 1
+#endif
+
+#ifdef SHA256_X86
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define LANES 8
+#define LANES_FN(name) name##_x8
+#include "sha256_lanes.h"
+#undef LANES_FN
+#undef LANES
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define LANES 16
+#define LANES_FN(name) name##_x16
+#include "sha256_lanes.h"
+#undef LANES_FN
+#undef LANES
+#pragma GCC pop_options
+#endif
+
+//==============================================================================
+// x86 SHA Extensions
+//==============================================================================
+
+#ifdef SHA256_X86
+#pragma GCC push_options
+#pragma GCC target("sha,sse4.1")
+#include <immintrin.h>
+
+/**
+ * One compression with SHA-NI; message words are already big-endian values
+ */
+static void compress_shani(uint32_t state[8], const uint32_t block[16]) {
+    __m128i msg[4];
+    __m128i tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                 // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);           // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);        // CDGH
+    const __m128i abef_save = state0;
+    const __m128i cdgh_save = state1;
+
+#pragma GCC unroll 16
+    for (int i = 0; i < 16; i++) {
+        if (i < 4) {
+            msg[i] = _mm_loadu_si128((const __m128i *)&block[i * 4]);
+        }
+        __m128i m = _mm_add_epi32(msg[i & 3], _mm_loadu_si128((const __m128i *)&sha256_k[i * 4]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, m);
+        if (i >= 3 && i <= 14) {
+            tmp = _mm_alignr_epi8(msg[i & 3], msg[(i + 3) & 3], 4);
+            msg[(i + 1) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(msg[(i + 1) & 3], tmp),
+                                                    msg[i & 3]);
+        }
+        m = _mm_shuffle_epi32(m, 0x0E);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, m);
+        if (i >= 1 && i <= 12) {
+            msg[(i + 3) & 3] = _mm_sha256msg1_epu32(msg[(i + 3) & 3], msg[i & 3]);
+        }
+    }
+
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+    tmp = _mm_shuffle_epi32(state0, 0x1B);              // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);           // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);        // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);           // HGFE
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+static int scan_shani(const sha256d_job_t *job, uint32_t first, uint32_t count,
+                      uint64_t limit, uint32_t *hits, int max_hits) {
+    uint32_t inner[16], outer[16], s[8];
+    sha256d_blocks(inner, outer, job, first);
+
+    int found = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        inner[3] = first + i;
+        memcpy(s, job->midstate, sizeof(s));
+        compress_shani(s, inner);
+        memcpy(outer, s, sizeof(s));
+        memcpy(s, sha256_iv, sizeof(s));
+        compress_shani(s, outer);
+        if (top64(s[7], s[6]) <= limit) {
+            hits[found++] = first + i;
+            if (found >= max_hits) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+#pragma GCC pop_options
+
+static int cpu_has_sha(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (ebx >> 29) & 1;
+}
+#endif
+
+//==============================================================================
+// Dispatch
+//==============================================================================
+
+int sha256d_impls(const sha256d_impl_t **impls) {
+    static sha256d_impl_t list[6];
+    static int count = -1;
+
+    if (count < 0) {
+        count = 0;
+#ifdef SHA256_X86
+        __builtin_cpu_init();
+        if (cpu_has_sha() && __builtin_cpu_supports("sse4.1")) {
+            list[count++] = (sha256d_impl_t){ "sha-ni", scan_shani };
+        }
+        if (__builtin_cpu_supports("avx512f")) {
+            list[count++] = (sha256d_impl_t){ "avx512", scan_x16 };
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            list[count++] = (sha256d_impl_t){ "avx2", scan_x8 };
+        }
+#endif
+#ifdef SHA256_HAVE_X4
+#ifdef __ARM_NEON
+        list[count++] = (sha256d_impl_t){ "neon", scan_x4 };
+#else
+        list[count++] = (sha256d_impl_t){ "sse2", scan_x4 };
+#endif
+#endif
+        list[count++] = (sha256d_impl_t){ "scalar", scan_scalar };
+    }
+
+    *impls = list;
+    return count;
+}
@@ -0,0 +1,108 @@
+/*
+ * Multi-lane SHA-256 double-hash scanner (template)
+ *
+ * Included by sha256.c once per vector width with LANES and LANES_FN(name)
+ * defined. Each lane hashes one nonce; GCC vector extensions map the
+ * arithmetic onto SSE2/AVX2/AVX-512 or NEON depending on the target
+ * options in effect at the point of inclusion.
+ */
+
+#define V LANES_FN(vec)
+
+typedef uint32_t V __attribute__((vector_size(LANES * 4)));
+
+static inline V LANES_FN(ror)(V x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline V LANES_FN(splat)(uint32_t x) {
+    return (V){0} + x;
+}
+
+static void LANES_FN(compress)(V s[8], V w[16]) {
+    V a = s[0], b = s[1], c = s[2], d = s[3];
+    V e = s[4], f = s[5], g = s[6], h = s[7];
+
+#pragma GCC unroll 64
+    for (int i = 0; i < 64; i++) {
+        if (i >= 16) {
+            const V w15 = w[(i - 15) & 15];
+            const V w2 = w[(i - 2) & 15];
+            w[i & 15] += (LANES_FN(ror)(w15, 7) ^ LANES_FN(ror)(w15, 18) ^ (w15 >> 3)) +
+                         w[(i - 7) & 15] +
+                         (LANES_FN(ror)(w2, 17) ^ LANES_FN(ror)(w2, 19) ^ (w2 >> 10));
+        }
+        const V t1 = h + (LANES_FN(ror)(e, 6) ^ LANES_FN(ror)(e, 11) ^ LANES_FN(ror)(e, 25)) +
+                     ((e & f) ^ (~e & g)) + sha256_k[i] + w[i & 15];
+        const V t2 = (LANES_FN(ror)(a, 2) ^ LANES_FN(ror)(a, 13) ^ LANES_FN(ror)(a, 22)) +
+                     ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    s[0] += a; s[1] += b; s[2] += c; s[3] += d;
+    s[4] += e; s[5] += f; s[6] += g; s[7] += h;
+}
+
+static int LANES_FN(scan)(const sha256d_job_t *job, uint32_t first, uint32_t count,
+                          uint64_t limit, uint32_t *hits, int max_hits) {
+    V lane;
+    for (int l = 0; l < LANES; l++) {
+        lane[l] = l;
+    }
+
+    int found = 0;
+    uint32_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        V s[8], w[16];
+
+        // Second block: header words 16-19 + padding for 80 bytes
+        for (int k = 0; k < 8; k++) {
+            s[k] = LANES_FN(splat)(job->midstate[k]);
+        }
+        w[0] = LANES_FN(splat)(job->tail[0]);
+        w[1] = LANES_FN(splat)(job->tail[1]);
+        w[2] = LANES_FN(splat)(job->tail[2]);
+        w[3] = lane + (first + i);
+        w[4] = LANES_FN(splat)(0x80000000);
+        for (int k = 5; k < 15; k++) {
+            w[k] = LANES_FN(splat)(0);
+        }
+        w[15] = LANES_FN(splat)(80 * 8);
+        LANES_FN(compress)(s, w);
+
+        // Outer hash of the 32-byte digest
+        for (int k = 0; k < 8; k++) {
+            w[k] = s[k];
+            s[k] = LANES_FN(splat)(sha256_iv[k]);
+        }
+        w[8] = LANES_FN(splat)(0x80000000);
+        for (int k = 9; k < 15; k++) {
+            w[k] = LANES_FN(splat)(0);
+        }
+        w[15] = LANES_FN(splat)(32 * 8);
+        LANES_FN(compress)(s, w);
+
+        for (int l = 0; l < LANES; l++) {
+            if (top64(s[7][l], s[6][l]) <= limit) {
+                hits[found++] = first + i + l;
+                if (found >= max_hits) {
+                    return found;
+                }
+            }
+        }
+    }
+
+    // Remainder that doesn't fill a vector
+    for (; i < count; i++) {
+        if (sha256d_top64(job, first + i) <= limit) {
+            hits[found++] = first + i;
+            if (found >= max_hits) {
+                return found;
+            }
+        }
+    }
+    return found;
+}
+
+#undef V
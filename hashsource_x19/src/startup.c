@@ -0,0 +1,205 @@
+/*
+ * Startup Dependency Scheduler Implementation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/startup.h"
+#include "../include/boot_trace.h"
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+static bool finished(const startup_task_t *t) {
+    return t->state == STARTUP_SUCCEEDED || t->state == STARTUP_ABORTED;
+}
+
+//==============================================================================
+// Graph
+//==============================================================================
+
+void startup_init(startup_graph_t *g) {
+    memset(g, 0, sizeof(*g));
+}
+
+/**
+ * Add a task; dependencies must name tasks added before it, so the graph
+ * cannot contain a cycle
+ */
+int startup_add(startup_graph_t *g, const char *name, int chain,
+                startup_step_fn fn, void *arg, uint32_t needs, uint32_t after) {
+    if (g->num_tasks == STARTUP_MAX_TASKS || ((needs | after) >> g->num_tasks)) {
+        fprintf(stderr, "Error: Cannot add startup task %s\n", name);
+        return -1;
+    }
+
+    const int id = g->num_tasks++;
+    startup_task_t *t = &g->tasks[id];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->chain = chain;
+    t->fn = fn;
+    t->arg = arg;
+    t->needs = needs;
+    t->after = after;
+    t->state = STARTUP_PENDING;
+    return id;
+}
+
+bool startup_succeeded(const startup_graph_t *g, int id) {
+    return id >= 0 && id < g->num_tasks && g->tasks[id].state == STARTUP_SUCCEEDED;
+}
+
+//==============================================================================
+// Event Loop
+//==============================================================================
+
+/**
+ * Start a pending task once its dependencies allow
+ * Returns: true if the task changed state
+ */
+static bool try_start(startup_graph_t *g, startup_task_t *t, uint64_t now) {
+    for (int i = 0; i < g->num_tasks; i++) {
+        const startup_task_t *dep = &g->tasks[i];
+        if (!((t->needs | t->after) & (1u << i))) {
+            continue;
+        }
+        if (!finished(dep)) {
+            return false;
+        }
+        if ((t->needs & (1u << i)) && dep->state == STARTUP_ABORTED) {
+            printf("Startup: %s", t->name);
+            if (t->chain >= 0) {
+                printf(" (chain %d)", t->chain);
+            }
+            printf(" skipped, %s failed\n", dep->name);
+            t->state = STARTUP_ABORTED;
+            t->start_ms = t->end_ms = now;
+            return true;
+        }
+    }
+
+    t->state = STARTUP_RUNNING;
+    t->start_ms = now;
+    t->wake_ms = now;
+    return true;
+}
+
+static void run_step(startup_task_t *t) {
+    uint32_t wait_ms = 0;
+    const uint64_t t0 = now_ms();
+    const int trace = boot_trace_begin(t->name, t->chain);
+    const startup_result_t ret = t->fn(t->arg, t->chain, t->step, &wait_ms);
+    boot_trace_end(trace);
+    const uint64_t t1 = now_ms();
+    t->busy_ms += t1 - t0;
+
+    switch (ret) {
+    case STARTUP_NEXT:
+        t->step++;
+        t->wake_ms = t1 + wait_ms;
+        t->wait_ms += wait_ms;
+        return;
+    case STARTUP_DONE:
+        t->state = STARTUP_SUCCEEDED;
+        break;
+    case STARTUP_FAILED:
+        t->state = STARTUP_ABORTED;
+        break;
+    }
+    t->end_ms = t1;
+}
+
+/**
+ * Run ready tasks in the order they were added, sleeping only when every
+ * unfinished task is waiting
+ */
+int startup_run(startup_graph_t *g) {
+    g->start_ms = now_ms();
+
+    for (;;) {
+        uint64_t now = now_ms();
+        uint64_t next_wake = UINT64_MAX;
+        bool progress = false;
+        int unfinished = 0;
+
+        for (int i = 0; i < g->num_tasks; i++) {
+            startup_task_t *t = &g->tasks[i];
+            if (finished(t)) {
+                continue;
+            }
+            if (t->state == STARTUP_PENDING) {
+                progress |= try_start(g, t, now);
+                if (t->state != STARTUP_RUNNING) {
+                    unfinished += t->state == STARTUP_PENDING;
+                    continue;
+                }
+            }
+            unfinished++;
+            if (t->wake_ms > now) {
+                if (t->wake_ms < next_wake) {
+                    next_wake = t->wake_ms;
+                }
+                continue;
+            }
+            run_step(t);
+            progress = true;
+            now = now_ms();
+        }
+
+        if (unfinished == 0) {
+            break;
+        }
+        // Dependencies only point backwards, so something is always
+        // running or waiting while tasks are unfinished
+        if (!progress && next_wake != UINT64_MAX && next_wake > now) {
+            usleep((useconds_t)((next_wake - now) * 1000));
+        }
+    }
+
+    g->end_ms = now_ms();
+    int failed = 0;
+    for (int i = 0; i < g->num_tasks; i++) {
+        failed += g->tasks[i].state != STARTUP_SUCCEEDED;
+    }
+    return failed;
+}
+
+//==============================================================================
+// Reporting
+//==============================================================================
+
+/**
+ * Per-task timeline: start and end relative to startup_run(), and the time
+ * spent inside steps. Overlap shows as tasks whose spans cross. Run one by
+ * one, each task would take its busy time plus its waits.
+ */
+void startup_print(const startup_graph_t *g) {
+    const uint64_t total = g->end_ms - g->start_ms;
+    uint64_t serial = 0;
+
+    printf("Startup schedule: %.2f s\n", total / 1000.0);
+    for (int i = 0; i < g->num_tasks; i++) {
+        const startup_task_t *t = &g->tasks[i];
+        char label[40];
+        if (t->chain >= 0) {
+            snprintf(label, sizeof(label), "%s (chain %d)", t->name, t->chain);
+        } else {
+            snprintf(label, sizeof(label), "%s", t->name);
+        }
+        printf("  %-28s %7.2f - %7.2f s  busy %6.2f s  %s\n", label,
+               (t->start_ms - g->start_ms) / 1000.0, (t->end_ms - g->start_ms) / 1000.0,
+               t->busy_ms / 1000.0, t->state == STARTUP_SUCCEEDED ? "ok" : "FAILED");
+        serial += t->busy_ms + t->wait_ms;
+    }
+    if (serial > total) {
+        printf("  Overlap saved %.2f s against running the tasks one by one\n",
+               (serial - total) / 1000.0);
+    }
+}
@@ -0,0 +1,302 @@
+/*
+ * BM1398 On-Die Temperature Sampling Engine Implementation
+ *
+ * Sensor count and thread model from bmminer log:
+ *   "max sensor num = 4", "temperature_monitor_thread start..."
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "../include/temp_monitor.h"
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+}
+
+//==============================================================================
+// Sample Handling
+//==============================================================================
+
+/**
+ * Convert diode register response to degrees C
+ *
+ * Assumes the diode reading is in the upper half of the response word as
+ * signed 8.8 fixed point (integer degrees in the high byte), with the FPGA
+ * chain/indicator tag in the low half. This has not been compared with
+ * bmminer's chip temperatures, so it is only used when the caller enables
+ * conversion.
+ */
+static float diode_to_celsius(uint32_t value) {
+    return (float)(int16_t)(value >> 16) / 256.0f;
+}
+
+static void sensor_add_sample(temp_sensor_t *s, float temp_c, uint64_t now) {
+    s->history[s->head] = temp_c;
+    s->head = (s->head + 1) % TEMP_HISTORY_LEN;
+    if (s->count < TEMP_HISTORY_LEN) {
+        s->count++;
+    }
+
+    if (s->samples == 0) {
+        s->min = s->max = s->ewma = temp_c;
+    } else {
+        if (temp_c < s->min) s->min = temp_c;
+        if (temp_c > s->max) s->max = temp_c;
+        s->ewma += TEMP_EWMA_ALPHA * (temp_c - s->ewma);
+    }
+
+    s->last = temp_c;
+    s->last_update_ms = now;
+    s->samples++;
+}
+
+/**
+ * Register response callback (called from bm1398_read_nonces)
+ */
+static void temp_on_response(void *arg, int chain, uint8_t chip_addr,
+                             uint8_t reg_addr, uint32_t value) {
+    temp_monitor_t *tm = arg;
+    const int sensor = tm->pending_sensor[chain];
+
+    if (sensor < 0) {
+        return;     // Late response for a read we already dropped
+    }
+    if (reg_addr != TEMP_SENSOR_REG ||
+        chip_addr != tm->sensors[chain][sensor].chip_addr) {
+        return;     // Not our read; ours times out as usual
+    }
+    tm->pending_sensor[chain] = -1;
+
+    temp_sensor_t *s = &tm->sensors[chain][sensor];
+    s->responses++;
+    s->last_raw = value;
+    if (!tm->convert) {
+        return;
+    }
+
+    const float temp_c = diode_to_celsius(value);
+    if (temp_c < TEMP_MIN_VALID_C || temp_c > TEMP_MAX_VALID_C) {
+        s->rejects++;
+        return;
+    }
+    sensor_add_sample(s, temp_c, now_ms());
+}
+
+//==============================================================================
+// Lifecycle
+//==============================================================================
+
+/**
+ * Initialize sampling for every chain that has chips
+ *
+ * Default sensor placement spreads the sensors evenly along the chain
+ * (first chip, last chip and two in between); override per board with
+ * temp_monitor_set_sensor().
+ */
+int temp_monitor_init(temp_monitor_t *tm, bm1398_context_t *ctx, bool convert) {
+    if (!tm || !ctx || !ctx->initialized) {
+        return -1;
+    }
+
+    memset(tm, 0, sizeof(*tm));
+    tm->ctx = ctx;
+    tm->convert = convert;
+
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        tm->pending_sensor[chain] = -1;
+        temp_monitor_set_chain(tm, chain, ctx->chips_per_chain[chain]);
+    }
+
+    ctx->reg_response_cb = temp_on_response;
+    ctx->reg_response_arg = tm;
+    return 0;
+}
+
+void temp_monitor_cleanup(temp_monitor_t *tm) {
+    if (!tm || !tm->ctx) {
+        return;
+    }
+
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (tm->pending_sensor[chain] >= 0) {
+            bm1398_drop_register_read(tm->ctx, chain);
+            tm->pending_sensor[chain] = -1;
+        }
+    }
+    if (tm->ctx->reg_response_arg == tm) {
+        tm->ctx->reg_response_cb = NULL;
+        tm->ctx->reg_response_arg = NULL;
+    }
+}
+
+/**
+ * (Re)start sampling a chain with the default sensor placement, or stop it
+ * with chips = 0 (board removed). History of the old board is discarded.
+ */
+void temp_monitor_set_chain(temp_monitor_t *tm, int chain, int chips) {
+    if (!tm || chain < 0 || chain >= MAX_CHAINS) {
+        return;
+    }
+
+    if (tm->pending_sensor[chain] >= 0) {
+        bm1398_drop_register_read(tm->ctx, chain);
+        tm->pending_sensor[chain] = -1;
+    }
+    memset(tm->sensors[chain], 0, sizeof(tm->sensors[chain]));
+    tm->num_sensors[chain] = 0;
+    tm->next_sensor[chain] = 0;
+    tm->next_sample_ms[chain] = 0;
+    if (chips <= 0) {
+        return;
+    }
+
+    int interval = 256 / chips;
+    if (interval < 1) interval = 1;
+
+    tm->num_sensors[chain] = TEMP_SENSORS_PER_CHAIN;
+    for (int i = 0; i < TEMP_SENSORS_PER_CHAIN; i++) {
+        const int chip = i * (chips - 1) / (TEMP_SENSORS_PER_CHAIN - 1);
+        tm->sensors[chain][i].chip_addr = (uint8_t)(chip * interval);
+    }
+}
+
+void temp_monitor_set_sensor(temp_monitor_t *tm, int chain, int sensor,
+                             uint8_t chip_addr) {
+    if (!tm || chain < 0 || chain >= MAX_CHAINS ||
+        sensor < 0 || sensor >= TEMP_SENSORS_PER_CHAIN) {
+        return;
+    }
+
+    memset(&tm->sensors[chain][sensor], 0, sizeof(temp_sensor_t));
+    tm->sensors[chain][sensor].chip_addr = chip_addr;
+    if (tm->num_sensors[chain] <= sensor) {
+        tm->num_sensors[chain] = sensor + 1;
+    }
+}
+
+//==============================================================================
+// Sampling
+//==============================================================================
+
+/**
+ * Advance the sampling state machine
+ *
+ * Per chain: expire a read that has waited longer than TEMP_READ_TIMEOUT_MS,
+ * then, if idle and due, send one read to the next sensor. Costs at most one
+ * UART command per chain per call.
+ *
+ * Responses carry no chip address, so a timed-out read is followed by a full
+ * sample interval with nothing outstanding. An answer that arrives late in
+ * that gap is dropped instead of being credited to the next sensor.
+ */
+void temp_monitor_poll(temp_monitor_t *tm) {
+    if (!tm || !tm->ctx) {
+        return;
+    }
+
+    const uint64_t now = now_ms();
+
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        if (tm->num_sensors[chain] == 0) {
+            continue;
+        }
+
+        const int pending = tm->pending_sensor[chain];
+        if (pending >= 0) {
+            if (now - tm->pending_since_ms[chain] < TEMP_READ_TIMEOUT_MS) {
+                continue;
+            }
+            tm->sensors[chain][pending].timeouts++;
+            tm->pending_sensor[chain] = -1;
+            bm1398_drop_register_read(tm->ctx, chain);
+            tm->next_sample_ms[chain] = now + TEMP_SAMPLE_INTERVAL_MS;
+            continue;
+        }
+
+        if (now < tm->next_sample_ms[chain]) {
+            continue;
+        }
+
+        const int sensor = tm->next_sensor[chain];
+        tm->next_sensor[chain] = (sensor + 1) % tm->num_sensors[chain];
+        tm->next_sample_ms[chain] = now + TEMP_SAMPLE_INTERVAL_MS;
+
+        if (bm1398_read_register_async(tm->ctx, chain,
+                                       tm->sensors[chain][sensor].chip_addr,
+                                       TEMP_SENSOR_REG,
+                                       TEMP_READ_TIMEOUT_MS) == 0) {
+            tm->pending_sensor[chain] = sensor;
+            tm->pending_since_ms[chain] = now;
+        } else {
+            tm->sensors[chain][sensor].timeouts++;
+        }
+    }
+}
+
+//==============================================================================
+// Queries
+//==============================================================================
+
+bool temp_monitor_is_stale(const temp_monitor_t *tm, int chain, int sensor) {
+    if (!tm || chain < 0 || chain >= MAX_CHAINS ||
+        sensor < 0 || sensor >= tm->num_sensors[chain]) {
+        return true;
+    }
+
+    const temp_sensor_t *s = &tm->sensors[chain][sensor];
+    return s->last_update_ms == 0 || now_ms() - s->last_update_ms > TEMP_STALE_MS;
+}
+
+/**
+ * Hottest smoothed (EWMA) temperature among the chain's fresh sensors
+ * Returns: 0 on success, -1 if every sensor is stale
+ */
+int temp_monitor_chain_max(const temp_monitor_t *tm, int chain, float *temp_c) {
+    if (!tm || !temp_c || chain < 0 || chain >= MAX_CHAINS) {
+        return -1;
+    }
+
+    bool found = false;
+    for (int i = 0; i < tm->num_sensors[chain]; i++) {
+        if (temp_monitor_is_stale(tm, chain, i)) {
+            continue;
+        }
+        const float t = tm->sensors[chain][i].ewma;
+        if (!found || t > *temp_c) {
+            *temp_c = t;
+            found = true;
+        }
+    }
+    return found ? 0 : -1;
+}
+
+void temp_monitor_print(const temp_monitor_t *tm) {
+    if (!tm) {
+        return;
+    }
+
+    for (int chain = 0; chain < MAX_CHAINS; chain++) {
+        for (int i = 0; i < tm->num_sensors[chain]; i++) {
+            const temp_sensor_t *s = &tm->sensors[chain][i];
+            if (!tm->convert && s->responses > 0) {
+                printf("  Chain %d sensor %d (chip 0x%02X): raw 0x%08X (%u answers, %u timeouts)\n",
+                       chain, i, s->chip_addr, s->last_raw, s->responses, s->timeouts);
+                continue;
+            }
+            if (s->samples == 0) {
+                printf("  Chain %d sensor %d (chip 0x%02X): no data (%u timeouts)\n",
+                       chain, i, s->chip_addr, s->timeouts);
+                continue;
+            }
+            printf("  Chain %d sensor %d (chip 0x%02X): %.1f C (avg %.1f, min %.1f, max %.1f)%s\n",
+                   chain, i, s->chip_addr, s->last, s->ewma, s->min, s->max,
+                   temp_monitor_is_stale(tm, chain, i) ? " STALE" : "");
+        }
+    }
+}
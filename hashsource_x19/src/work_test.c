@@ -3,6 +3,13 @@
  *
  * Tests work submission and nonce reading on S19 Pro ASIC chips.
  * Uses a known Bitcoin block with golden nonce for verification.
+ *
+ * The synthetic work has no known answer set, so monitoring stops once no
+ * nonce has arrived for the adaptive timeout (see completion.h): at least
+ * the time the chain needs to sweep every queued work, or several times the
+ * slowest send → nonce latency seen. NONCE_READ_TIMEOUT_MS is an upper bound.
+ * Nonces are counted for the batch as a whole: the FIFO word has no verified
+ * work_id field to credit them to individual works.
  */
 
 #include <stdio.h>
@@ -12,11 +19,13 @@
 #include <unistd.h>
 #include <time.h>
 #include "../include/bm1398_asic.h"
+#include "../include/completion.h"
 
 // Test configuration
 #define TEST_CHAIN 0
 #define TEST_WORK_COUNT 10
 #define NONCE_READ_TIMEOUT_MS 5000
+#define NONCE_QUIET_MS 500      // Margin over the queued work's sweep time
 
 /**
  * Print buffer as hex
@@ -136,7 +145,16 @@ int main(int argc, char *argv[]) {
     int fifo_space = bm1398_check_work_fifo_ready(&ctx);
     printf("Work FIFO space: %d\n\n", fifo_space);
 
+    // Every queued work must be swept before its nonces can be missing
+    completion_t done;
+    const uint32_t sweep_ms = TEST_WORK_COUNT * ctx.timing.sweep_us / 1000;
+    if (completion_init(&done, 1, sweep_ms + NONCE_QUIET_MS) < 0) {
+        bm1398_cleanup(&ctx);
+        return 1;
+    }
+
     // Send test work packets
+    const uint32_t first_send_ms = completion_now(&done);
     for (uint32_t i = 0; i < TEST_WORK_COUNT; i++) {
         uint8_t work_data[12];
         uint8_t midstates[4][32];
@@ -148,9 +166,11 @@ int main(int argc, char *argv[]) {
 
         if (bm1398_send_work(&ctx, chain, i, work_data, midstates) < 0) {
             fprintf(stderr, "Error: Failed to send work %u\n", i);
+            completion_free(&done);
             bm1398_cleanup(&ctx);
             return 1;
         }
+        completion_sent(&done, 0, 0);
 
         usleep(10000);  // 10ms delay between work submissions
     }
@@ -163,11 +183,12 @@ int main(int argc, char *argv[]) {
     printf("Monitoring for Nonces\n");
     printf("====================================\n\n");
 
-    time_t start_time = time(NULL);
+    const uint32_t start_ms = completion_now(&done);
     int total_nonces = 0;
     nonce_response_t nonces[100];
 
-    while (time(NULL) - start_time < NONCE_READ_TIMEOUT_MS / 1000) {
+    while (completion_now(&done) - start_ms < NONCE_READ_TIMEOUT_MS &&
+           completion_check(&done) == COMPLETION_PENDING) {
         int nonce_count = bm1398_get_nonce_count(&ctx);
 
         if (nonce_count > 0) {
@@ -176,11 +197,11 @@ int main(int argc, char *argv[]) {
             int read = bm1398_read_nonces(&ctx, nonces, 100);
             if (read > 0) {
                 for (int i = 0; i < read; i++) {
-                    printf("  Nonce %d: 0x%08x (chain=%u, work_id=%u)\n",
+                    printf("  Nonce %d: 0x%08x (chain=%u)\n",
                            total_nonces + i,
                            nonces[i].nonce,
-                           nonces[i].chain_id,
-                           nonces[i].work_id);
+                           nonces[i].chain_id);
+                    completion_received(&done, 0);
                 }
                 total_nonces += read;
             }
@@ -194,8 +215,16 @@ int main(int argc, char *argv[]) {
     printf("Test Complete\n");
     printf("====================================\n");
     printf("Total nonces received: %d\n", total_nonces);
+    printf("Monitoring stopped after %u ms (quiet timeout %u ms)\n",
+           completion_now(&done) - start_ms, completion_timeout_ms(&done));
+    uint32_t first_ms, last_ms;
+    if (completion_span(&done, 0, 1, &first_ms, &last_ms) == 0) {
+        printf("First nonce: %u ms, last nonce: %u ms after first send\n",
+               first_ms - first_send_ms, last_ms - first_send_ms);
+    }
     printf("\n");
 
+    completion_free(&done);
     bm1398_cleanup(&ctx);
     return 0;
 }
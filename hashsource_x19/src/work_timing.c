@@ -0,0 +1,73 @@
+/*
+ * Work Timing Calculator Implementation
+ *
+ * Formulas fitted to the bmminer reference point; see work_timing.h.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/work_timing.h"
+
+/**
+ * Chip address interval used by bm1398_enumerate_chips()
+ */
+int work_timing_interval(int chips) {
+    if (chips <= 0) {
+        return 1;
+    }
+    const int interval = 256 / chips;
+    return interval < 1 ? 1 : interval;
+}
+
+/**
+ * Build the nonce top byte → chip index table for a chain
+ *
+ * Chip n answers at address n * interval (bm1398_enumerate_chips()), and the
+ * top byte of every nonce it returns falls in [n * interval, (n+1) * interval).
+ * Addresses past the last chip map to none.
+ */
+void work_timing_addr_table(uint8_t table[256], int chips, int interval, uint8_t none) {
+    if (interval < 1) {
+        interval = 1;
+    }
+    for (int addr = 0; addr < 256; addr++) {
+        const int chip = addr / interval;
+        table[addr] = chip < chips ? (uint8_t)chip : none;
+    }
+}
+
+/**
+ * Compute all timing-dependent register values
+ * Returns: 0 on success, -1 on invalid input
+ */
+int work_timing_calc(work_timing_t *t, uint32_t freq_mhz, int chips,
+                     int interval, int percent) {
+    if (!t || freq_mhz == 0 || chips <= 0 || interval <= 0 ||
+        percent <= 0 || percent > 100) {
+        return -1;
+    }
+
+    memset(t, 0, sizeof(*t));
+    t->freq_mhz = freq_mhz;
+    t->chips = chips;
+    t->interval = interval;
+    t->percent = percent;
+
+    // Nonces owned by one chip, swept at NONCES_PER_CLK per MHz-cycle
+    const uint64_t nonces = (1ULL << 32) * (uint64_t)interval / 256;
+    const uint64_t per_us = (uint64_t)freq_mhz * WORK_TIMING_NONCES_PER_CLK;
+
+    t->sweep_us = (uint32_t)(nonces / per_us);
+    t->timeout = (uint32_t)(nonces * (uint64_t)percent / (per_us * 100));
+    if (t->timeout > WORK_TIMING_TIMEOUT_MASK) {
+        t->timeout = WORK_TIMING_TIMEOUT_MASK;
+    }
+
+    t->hcn = (uint32_t)(nonces * WORK_TIMING_CLKI_MHZ / per_us);
+    t->hcn &= ~(uint32_t)(WORK_TIMING_HCN_GRANULARITY - 1);
+
+    t->chain_work_config = CHAIN_WORK_CONFIG(chips);
+    t->work_queue_param = WORK_QUEUE_PARAM(chips);
+    return 0;
+}